@@ -0,0 +1,168 @@
+/*
+* Copyright (c) 2006-2010 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Collision/Shapes/b2CapsuleShape.h>
+#include <new>
+
+void b2CapsuleShape::Set(const b2Vec2& v1, const b2Vec2& v2, float32 radius)
+{
+	m_vertex1 = v1;
+	m_vertex2 = v2;
+	m_radius = radius;
+}
+
+b2Shape* b2CapsuleShape::Clone(b2BlockAllocator* allocator) const
+{
+	void* mem = allocator->Allocate(sizeof(b2CapsuleShape));
+	b2CapsuleShape* clone = new (mem) b2CapsuleShape;
+	*clone = *this;
+	return clone;
+}
+
+int32 b2CapsuleShape::GetChildCount() const
+{
+	return 1;
+}
+
+bool b2CapsuleShape::TestPoint(const b2Transform& xf, const b2Vec2& p) const
+{
+	b2Vec2 q = b2MulT(xf, p);
+	b2Vec2 e = m_vertex2 - m_vertex1;
+	float32 ee = b2Dot(e, e);
+	float32 s = ee > 0.0f ? b2Clamp(b2Dot(q - m_vertex1, e) / ee, 0.0f, 1.0f) : 0.0f;
+	b2Vec2 d = q - (m_vertex1 + s * e);
+	return b2Dot(d, d) <= m_radius * m_radius;
+}
+
+// The capsule's boundary consists of two circles around the vertices
+// and the two sides, the segment offset by +/- radius along its normal.
+// The ray enters the capsule at the nearest of these entry points.
+bool b2CapsuleShape::RayCast(b2RayCastOutput* output, const b2RayCastInput& input,
+							const b2Transform& xf, int32 childIndex) const
+{
+	B2_NOT_USED(childIndex);
+
+	// Put the ray into the capsule's frame of reference.
+	b2Vec2 p1 = b2MulT(xf.q, input.p1 - xf.p);
+	b2Vec2 p2 = b2MulT(xf.q, input.p2 - xf.p);
+	b2Vec2 d = p2 - p1;
+	float32 dd = b2Dot(d, d);
+	if (dd < b2_epsilon)
+	{
+		return false;
+	}
+
+	float32 fraction = input.maxFraction;
+	b2Vec2 normal;
+	bool hit = false;
+
+	// Caps, see b2CircleShape::RayCast.
+	const b2Vec2* centers = &m_vertex1;
+	for (int32 i = 0; i < 2; ++i)
+	{
+		b2Vec2 s = p1 - centers[i];
+		float32 b = b2Dot(s, s) - m_radius * m_radius;
+		float32 c = b2Dot(s, d);
+		float32 sigma = c * c - dd * b;
+		if (sigma < 0.0f)
+		{
+			continue;
+		}
+
+		float32 a = -(c + b2Sqrt(sigma));
+		if (0.0f <= a && a <= fraction * dd)
+		{
+			fraction = a / dd;
+			normal = s + fraction * d;
+			normal.Normalize();
+			hit = true;
+		}
+	}
+
+	// Sides, see b2EdgeShape::RayCast.
+	b2Vec2 e = m_vertex2 - m_vertex1;
+	float32 length = e.Normalize();
+	if (length > b2_epsilon)
+	{
+		b2Vec2 side = b2Cross(e, 1.0f);
+		for (int32 i = 0; i < 2; ++i)
+		{
+			// The ray must start outside and point inwards.
+			float32 numerator = m_radius - b2Dot(side, p1 - m_vertex1);
+			float32 denominator = b2Dot(side, d);
+			if (numerator < 0.0f && denominator < 0.0f)
+			{
+				float32 t = numerator / denominator;
+				float32 s = b2Dot(p1 + t * d - m_vertex1, e);
+				if (t <= fraction && 0.0f <= s && s <= length)
+				{
+					fraction = t;
+					normal = side;
+					hit = true;
+				}
+			}
+			side = -side;
+		}
+	}
+
+	if (hit == false)
+	{
+		return false;
+	}
+
+	output->fraction = fraction;
+	output->normal = b2Mul(xf.q, normal);
+	return true;
+}
+
+void b2CapsuleShape::ComputeAABB(b2AABB* aabb, const b2Transform& xf, int32 childIndex) const
+{
+	B2_NOT_USED(childIndex);
+
+	b2Vec2 v1 = b2Mul(xf, m_vertex1);
+	b2Vec2 v2 = b2Mul(xf, m_vertex2);
+
+	b2Vec2 r(m_radius, m_radius);
+	aabb->lowerBound = b2Min(v1, v2) - r;
+	aabb->upperBound = b2Max(v1, v2) + r;
+}
+
+// A box of 2 * radius by length plus two half circles at its ends.
+// The half circles together weigh as much as one circle; each one's
+// centroid lies 4 * radius / (3 * pi) beyond the end of the box.
+void b2CapsuleShape::ComputeMass(b2MassData* massData, float32 density) const
+{
+	float32 rr = m_radius * m_radius;
+	float32 length = b2Distance(m_vertex1, m_vertex2);
+	float32 h = 0.5f * length;
+
+	float32 circleMass = density * b2_pi * rr;
+	float32 boxMass = density * 2.0f * m_radius * length;
+
+	massData->mass = circleMass + boxMass;
+	massData->center = 0.5f * (m_vertex1 + m_vertex2);
+
+	// Parallel axis theorem applied twice to the half circles: first
+	// from their centroid to the circle center, then to the box end.
+	float32 lc = 4.0f * m_radius / (3.0f * b2_pi);
+	float32 circleInertia = circleMass * (0.5f * rr + h * h + 2.0f * h * lc);
+	float32 boxInertia = boxMass * (4.0f * rr + length * length) / 12.0f;
+
+	// Inertia about the local origin.
+	massData->I = circleInertia + boxInertia + massData->mass * b2Dot(massData->center, massData->center);
+}
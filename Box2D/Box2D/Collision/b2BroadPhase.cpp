@@ -29,6 +29,10 @@ b2BroadPhase::b2BroadPhase()
 	m_moveCapacity = 16;
 	m_moveCount = 0;
 	m_moveBuffer = (int32*)b2Alloc(m_moveCapacity * sizeof(int32));
+
+	m_wideTreeValid[e_staticTree] = false;
+	m_wideTreeValid[e_dynamicTree] = false;
+	m_useWideTrees = true;
 }
 
 b2BroadPhase::~b2BroadPhase()
@@ -37,9 +41,11 @@ b2BroadPhase::~b2BroadPhase()
 	b2Free(m_pairBuffer);
 }
 
-int32 b2BroadPhase::CreateProxy(const b2AABB& aabb, void* userData)
+int32 b2BroadPhase::CreateProxy(const b2AABB& aabb, void* userData, bool isStatic)
 {
-	int32 proxyId = m_tree.CreateProxy(aabb, userData);
+	int32 tree = isStatic ? e_staticTree : e_dynamicTree;
+	int32 proxyId = GetProxyId(m_trees[tree].CreateProxy(aabb, userData), tree);
+	m_wideTreeValid[tree] = false;
 	++m_proxyCount;
 	BufferMove(proxyId);
 	return proxyId;
@@ -49,14 +55,16 @@ void b2BroadPhase::DestroyProxy(int32 proxyId)
 {
 	UnBufferMove(proxyId);
 	--m_proxyCount;
-	m_tree.DestroyProxy(proxyId);
+	m_trees[GetTreeIndex(proxyId)].DestroyProxy(GetNodeId(proxyId));
+	m_wideTreeValid[GetTreeIndex(proxyId)] = false;
 }
 
 void b2BroadPhase::MoveProxy(int32 proxyId, const b2AABB& aabb, const b2Vec2& displacement)
 {
-	bool buffer = m_tree.MoveProxy(proxyId, aabb, displacement);
+	bool buffer = m_trees[GetTreeIndex(proxyId)].MoveProxy(GetNodeId(proxyId), aabb, displacement);
 	if (buffer)
 	{
+		m_wideTreeValid[GetTreeIndex(proxyId)] = false;
 		BufferMove(proxyId);
 	}
 }
@@ -66,6 +74,28 @@ void b2BroadPhase::TouchProxy(int32 proxyId)
 	BufferMove(proxyId);
 }
 
+void b2BroadPhase::SetWideTrees(bool flag)
+{
+	m_useWideTrees = flag;
+}
+
+void b2BroadPhase::BuildWideTrees()
+{
+	for (int32 tree = 0; tree < e_treeCount; ++tree)
+	{
+		BuildWideTree(tree);
+	}
+}
+
+void b2BroadPhase::BuildWideTree(int32 tree)
+{
+	if (m_useWideTrees && m_wideTreeValid[tree] == false)
+	{
+		m_wideTrees[tree].Build(m_trees + tree);
+		m_wideTreeValid[tree] = true;
+	}
+}
+
 void b2BroadPhase::BufferMove(int32 proxyId)
 {
 	if (m_moveCount == m_moveCapacity)
@@ -92,9 +122,11 @@ void b2BroadPhase::UnBufferMove(int32 proxyId)
 	}
 }
 
-// This is called from b2DynamicTree::Query when we are gathering pairs.
-bool b2BroadPhase::QueryCallback(int32 proxyId)
+// This is called from b2DynamicTree::Query and b2WideTree::Query when we are gathering pairs.
+bool b2BroadPhase::QueryCallback(int32 nodeId)
 {
+	int32 proxyId = GetProxyId(nodeId, m_queryTree);
+
 	// A proxy cannot form a pair with itself.
 	if (proxyId == m_queryProxyId)
 	{
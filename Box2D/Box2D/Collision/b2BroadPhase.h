@@ -22,6 +22,7 @@
 #include <Box2D/Common/b2Settings.h>
 #include <Box2D/Collision/b2Collision.h>
 #include <Box2D/Collision/b2DynamicTree.h>
+#include <Box2D/Collision/b2WideTree.h>
 #include <algorithm>
 
 struct b2Pair
@@ -33,6 +34,14 @@ struct b2Pair
 /// The broad-phase is used for computing pairs and performing volume queries and ray casts.
 /// This broad-phase does not persist pairs. Instead, this reports potentially new pairs.
 /// It is up to the client to consume the new pairs and to track subsequent overlap.
+/// Static proxies live in a tree of their own, so that moving proxies only meet the
+/// static geometry in their own query and static proxies never query each other.
+/// A proxy id is the node index in its tree shifted left by one, ored with the tree.
+/// Queries run on 4-ary copies of the trees (see b2WideTree) while these are up to
+/// date, and on the binary trees otherwise. UpdatePairs rebuilds the static copy
+/// after static proxies have changed, which is rare. The dynamic copy goes stale
+/// as soon as a proxy leaves its fat AABB and is only rebuilt by BuildWideTrees,
+/// so moving proxies never cost a rebuild in the step or in a query.
 class b2BroadPhase
 {
 public:
@@ -42,12 +51,19 @@ public:
 		e_nullProxy = -1
 	};
 
+	enum
+	{
+		e_staticTree = 0,
+		e_dynamicTree = 1,
+		e_treeCount = 2
+	};
+
 	b2BroadPhase();
 	~b2BroadPhase();
 
 	/// Create a proxy with an initial AABB. Pairs are not reported until
-	/// UpdatePairs is called.
-	int32 CreateProxy(const b2AABB& aabb, void* userData);
+	/// UpdatePairs is called. Static proxies go into the static tree.
+	int32 CreateProxy(const b2AABB& aabb, void* userData, bool isStatic = false);
 
 	/// Destroy a proxy. It is up to the client to remove any pairs.
 	void DestroyProxy(int32 proxyId);
@@ -90,30 +106,91 @@ public:
 	template <typename T>
 	void RayCast(T* callback, const b2RayCastInput& input) const;
 
-	/// Get the height of the embedded tree.
+	/// Get the height of the higher of the embedded trees.
 	int32 GetTreeHeight() const;
 
-	/// Get the balance of the embedded tree.
+	/// Get the balance of the less balanced of the embedded trees.
 	int32 GetTreeBalance() const;
 
-	/// Get the quality metric of the embedded tree.
+	/// Get the quality metric of the worse of the embedded trees.
 	float32 GetTreeQuality() const;
 
+	/// Rebuild the embedded trees from scratch. Proxy ids stay valid.
+	/// @see b2DynamicTree::RebuildTopDown
+	void RebuildTree();
+
 	/// Shift the world origin. Useful for large worlds.
 	/// The shift formula is: position -= newOrigin
 	/// @param newOrigin the new origin with respect to the old origin
 	void ShiftOrigin(const b2Vec2& newOrigin);
 
+	/// Enable/disable the 4-ary query trees. Disabling them makes all
+	/// queries use the binary trees. Both report the same proxies in the same order.
+	void SetWideTrees(bool flag);
+
+	/// Are the 4-ary query trees enabled?
+	bool GetWideTrees() const;
+
+	/// Rebuild the 4-ary query trees whose binary tree has changed, including
+	/// the dynamic one, which is not rebuilt otherwise.
+	void BuildWideTrees();
+
 private:
 
 	friend class b2DynamicTree;
+	friend class b2WideTree;
+
+	/// Translates the node ids reported by one tree into proxy ids
+	/// and remembers whether the client stopped the query or clipped the ray.
+	template <typename T>
+	struct TreeCallback
+	{
+		bool QueryCallback(int32 nodeId)
+		{
+			proceed = callback->QueryCallback(GetProxyId(nodeId, tree));
+			return proceed;
+		}
+
+		float32 RayCastCallback(const b2RayCastInput& input, int32 nodeId)
+		{
+			float32 value = callback->RayCastCallback(input, GetProxyId(nodeId, tree));
+			if (value == 0.0f)
+			{
+				proceed = false;
+			}
+			else if (value > 0.0f)
+			{
+				maxFraction = value;
+			}
+			return value;
+		}
+
+		T* callback;
+		int32 tree;
+		bool proceed;
+		float32 maxFraction;
+	};
+
+	static int32 GetProxyId(int32 nodeId, int32 tree);
+	static int32 GetNodeId(int32 proxyId);
+	static int32 GetTreeIndex(int32 proxyId);
 
 	void BufferMove(int32 proxyId);
 	void UnBufferMove(int32 proxyId);
 
-	bool QueryCallback(int32 proxyId);
+	void BuildWideTree(int32 tree);
+	bool IsWideTreeValid(int32 tree) const;
+
+	template <typename T>
+	void QueryTree(T* callback, int32 tree, const b2AABB& aabb) const;
+
+	bool QueryCallback(int32 nodeId);
 
-	b2DynamicTree m_tree;
+	b2DynamicTree m_trees[e_treeCount];
+
+	b2WideTree m_wideTrees[e_treeCount];
+	bool m_wideTreeValid[e_treeCount];
+	bool m_useWideTrees;
 
 	int32 m_proxyCount;
 
@@ -126,6 +203,7 @@ private:
 	int32 m_pairCount;
 
 	int32 m_queryProxyId;
+	int32 m_queryTree;
 };
 
 /// This is used to sort pairs.
@@ -144,21 +222,36 @@ inline bool b2PairLessThan(const b2Pair& pair1, const b2Pair& pair2)
 	return false;
 }
 
+inline int32 b2BroadPhase::GetProxyId(int32 nodeId, int32 tree)
+{
+	return (nodeId << 1) | tree;
+}
+
+inline int32 b2BroadPhase::GetNodeId(int32 proxyId)
+{
+	return proxyId >> 1;
+}
+
+inline int32 b2BroadPhase::GetTreeIndex(int32 proxyId)
+{
+	return proxyId & 1;
+}
+
 inline void* b2BroadPhase::GetUserData(int32 proxyId) const
 {
-	return m_tree.GetUserData(proxyId);
+	return m_trees[GetTreeIndex(proxyId)].GetUserData(GetNodeId(proxyId));
 }
 
 inline bool b2BroadPhase::TestOverlap(int32 proxyIdA, int32 proxyIdB) const
 {
-	const b2AABB& aabbA = m_tree.GetFatAABB(proxyIdA);
-	const b2AABB& aabbB = m_tree.GetFatAABB(proxyIdB);
+	const b2AABB& aabbA = GetFatAABB(proxyIdA);
+	const b2AABB& aabbB = GetFatAABB(proxyIdB);
 	return b2TestOverlap(aabbA, aabbB);
 }
 
 inline const b2AABB& b2BroadPhase::GetFatAABB(int32 proxyId) const
 {
-	return m_tree.GetFatAABB(proxyId);
+	return m_trees[GetTreeIndex(proxyId)].GetFatAABB(GetNodeId(proxyId));
 }
 
 inline int32 b2BroadPhase::GetProxyCount() const
@@ -168,17 +261,48 @@ inline int32 b2BroadPhase::GetProxyCount() const
 
 inline int32 b2BroadPhase::GetTreeHeight() const
 {
-	return m_tree.GetHeight();
+	return b2Max(m_trees[e_staticTree].GetHeight(), m_trees[e_dynamicTree].GetHeight());
 }
 
 inline int32 b2BroadPhase::GetTreeBalance() const
 {
-	return m_tree.GetMaxBalance();
+	return b2Max(m_trees[e_staticTree].GetMaxBalance(), m_trees[e_dynamicTree].GetMaxBalance());
 }
 
 inline float32 b2BroadPhase::GetTreeQuality() const
 {
-	return m_tree.GetAreaRatio();
+	return b2Max(m_trees[e_staticTree].GetAreaRatio(), m_trees[e_dynamicTree].GetAreaRatio());
+}
+
+inline void b2BroadPhase::RebuildTree()
+{
+	m_trees[e_staticTree].RebuildTopDown();
+	m_trees[e_dynamicTree].RebuildTopDown();
+	m_wideTreeValid[e_staticTree] = false;
+	m_wideTreeValid[e_dynamicTree] = false;
+}
+
+inline bool b2BroadPhase::GetWideTrees() const
+{
+	return m_useWideTrees;
+}
+
+inline bool b2BroadPhase::IsWideTreeValid(int32 tree) const
+{
+	return m_useWideTrees && m_wideTreeValid[tree];
+}
+
+template <typename T>
+inline void b2BroadPhase::QueryTree(T* callback, int32 tree, const b2AABB& aabb) const
+{
+	if (IsWideTreeValid(tree))
+	{
+		m_wideTrees[tree].Query(callback, aabb);
+	}
+	else
+	{
+		m_trees[tree].Query(callback, aabb);
+	}
 }
 
 template <typename T>
@@ -187,6 +311,13 @@ void b2BroadPhase::UpdatePairs(T* callback)
 	// Reset pair buffer
 	m_pairCount = 0;
 
+	// Every moving proxy queries the static tree, which rarely changes.
+	// Rebuilding the dynamic copy would cost O(n) on nearly every step.
+	if (m_moveCount > 0)
+	{
+		BuildWideTree(e_staticTree);
+	}
+
 	// Perform tree queries for all moving proxies.
 	for (int32 i = 0; i < m_moveCount; ++i)
 	{
@@ -198,10 +329,18 @@ void b2BroadPhase::UpdatePairs(T* callback)
 
 		// We have to query the tree with the fat AABB so that
 		// we don't fail to create a pair that may touch later.
-		const b2AABB& fatAABB = m_tree.GetFatAABB(m_queryProxyId);
+		const b2AABB& fatAABB = GetFatAABB(m_queryProxyId);
 
-		// Query tree, create pairs and add them pair buffer.
-		m_tree.Query(this, fatAABB);
+		// Query trees, create pairs and add them pair buffer.
+		// Static proxies cannot form pairs with each other.
+		if (GetTreeIndex(m_queryProxyId) == e_dynamicTree)
+		{
+			m_queryTree = e_staticTree;
+			QueryTree(this, e_staticTree, fatAABB);
+		}
+
+		m_queryTree = e_dynamicTree;
+		QueryTree(this, e_dynamicTree, fatAABB);
 	}
 
 	// Reset move buffer
@@ -215,8 +354,8 @@ void b2BroadPhase::UpdatePairs(T* callback)
 	while (i < m_pairCount)
 	{
 		b2Pair* primaryPair = m_pairBuffer + i;
-		void* userDataA = m_tree.GetUserData(primaryPair->proxyIdA);
-		void* userDataB = m_tree.GetUserData(primaryPair->proxyIdB);
+		void* userDataA = GetUserData(primaryPair->proxyIdA);
+		void* userDataB = GetUserData(primaryPair->proxyIdB);
 
 		callback->AddPair(userDataA, userDataB);
 		++i;
@@ -240,18 +379,49 @@ void b2BroadPhase::UpdatePairs(T* callback)
 template <typename T>
 inline void b2BroadPhase::Query(T* callback, const b2AABB& aabb) const
 {
-	m_tree.Query(callback, aabb);
+	TreeCallback<T> treeCallback;
+	treeCallback.callback = callback;
+	treeCallback.proceed = true;
+
+	for (int32 tree = 0; tree < e_treeCount && treeCallback.proceed; ++tree)
+	{
+		treeCallback.tree = tree;
+		QueryTree(&treeCallback, tree, aabb);
+	}
 }
 
 template <typename T>
 inline void b2BroadPhase::RayCast(T* callback, const b2RayCastInput& input) const
 {
-	m_tree.RayCast(callback, input);
+	TreeCallback<T> treeCallback;
+	treeCallback.callback = callback;
+	treeCallback.proceed = true;
+	treeCallback.maxFraction = input.maxFraction;
+
+	// The second tree only needs to be searched up to the
+	// closest hit the client has accepted in the first one.
+	b2RayCastInput treeInput = input;
+	for (int32 tree = 0; tree < e_treeCount && treeCallback.proceed; ++tree)
+	{
+		treeCallback.tree = tree;
+		treeInput.maxFraction = treeCallback.maxFraction;
+		if (IsWideTreeValid(tree))
+		{
+			m_wideTrees[tree].RayCast(&treeCallback, treeInput);
+		}
+		else
+		{
+			m_trees[tree].RayCast(&treeCallback, treeInput);
+		}
+	}
 }
 
 inline void b2BroadPhase::ShiftOrigin(const b2Vec2& newOrigin)
 {
-	m_tree.ShiftOrigin(newOrigin);
+	m_trees[e_staticTree].ShiftOrigin(newOrigin);
+	m_trees[e_dynamicTree].ShiftOrigin(newOrigin);
+	m_wideTreeValid[e_staticTree] = false;
+	m_wideTreeValid[e_dynamicTree] = false;
 }
 
 #endif
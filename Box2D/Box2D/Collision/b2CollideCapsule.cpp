@@ -0,0 +1,133 @@
+/*
+* Copyright (c) 2006-2010 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Collision/b2Collision.h>
+#include <Box2D/Collision/b2Distance.h>
+#include <Box2D/Collision/Shapes/b2CapsuleShape.h>
+#include <Box2D/Collision/Shapes/b2CircleShape.h>
+#include <Box2D/Collision/Shapes/b2EdgeShape.h>
+#include <Box2D/Collision/Shapes/b2PolygonShape.h>
+
+// A segment with a radius, seen as a polygon with two vertices and
+// two opposite faces. b2CollidePolygons() handles it exactly as long as
+// the reference face is one of these sides or a face of the other
+// polygon: a rounded end against a plane is just a vertex with a radius.
+static void b2SetAsSegment(b2PolygonShape* polygon, const b2Vec2& v1, const b2Vec2& v2, float32 radius)
+{
+	polygon->m_count = 2;
+	polygon->m_vertices[0] = v1;
+	polygon->m_vertices[1] = v2;
+	polygon->m_normals[0] = b2Cross(v2 - v1, 1.0f);
+	polygon->m_normals[0].Normalize();
+	polygon->m_normals[1] = -polygon->m_normals[0];
+	polygon->m_centroid = 0.5f * (v1 + v2);
+	polygon->m_radius = radius;
+}
+
+// The face normals miss the one case b2CollidePolygons() cannot handle:
+// a rounded end against a vertex, where the separating axis runs between
+// the two points. The distance between the cores finds it: if the closest
+// features are a single vertex on each side, the contact is a point
+// versus point contact like the one between two circles.
+static void b2CollideSegmentAndPolygon(b2Manifold* manifold,
+									   const b2PolygonShape* segmentA, const b2Transform& xfA,
+									   const b2PolygonShape* polygonB, const b2Transform& xfB)
+{
+	manifold->pointCount = 0;
+
+	b2DistanceInput input;
+	input.proxyA.Set(segmentA, 0);
+	input.proxyB.Set(polygonB, 0);
+	input.transformA = xfA;
+	input.transformB = xfB;
+	input.useRadii = false;
+
+	b2SimplexCache cache;
+	cache.count = 0;
+
+	b2DistanceOutput output;
+	b2Distance(&output, &cache, &input);
+
+	float32 totalRadius = segmentA->m_radius + polygonB->m_radius;
+	if (output.distance > totalRadius)
+	{
+		return;
+	}
+
+	if (output.distance > 0.1f * b2_linearSlop && cache.count == 1)
+	{
+		manifold->type = b2Manifold::e_circles;
+		manifold->localPoint = b2MulT(xfA, output.pointA);
+		manifold->localNormal.SetZero();
+		manifold->pointCount = 1;
+
+		b2ManifoldPoint* mp = manifold->points + 0;
+		mp->localPoint = b2MulT(xfB, output.pointB);
+		mp->id.key = 0;
+		mp->id.cf.indexA = cache.indexA[0];
+		mp->id.cf.indexB = cache.indexB[0];
+		mp->id.cf.typeA = b2ContactFeature::e_vertex;
+		mp->id.cf.typeB = b2ContactFeature::e_vertex;
+		return;
+	}
+
+	b2CollidePolygons(manifold, segmentA, xfA, polygonB, xfB);
+}
+
+void b2CollideCapsules(b2Manifold* manifold,
+					   const b2CapsuleShape* capsuleA, const b2Transform& xfA,
+					   const b2CapsuleShape* capsuleB, const b2Transform& xfB)
+{
+	b2PolygonShape segmentA, segmentB;
+	b2SetAsSegment(&segmentA, capsuleA->m_vertex1, capsuleA->m_vertex2, capsuleA->m_radius);
+	b2SetAsSegment(&segmentB, capsuleB->m_vertex1, capsuleB->m_vertex2, capsuleB->m_radius);
+	b2CollideSegmentAndPolygon(manifold, &segmentA, xfA, &segmentB, xfB);
+}
+
+// An isolated edge with the capsule's radius has exactly the capsule's
+// outline, so the edge versus circle regions apply unchanged.
+void b2CollideCapsuleAndCircle(b2Manifold* manifold,
+							   const b2CapsuleShape* capsuleA, const b2Transform& xfA,
+							   const b2CircleShape* circleB, const b2Transform& xfB)
+{
+	b2EdgeShape edgeA;
+	edgeA.Set(capsuleA->m_vertex1, capsuleA->m_vertex2);
+	edgeA.m_radius = capsuleA->m_radius;
+	b2CollideEdgeAndCircle(manifold, &edgeA, xfA, circleB, xfB);
+}
+
+void b2CollideCapsuleAndPolygon(b2Manifold* manifold,
+								const b2CapsuleShape* capsuleA, const b2Transform& xfA,
+								const b2PolygonShape* polygonB, const b2Transform& xfB)
+{
+	b2PolygonShape segmentA;
+	b2SetAsSegment(&segmentA, capsuleA->m_vertex1, capsuleA->m_vertex2, capsuleA->m_radius);
+	b2CollideSegmentAndPolygon(manifold, &segmentA, xfA, polygonB, xfB);
+}
+
+// The edge's neighbours are ignored: capsules are round at their ends
+// and do not snag on the inner vertices of a chain like boxes do.
+void b2CollideEdgeAndCapsule(b2Manifold* manifold,
+							 const b2EdgeShape* edgeA, const b2Transform& xfA,
+							 const b2CapsuleShape* capsuleB, const b2Transform& xfB)
+{
+	b2PolygonShape segmentA, segmentB;
+	b2SetAsSegment(&segmentA, edgeA->m_vertex1, edgeA->m_vertex2, edgeA->m_radius);
+	b2SetAsSegment(&segmentB, capsuleB->m_vertex1, capsuleB->m_vertex2, capsuleB->m_radius);
+	b2CollideSegmentAndPolygon(manifold, &segmentA, xfA, &segmentB, xfB);
+}
@@ -30,6 +30,7 @@ class b2Shape;
 class b2CircleShape;
 class b2EdgeShape;
 class b2PolygonShape;
+class b2CapsuleShape;
 
 const uint8 b2_nullFeature = UCHAR_MAX;
 
@@ -240,6 +241,26 @@ void b2CollideEdgeAndPolygon(b2Manifold* manifold,
 							   const b2EdgeShape* edgeA, const b2Transform& xfA,
 							   const b2PolygonShape* circleB, const b2Transform& xfB);
 
+/// Compute the collision manifold between two capsules.
+void b2CollideCapsules(b2Manifold* manifold,
+					   const b2CapsuleShape* capsuleA, const b2Transform& xfA,
+					   const b2CapsuleShape* capsuleB, const b2Transform& xfB);
+
+/// Compute the collision manifold between a capsule and a circle.
+void b2CollideCapsuleAndCircle(b2Manifold* manifold,
+							   const b2CapsuleShape* capsuleA, const b2Transform& xfA,
+							   const b2CircleShape* circleB, const b2Transform& xfB);
+
+/// Compute the collision manifold between a capsule and a polygon.
+void b2CollideCapsuleAndPolygon(b2Manifold* manifold,
+								const b2CapsuleShape* capsuleA, const b2Transform& xfA,
+								const b2PolygonShape* polygonB, const b2Transform& xfB);
+
+/// Compute the collision manifold between an edge and a capsule.
+void b2CollideEdgeAndCapsule(b2Manifold* manifold,
+							 const b2EdgeShape* edgeA, const b2Transform& xfA,
+							 const b2CapsuleShape* capsuleB, const b2Transform& xfB);
+
 /// Clipping for contact manifolds.
 int32 b2ClipSegmentToLine(b2ClipVertex vOut[2], const b2ClipVertex vIn[2],
 							const b2Vec2& normal, float32 offset, int32 vertexIndexA);
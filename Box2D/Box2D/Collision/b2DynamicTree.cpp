@@ -18,6 +18,10 @@
 
 #include <Box2D/Collision/b2DynamicTree.h>
 #include <string.h>
+#include <algorithm>
+
+// Number of bins used to evaluate the surface area heuristic in RebuildTopDown.
+#define b2_treeBinCount 16
 
 b2DynamicTree::b2DynamicTree()
 {
@@ -767,6 +771,197 @@ void b2DynamicTree::RebuildBottomUp()
 	Validate();
 }
 
+void b2DynamicTree::RebuildTopDown()
+{
+	if (m_root == b2_nullNode)
+	{
+		return;
+	}
+
+	int32* leaves = (int32*)b2Alloc(m_nodeCount * sizeof(int32));
+	int32 count = 0;
+
+	// Build array of leaves. Free the rest.
+	for (int32 i = 0; i < m_nodeCapacity; ++i)
+	{
+		if (m_nodes[i].height < 0)
+		{
+			// free node in pool
+			continue;
+		}
+
+		if (m_nodes[i].IsLeaf())
+		{
+			m_nodes[i].parent = b2_nullNode;
+			leaves[count] = i;
+			++count;
+		}
+		else
+		{
+			FreeNode(i);
+		}
+	}
+
+	// The freed internal nodes are exactly the ones needed again,
+	// so the node pool does not grow.
+	m_root = BuildTopDown(leaves, count);
+	m_nodes[m_root].parent = b2_nullNode;
+	b2Free(leaves);
+
+	Validate();
+}
+
+// Build a subtree over the given leaves and return its root.
+int32 b2DynamicTree::BuildTopDown(int32* leaves, int32 count)
+{
+	b2Assert(count > 0);
+
+	if (count == 1)
+	{
+		return leaves[0];
+	}
+
+	// Split along the longer axis of the bounds of the leaf centers.
+	b2Vec2 lower = m_nodes[leaves[0]].aabb.GetCenter();
+	b2Vec2 upper = lower;
+	for (int32 i = 1; i < count; ++i)
+	{
+		b2Vec2 c = m_nodes[leaves[i]].aabb.GetCenter();
+		lower = b2Min(lower, c);
+		upper = b2Max(upper, c);
+	}
+
+	b2Vec2 extent = upper - lower;
+	int32 axis = extent.x >= extent.y ? 0 : 1;
+	float32 axisLower = lower(axis);
+	float32 axisExtent = extent(axis);
+
+	int32 split = 0;
+	if (axisExtent > b2_epsilon)
+	{
+		// Sort the leaves into bins by their centers.
+		int32 binCounts[b2_treeBinCount];
+		b2AABB binAABBs[b2_treeBinCount];
+		for (int32 i = 0; i < b2_treeBinCount; ++i)
+		{
+			binCounts[i] = 0;
+		}
+
+		float32 binScale = b2_treeBinCount / axisExtent;
+		for (int32 i = 0; i < count; ++i)
+		{
+			const b2AABB& aabb = m_nodes[leaves[i]].aabb;
+			int32 bin = b2Min(int32(binScale * (aabb.GetCenter()(axis) - axisLower)), b2_treeBinCount - 1);
+			if (binCounts[bin] == 0)
+			{
+				binAABBs[bin] = aabb;
+			}
+			else
+			{
+				binAABBs[bin].Combine(aabb);
+			}
+			++binCounts[bin];
+		}
+
+		// Sweep from the right to get the cost of everything right of a plane ...
+		float32 rightCosts[b2_treeBinCount];
+		{
+			b2AABB aabb;
+			int32 n = 0;
+			rightCosts[b2_treeBinCount - 1] = b2_maxFloat;
+			for (int32 i = b2_treeBinCount - 1; i > 0; --i)
+			{
+				if (binCounts[i] > 0)
+				{
+					if (n == 0)
+					{
+						aabb = binAABBs[i];
+					}
+					else
+					{
+						aabb.Combine(binAABBs[i]);
+					}
+					n += binCounts[i];
+				}
+				rightCosts[i - 1] = n > 0 ? n * aabb.GetPerimeter() : b2_maxFloat;
+			}
+		}
+
+		// ... and from the left to find the cheapest plane.
+		float32 minCost = b2_maxFloat;
+		int32 bestBin = -1;
+		{
+			b2AABB aabb;
+			int32 n = 0;
+			for (int32 i = 0; i < b2_treeBinCount - 1; ++i)
+			{
+				if (binCounts[i] > 0)
+				{
+					if (n == 0)
+					{
+						aabb = binAABBs[i];
+					}
+					else
+					{
+						aabb.Combine(binAABBs[i]);
+					}
+					n += binCounts[i];
+				}
+				if (n == 0 || rightCosts[i] == b2_maxFloat)
+				{
+					continue;
+				}
+
+				float32 cost = n * aabb.GetPerimeter() + rightCosts[i];
+				if (cost < minCost)
+				{
+					minCost = cost;
+					bestBin = i;
+				}
+			}
+		}
+
+		if (bestBin >= 0)
+		{
+			// Move the leaves left of the plane to the front.
+			for (int32 i = 0; i < count; ++i)
+			{
+				float32 c = m_nodes[leaves[i]].aabb.GetCenter()(axis);
+				int32 bin = b2Min(int32(binScale * (c - axisLower)), b2_treeBinCount - 1);
+				if (bin <= bestBin)
+				{
+					b2Swap(leaves[i], leaves[split]);
+					++split;
+				}
+			}
+		}
+	}
+
+	if (split == 0 || split == count)
+	{
+		// Median split.
+		split = count / 2;
+		const b2TreeNode* nodes = m_nodes;
+		std::nth_element(leaves, leaves + split, leaves + count, [nodes, axis](int32 a, int32 b)
+		{
+			return nodes[a].aabb.GetCenter()(axis) < nodes[b].aabb.GetCenter()(axis);
+		});
+	}
+
+	int32 child1 = BuildTopDown(leaves, split);
+	int32 child2 = BuildTopDown(leaves + split, count - split);
+
+	int32 parent = AllocateNode();
+	m_nodes[parent].child1 = child1;
+	m_nodes[parent].child2 = child2;
+	m_nodes[parent].height = 1 + b2Max(m_nodes[child1].height, m_nodes[child2].height);
+	m_nodes[parent].aabb.Combine(m_nodes[child1].aabb, m_nodes[child2].aabb);
+	m_nodes[child1].parent = parent;
+	m_nodes[child2].parent = parent;
+
+	return parent;
+}
+
 void b2DynamicTree::ShiftOrigin(const b2Vec2& newOrigin)
 {
 	// Build array of leaves. Free the rest.
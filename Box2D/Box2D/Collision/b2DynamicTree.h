@@ -118,6 +118,13 @@ public:
 	/// Build an optimal tree. Very expensive. For testing.
 	void RebuildBottomUp();
 
+	/// Rebuild the tree top-down from all of its leaves. Each node is split where
+	/// the surface area heuristic over binned leaf centers is lowest, falling back to
+	/// a median split if the centers cannot be separated. Proxy ids stay valid.
+	/// This is O(n log n) and meant to be called after many proxies were created
+	/// at once, e.g. when a level has been loaded.
+	void RebuildTopDown();
+
 	/// Shift the world origin. Useful for large worlds.
 	/// The shift formula is: position -= newOrigin
 	/// @param newOrigin the new origin with respect to the old origin
@@ -125,6 +132,8 @@ public:
 
 private:
 
+	friend class b2WideTree;
+
 	int32 AllocateNode();
 	void FreeNode(int32 node);
 
@@ -133,6 +142,8 @@ private:
 
 	int32 Balance(int32 index);
 
+	int32 BuildTopDown(int32* leaves, int32 count);
+
 	int32 ComputeHeight() const;
 	int32 ComputeHeight(int32 nodeId) const;
 
@@ -0,0 +1,175 @@
+/*
+* Copyright (c) 2006-2010 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#include <Box2D/Collision/b2WideTree.h>
+
+#if B2_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+b2WideTree::b2WideTree()
+{
+	m_tree = NULL;
+	m_root = b2_nullNode;
+
+	m_nodeCapacity = 16;
+	m_nodeCount = 0;
+	m_nodes = (b2WideNode*)b2Alloc(m_nodeCapacity * sizeof(b2WideNode));
+}
+
+b2WideTree::~b2WideTree()
+{
+	b2Free(m_nodes);
+}
+
+void b2WideTree::Build(const b2DynamicTree* tree)
+{
+	m_tree = tree;
+	m_root = b2_nullNode;
+	m_nodeCount = 0;
+
+	if (tree->m_root == b2_nullNode)
+	{
+		return;
+	}
+
+	// Every wide node is made from a different internal node of the binary
+	// tree, except for a root that is a leaf.
+	if (m_nodeCapacity < tree->m_nodeCount)
+	{
+		b2Free(m_nodes);
+		m_nodeCapacity = tree->m_nodeCapacity;
+		m_nodes = (b2WideNode*)b2Alloc(m_nodeCapacity * sizeof(b2WideNode));
+	}
+
+	const b2TreeNode* root = tree->m_nodes + tree->m_root;
+	if (root->IsLeaf() == false)
+	{
+		m_root = BuildNode(tree->m_root);
+		return;
+	}
+
+	m_root = m_nodeCount++;
+	b2WideNode* node = m_nodes + m_root;
+	node->aabb = root->aabb;
+	node->leafMask = 1;
+	for (int32 i = 0; i < 4; ++i)
+	{
+		node->lowerX[i] = b2_maxFloat;
+		node->lowerY[i] = b2_maxFloat;
+		node->upperX[i] = -b2_maxFloat;
+		node->upperY[i] = -b2_maxFloat;
+		node->children[i] = b2_nullNode;
+	}
+	node->lowerX[0] = root->aabb.lowerBound.x;
+	node->lowerY[0] = root->aabb.lowerBound.y;
+	node->upperX[0] = root->aabb.upperBound.x;
+	node->upperY[0] = root->aabb.upperBound.y;
+	node->children[0] = tree->m_root;
+}
+
+// Collapse an internal node of the binary tree and its children into a
+// wide node. Leaf children keep their slot, internal children are replaced
+// by their own two children.
+int32 b2WideTree::BuildNode(int32 nodeId)
+{
+	const b2TreeNode* nodes = m_tree->m_nodes;
+	const b2TreeNode* binaryNode = nodes + nodeId;
+	b2Assert(binaryNode->IsLeaf() == false);
+
+	int32 slots[4];
+	int32 slotCount = 0;
+	int32 children[2] = { binaryNode->child1, binaryNode->child2 };
+	for (int32 i = 0; i < 2; ++i)
+	{
+		const b2TreeNode* child = nodes + children[i];
+		if (child->IsLeaf())
+		{
+			slots[slotCount++] = children[i];
+		}
+		else
+		{
+			slots[slotCount++] = child->child1;
+			slots[slotCount++] = child->child2;
+		}
+	}
+
+	int32 index = m_nodeCount++;
+	b2Assert(index < m_nodeCapacity);
+
+	b2WideNode* node = m_nodes + index;
+	node->aabb = binaryNode->aabb;
+	node->leafMask = 0;
+
+	for (int32 i = 0; i < 4; ++i)
+	{
+		if (i >= slotCount)
+		{
+			// Unused children never overlap anything.
+			node->lowerX[i] = b2_maxFloat;
+			node->lowerY[i] = b2_maxFloat;
+			node->upperX[i] = -b2_maxFloat;
+			node->upperY[i] = -b2_maxFloat;
+			node->children[i] = b2_nullNode;
+			continue;
+		}
+
+		const b2TreeNode* slot = nodes + slots[i];
+		node->lowerX[i] = slot->aabb.lowerBound.x;
+		node->lowerY[i] = slot->aabb.lowerBound.y;
+		node->upperX[i] = slot->aabb.upperBound.x;
+		node->upperY[i] = slot->aabb.upperBound.y;
+
+		if (slot->IsLeaf())
+		{
+			node->children[i] = slots[i];
+			node->leafMask |= 1 << i;
+		}
+		else
+		{
+			// The pool does not grow, so the node stays in place.
+			node->children[i] = BuildNode(slots[i]);
+		}
+	}
+
+	return index;
+}
+
+int32 b2WideTree::GetOverlapMask(const b2WideNode* node, const b2AABB& aabb)
+{
+#if B2_USE_SSE2
+	__m128 separatedX = _mm_or_ps(_mm_cmpgt_ps(_mm_loadu_ps(node->lowerX), _mm_set1_ps(aabb.upperBound.x)),
+								  _mm_cmpgt_ps(_mm_set1_ps(aabb.lowerBound.x), _mm_loadu_ps(node->upperX)));
+	__m128 separatedY = _mm_or_ps(_mm_cmpgt_ps(_mm_loadu_ps(node->lowerY), _mm_set1_ps(aabb.upperBound.y)),
+								  _mm_cmpgt_ps(_mm_set1_ps(aabb.lowerBound.y), _mm_loadu_ps(node->upperY)));
+	return ~_mm_movemask_ps(_mm_or_ps(separatedX, separatedY)) & 0xf;
+#else
+	int32 mask = 0;
+	for (int32 i = 0; i < 4; ++i)
+	{
+		if (node->lowerX[i] > aabb.upperBound.x || aabb.lowerBound.x > node->upperX[i] ||
+			node->lowerY[i] > aabb.upperBound.y || aabb.lowerBound.y > node->upperY[i])
+		{
+			continue;
+		}
+		mask |= 1 << i;
+	}
+	return mask;
+#endif
+}
@@ -0,0 +1,240 @@
+/*
+* Copyright (c) 2006-2010 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#ifndef B2_WIDE_TREE_H
+#define B2_WIDE_TREE_H
+
+#include <Box2D/Collision/b2DynamicTree.h>
+
+/// A node of a b2WideTree. The bounds of the four children are stored
+/// per coordinate, so that all four can be tested at once.
+struct b2WideNode
+{
+	float32 lowerX[4];
+	float32 lowerY[4];
+	float32 upperX[4];
+	float32 upperY[4];
+
+	/// Wide node indices of internal children, node ids of the binary
+	/// tree for leaves, or b2_nullNode for unused children.
+	int32 children[4];
+
+	/// Bit i is set if child i is a leaf.
+	int32 leafMask;
+
+	/// The enlarged AABB of the binary tree node this node was made from.
+	b2AABB aabb;
+};
+
+/// A 4-ary copy of a b2DynamicTree for faster queries. Every node takes the
+/// children and grandchildren of a binary tree node, and the overlap tests of
+/// all four are done with one SSE2 comparison. Queries and ray casts report
+/// the same proxies in the same order as the binary tree does, with the node
+/// ids of the binary tree. The wide tree does not follow changes to the
+/// binary tree; call Build again after the binary tree has changed.
+class b2WideTree
+{
+public:
+
+	/// Constructing the tree initializes the node pool.
+	b2WideTree();
+
+	/// Destroy the tree, freeing the node pool.
+	~b2WideTree();
+
+	/// Copy the binary tree. The binary tree must outlive this copy.
+	void Build(const b2DynamicTree* tree);
+
+	/// Query an AABB for overlapping proxies. The callback class
+	/// is called for each proxy that overlaps the supplied AABB.
+	template <typename T>
+	void Query(T* callback, const b2AABB& aabb) const;
+
+	/// Ray-cast against the proxies in the tree, as b2DynamicTree::RayCast.
+	template <typename T>
+	void RayCast(T* callback, const b2RayCastInput& input) const;
+
+	/// Get the number of wide nodes.
+	int32 GetNodeCount() const;
+
+private:
+
+	int32 BuildNode(int32 nodeId);
+
+	/// Get a mask of the children of a node whose bounds overlap the AABB.
+	static int32 GetOverlapMask(const b2WideNode* node, const b2AABB& aabb);
+
+	/// Stack entries are node indices shifted left by one, ored with 1 for leaves.
+	static int32 GetEntry(const b2WideNode* node, int32 child);
+
+	const b2DynamicTree* m_tree;
+
+	int32 m_root;
+
+	b2WideNode* m_nodes;
+	int32 m_nodeCount;
+	int32 m_nodeCapacity;
+};
+
+inline int32 b2WideTree::GetNodeCount() const
+{
+	return m_nodeCount;
+}
+
+inline int32 b2WideTree::GetEntry(const b2WideNode* node, int32 child)
+{
+	return (node->children[child] << 1) | ((node->leafMask >> child) & 1);
+}
+
+template <typename T>
+inline void b2WideTree::Query(T* callback, const b2AABB& aabb) const
+{
+	if (m_root == b2_nullNode)
+	{
+		return;
+	}
+
+	b2GrowableStack<int32, 256> stack;
+	stack.Push(m_root << 1);
+
+	while (stack.GetCount() > 0)
+	{
+		int32 entry = stack.Pop();
+		int32 index = entry >> 1;
+
+		if (entry & 1)
+		{
+			bool proceed = callback->QueryCallback(index);
+			if (proceed == false)
+			{
+				return;
+			}
+			continue;
+		}
+
+		// Children are pushed in the order the binary tree pushes them,
+		// so they are visited in the same order.
+		const b2WideNode* node = m_nodes + index;
+		int32 mask = GetOverlapMask(node, aabb);
+		for (int32 i = 0; i < 4; ++i)
+		{
+			if (mask & (1 << i))
+			{
+				stack.Push(GetEntry(node, i));
+			}
+		}
+	}
+}
+
+template <typename T>
+inline void b2WideTree::RayCast(T* callback, const b2RayCastInput& input) const
+{
+	if (m_root == b2_nullNode)
+	{
+		return;
+	}
+
+	b2Vec2 p1 = input.p1;
+	b2Vec2 p2 = input.p2;
+	b2Vec2 r = p2 - p1;
+	b2Assert(r.LengthSquared() > 0.0f);
+	r.Normalize();
+
+	// v is perpendicular to the segment.
+	b2Vec2 v = b2Cross(1.0f, r);
+	b2Vec2 abs_v = b2Abs(v);
+
+	float32 maxFraction = input.maxFraction;
+
+	// Build a bounding box for the segment.
+	b2AABB segmentAABB;
+	{
+		b2Vec2 t = p1 + maxFraction * (p2 - p1);
+		segmentAABB.lowerBound = b2Min(p1, t);
+		segmentAABB.upperBound = b2Max(p1, t);
+	}
+
+	b2GrowableStack<int32, 256> stack;
+	stack.Push(m_root << 1);
+
+	while (stack.GetCount() > 0)
+	{
+		int32 entry = stack.Pop();
+		int32 index = entry >> 1;
+		bool isLeaf = (entry & 1) != 0;
+
+		// The children were tested when they were pushed, but the segment
+		// may have been clipped since. Testing again when they are popped
+		// prunes exactly the nodes that the binary tree prunes.
+		const b2AABB& aabb = isLeaf ? m_tree->GetFatAABB(index) : m_nodes[index].aabb;
+		if (b2TestOverlap(aabb, segmentAABB) == false)
+		{
+			continue;
+		}
+
+		// Separating axis for segment (Gino, p80).
+		// |dot(v, p1 - c)| > dot(|v|, h)
+		b2Vec2 c = aabb.GetCenter();
+		b2Vec2 h = aabb.GetExtents();
+		float32 separation = b2Abs(b2Dot(v, p1 - c)) - b2Dot(abs_v, h);
+		if (separation > 0.0f)
+		{
+			continue;
+		}
+
+		if (isLeaf)
+		{
+			b2RayCastInput subInput;
+			subInput.p1 = input.p1;
+			subInput.p2 = input.p2;
+			subInput.maxFraction = maxFraction;
+
+			float32 value = callback->RayCastCallback(subInput, index);
+
+			if (value == 0.0f)
+			{
+				// The client has terminated the ray cast.
+				return;
+			}
+
+			if (value > 0.0f)
+			{
+				// Update segment bounding box.
+				maxFraction = value;
+				b2Vec2 t = p1 + maxFraction * (p2 - p1);
+				segmentAABB.lowerBound = b2Min(p1, t);
+				segmentAABB.upperBound = b2Max(p1, t);
+			}
+		}
+		else
+		{
+			const b2WideNode* node = m_nodes + index;
+			int32 mask = GetOverlapMask(node, segmentAABB);
+			for (int32 i = 0; i < 4; ++i)
+			{
+				if (mask & (1 << i))
+				{
+					stack.Push(GetEntry(node, i));
+				}
+			}
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,135 @@
+/*
+* Copyright (c) 2006-2010 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#include <Box2D/Common/b2ArenaAllocator.h>
+#include <Box2D/Common/b2Math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Chunks and blocks start with a header of this size, which keeps the
+// memory handed out as aligned as malloc's.
+#define b2_arenaHeaderSize 16
+
+// The smallest block is 1 << b2_arenaMinSizeClass bytes, header included.
+#define b2_arenaMinSizeClass 5
+
+struct b2ArenaChunk
+{
+	b2ArenaChunk* next;
+};
+
+b2ArenaAllocator::b2ArenaAllocator()
+{
+	m_chunks = NULL;
+	m_top = NULL;
+	m_end = NULL;
+	memset(m_freeLists, 0, sizeof(m_freeLists));
+	m_reservedSize = 0;
+	m_allocation = 0;
+	m_maxAllocation = 0;
+}
+
+b2ArenaAllocator::~b2ArenaAllocator()
+{
+	Reset();
+}
+
+void* b2ArenaAllocator::AllocateChunk(int32 size)
+{
+	b2ArenaChunk* chunk = (b2ArenaChunk*)malloc(b2_arenaHeaderSize + size);
+	b2Assert(chunk != NULL);
+	chunk->next = m_chunks;
+	m_chunks = chunk;
+	m_reservedSize += b2_arenaHeaderSize + size;
+	return (char*)chunk + b2_arenaHeaderSize;
+}
+
+void* b2ArenaAllocator::Allocate(int32 size)
+{
+	b2Assert(0 <= size);
+
+	int32 sizeClass = b2_arenaMinSizeClass;
+	while ((1 << sizeClass) < size + b2_arenaHeaderSize)
+	{
+		++sizeClass;
+	}
+	b2Assert(sizeClass < b2_arenaSizeClasses);
+	int32 blockSize = 1 << sizeClass;
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	char* block = (char*)m_freeLists[sizeClass];
+	if (block)
+	{
+		m_freeLists[sizeClass] = *(void**)block;
+	}
+	else if (blockSize > b2_arenaChunkSize / 4)
+	{
+		// Large blocks get a chunk of their own.
+		block = (char*)AllocateChunk(blockSize);
+	}
+	else
+	{
+		if (m_top + blockSize > m_end)
+		{
+			m_top = (char*)AllocateChunk(b2_arenaChunkSize);
+			m_end = m_top + b2_arenaChunkSize;
+		}
+		block = m_top;
+		m_top += blockSize;
+	}
+
+	*(int32*)block = sizeClass;
+	m_allocation += blockSize;
+	m_maxAllocation = b2Max(m_maxAllocation, m_allocation);
+
+	return block + b2_arenaHeaderSize;
+}
+
+void b2ArenaAllocator::Free(void* mem)
+{
+	char* block = (char*)mem - b2_arenaHeaderSize;
+	int32 sizeClass = *(int32*)block;
+	b2Assert(b2_arenaMinSizeClass <= sizeClass && sizeClass < b2_arenaSizeClasses);
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	*(void**)block = m_freeLists[sizeClass];
+	m_freeLists[sizeClass] = block;
+	m_allocation -= 1 << sizeClass;
+}
+
+void b2ArenaAllocator::Reset()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	while (m_chunks)
+	{
+		b2ArenaChunk* next = m_chunks->next;
+		free(m_chunks);
+		m_chunks = next;
+	}
+
+	m_top = NULL;
+	m_end = NULL;
+	memset(m_freeLists, 0, sizeof(m_freeLists));
+	m_reservedSize = 0;
+	m_allocation = 0;
+	m_maxAllocation = 0;
+}
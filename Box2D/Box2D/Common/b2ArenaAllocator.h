@@ -0,0 +1,84 @@
+/*
+* Copyright (c) 2006-2010 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#ifndef B2_ARENA_ALLOCATOR_H
+#define B2_ARENA_ALLOCATOR_H
+
+#include <Box2D/Common/b2Settings.h>
+
+#include <mutex>
+
+const int32 b2_arenaChunkSize = 256 * 1024;
+const int32 b2_arenaSizeClasses = 31;
+
+struct b2ArenaChunk;
+
+/// A b2Allocator that takes memory from the system in large chunks and
+/// gives all of it back in one Reset. Blocks are rounded up to powers of
+/// two; freed blocks are kept for later allocations of the same size.
+/// Give every world its own arena through b2SetAllocator to drop the
+/// world without destroying its bodies one by one: delete the world, then
+/// call Reset. Nothing that was allocated before Reset may be used or
+/// freed afterwards.
+class b2ArenaAllocator : public b2Allocator
+{
+public:
+	b2ArenaAllocator();
+	~b2ArenaAllocator();
+
+	void* Allocate(int32 size);
+	void Free(void* mem);
+
+	/// Return all chunks to the system.
+	void Reset();
+
+	/// Get the number of bytes taken from the system.
+	int32 GetReservedSize() const;
+
+	/// Get the largest number of bytes in use at once since the last Reset.
+	int32 GetMaxAllocation() const;
+
+private:
+
+	void* AllocateChunk(int32 size);
+
+	std::mutex m_mutex;
+
+	b2ArenaChunk* m_chunks;
+	char* m_top;
+	char* m_end;
+
+	void* m_freeLists[b2_arenaSizeClasses];
+
+	int32 m_reservedSize;
+	int32 m_allocation;
+	int32 m_maxAllocation;
+};
+
+inline int32 b2ArenaAllocator::GetReservedSize() const
+{
+	return m_reservedSize;
+}
+
+inline int32 b2ArenaAllocator::GetMaxAllocation() const
+{
+	return m_maxAllocation;
+}
+
+#endif
@@ -201,6 +201,15 @@ void b2BlockAllocator::Free(void* p, int32 size)
 	m_freeLists[index] = block;
 }
 
+void b2BlockAllocator::Abandon()
+{
+	m_chunks = NULL;
+	m_chunkCount = 0;
+	m_chunkSpace = 0;
+
+	memset(m_freeLists, 0, sizeof(m_freeLists));
+}
+
 void b2BlockAllocator::Clear()
 {
 	for (int32 i = 0; i < m_chunkCount; ++i)
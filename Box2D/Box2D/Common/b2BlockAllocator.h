@@ -46,6 +46,10 @@ public:
 
 	void Clear();
 
+	/// Forget all chunks without freeing them, for when the memory
+	/// they came from is about to be released as a whole.
+	void Abandon();
+
 private:
 
 	b2Chunk* m_chunks;
@@ -23,17 +23,44 @@
 
 b2Version b2_version = {2, 3, 2};
 
-// Memory allocators. Modify these to use your own allocator.
+static b2Allocator* b2_allocator = NULL;
+
+// Memory allocators. Use b2SetAllocator to plug in your own allocator.
 void* b2Alloc(int32 size)
 {
+	if (b2_allocator)
+	{
+		return b2_allocator->Allocate(size);
+	}
 	return malloc(size);
 }
 
 void b2Free(void* mem)
 {
+	if (mem == NULL)
+	{
+		return;
+	}
+	if (b2_allocator)
+	{
+		b2_allocator->Free(mem);
+		return;
+	}
 	free(mem);
 }
 
+b2Allocator* b2SetAllocator(b2Allocator* allocator)
+{
+	b2Allocator* previous = b2_allocator;
+	b2_allocator = allocator;
+	return previous;
+}
+
+b2Allocator* b2GetAllocator()
+{
+	return b2_allocator;
+}
+
 // You can modify this to use your logging facility.
 void b2Log(const char* string, ...)
 {
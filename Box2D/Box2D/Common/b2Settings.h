@@ -32,9 +32,19 @@ typedef signed int int32;
 typedef unsigned char uint8;
 typedef unsigned short uint16;
 typedef unsigned int uint32;
+typedef unsigned long long uint64;
 typedef float float32;
 typedef double float64;
 
+/// 1 if SSE2 instructions may be used. Define B2_USE_SSE2 as 0 to build the scalar code only.
+#ifndef B2_USE_SSE2
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define B2_USE_SSE2 1
+#else
+#define B2_USE_SSE2 0
+#endif
+#endif
+
 #define	b2_maxFloat		FLT_MAX
 #define	b2_epsilon		FLT_EPSILON
 #define b2_pi			3.14159265359f
@@ -76,6 +86,10 @@ typedef double float64;
 /// Making it larger may create artifacts for vertex collision.
 #define b2_polygonRadius		(2.0f * b2_linearSlop)
 
+/// Speculative contacts of bullets are created up to this distance beyond the
+/// distance a bullet travels in a time step. See b2World::SetSpeculativeBullets.
+#define b2_speculativeDistance	(4.0f * b2_linearSlop)
+
 /// Maximum number of sub-steps per contact in continuous physics simulation.
 #define b2_maxSubSteps			8
 
@@ -113,6 +127,9 @@ typedef double float64;
 #define b2_baumgarte				0.2f
 #define b2_toiBaugarte				0.75f
 
+/// The number of bodies whose per-step state is stored together, see b2BodyStateBlock.
+#define b2_bodyStateBlockSize		256
+
 
 // Sleep
 
@@ -127,12 +144,34 @@ typedef double float64;
 
 // Memory Allocation
 
-/// Implement this function to use your own memory allocator.
+/// Implement this to take over all memory that Box2D allocates, see b2SetAllocator.
+/// Allocate and Free may be called by the threads of a world's thread pool at once.
+class b2Allocator
+{
+public:
+	virtual ~b2Allocator() {}
+
+	/// Allocate at least size bytes, aligned for any type.
+	virtual void* Allocate(int32 size) = 0;
+
+	/// Free memory returned by Allocate. mem is never NULL.
+	virtual void Free(void* mem) = 0;
+};
+
+/// Allocate memory through the allocator set with b2SetAllocator, or with malloc.
 void* b2Alloc(int32 size);
 
-/// If you implement b2Alloc, you should also implement this function.
+/// Free memory allocated with b2Alloc.
 void b2Free(void* mem);
 
+/// Route b2Alloc and b2Free through an allocator, or back to malloc and free
+/// for NULL. Only switch while no memory from b2Alloc is in use.
+/// @return the allocator that was set before
+b2Allocator* b2SetAllocator(b2Allocator* allocator);
+
+/// Get the allocator set with b2SetAllocator, or NULL.
+b2Allocator* b2GetAllocator();
+
 /// Logging function.
 void b2Log(const char* string, ...);
 
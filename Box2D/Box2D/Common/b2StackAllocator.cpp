@@ -21,9 +21,12 @@
 
 b2StackAllocator::b2StackAllocator()
 {
+	m_capacity = b2_stackSize;
+	m_data = (char*)b2Alloc(m_capacity);
 	m_index = 0;
 	m_allocation = 0;
 	m_maxAllocation = 0;
+	m_overflowCount = 0;
 	m_entryCount = 0;
 }
 
@@ -31,6 +34,7 @@ b2StackAllocator::~b2StackAllocator()
 {
 	b2Assert(m_index == 0);
 	b2Assert(m_entryCount == 0);
+	b2Free(m_data);
 }
 
 void* b2StackAllocator::Allocate(int32 size)
@@ -39,10 +43,11 @@ void* b2StackAllocator::Allocate(int32 size)
 
 	b2StackEntry* entry = m_entries + m_entryCount;
 	entry->size = size;
-	if (m_index + size > b2_stackSize)
+	if (m_index + size > m_capacity)
 	{
 		entry->data = (char*)b2Alloc(size);
 		entry->usedMalloc = true;
+		++m_overflowCount;
 	}
 	else
 	{
@@ -75,9 +80,29 @@ void b2StackAllocator::Free(void* p)
 	--m_entryCount;
 
 	p = NULL;
+
+	// Grow while nothing is on the stack. Growing at least twofold
+	// keeps the number of reallocations logarithmic.
+	if (m_entryCount == 0 && m_maxAllocation > m_capacity)
+	{
+		b2Assert(m_index == 0);
+		b2Free(m_data);
+		m_capacity = b2Max(m_maxAllocation, 2 * m_capacity);
+		m_data = (char*)b2Alloc(m_capacity);
+	}
 }
 
 int32 b2StackAllocator::GetMaxAllocation() const
 {
 	return m_maxAllocation;
 }
+
+int32 b2StackAllocator::GetOverflowCount() const
+{
+	return m_overflowCount;
+}
+
+int32 b2StackAllocator::GetCapacity() const
+{
+	return m_capacity;
+}
@@ -21,7 +21,7 @@
 
 #include <Box2D/Common/b2Settings.h>
 
-const int32 b2_stackSize = 100 * 1024;	// 100k
+const int32 b2_stackSize = 100 * 1024;	// 100k initially, see b2StackAllocator
 const int32 b2_maxStackEntries = 32;
 
 struct b2StackEntry
@@ -34,6 +34,9 @@ struct b2StackEntry
 // This is a stack allocator used for fast per step allocations.
 // You must nest allocate/free pairs. The code will assert
 // if you try to interleave multiple allocate/free pairs.
+// Allocations that do not fit on the stack fall back to b2Alloc.
+// Whenever the stack is empty again after that, it grows to hold
+// the largest allocation so far, so the next step fits.
 class b2StackAllocator
 {
 public:
@@ -43,15 +46,24 @@ public:
 	void* Allocate(int32 size);
 	void Free(void* p);
 
+	/// Get the largest number of bytes that were in use at once.
 	int32 GetMaxAllocation() const;
 
+	/// Get the number of allocations that fell back to b2Alloc.
+	int32 GetOverflowCount() const;
+
+	/// Get the current size of the stack in bytes.
+	int32 GetCapacity() const;
+
 private:
 
-	char m_data[b2_stackSize];
+	char* m_data;
+	int32 m_capacity;
 	int32 m_index;
 
 	int32 m_allocation;
 	int32 m_maxAllocation;
+	int32 m_overflowCount;
 
 	b2StackEntry m_entries[b2_maxStackEntries];
 	int32 m_entryCount;
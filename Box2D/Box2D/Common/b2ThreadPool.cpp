@@ -0,0 +1,114 @@
+/*
+* Copyright (c) 2006-2010 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#include <Box2D/Common/b2ThreadPool.h>
+#include <Box2D/Common/b2Math.h>
+
+b2ThreadPool::b2ThreadPool(int32 threadCount)
+{
+	m_threadCount = b2Max(threadCount, 1);
+	m_allocators = new b2StackAllocator[m_threadCount];
+	m_task = NULL;
+	m_generation = 0;
+	m_pendingCount = 0;
+	m_quit = false;
+
+	m_threads.reserve(m_threadCount - 1);
+	for (int32 i = 1; i < m_threadCount; ++i)
+	{
+		m_threads.push_back(std::thread(&b2ThreadPool::WorkerMain, this, i));
+	}
+}
+
+b2ThreadPool::~b2ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_quit = true;
+	}
+	m_taskReady.notify_all();
+
+	for (size_t i = 0; i < m_threads.size(); ++i)
+	{
+		m_threads[i].join();
+	}
+
+	delete [] m_allocators;
+}
+
+void b2ThreadPool::Run(b2ThreadTask* task)
+{
+	if (m_threadCount == 1)
+	{
+		task->Execute(0);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_task = task;
+		m_pendingCount = m_threadCount - 1;
+		++m_generation;
+	}
+	m_taskReady.notify_all();
+
+	task->Execute(0);
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (m_pendingCount > 0)
+	{
+		m_taskDone.wait(lock);
+	}
+	m_task = NULL;
+}
+
+void b2ThreadPool::WorkerMain(int32 threadIndex)
+{
+	uint32 generation = 0;
+	for (;;)
+	{
+		b2ThreadTask* task;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			while (m_quit == false && m_generation == generation)
+			{
+				m_taskReady.wait(lock);
+			}
+
+			if (m_quit)
+			{
+				return;
+			}
+
+			generation = m_generation;
+			task = m_task;
+		}
+
+		task->Execute(threadIndex);
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			--m_pendingCount;
+			if (m_pendingCount == 0)
+			{
+				m_taskDone.notify_one();
+			}
+		}
+	}
+}
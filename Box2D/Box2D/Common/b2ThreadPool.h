@@ -0,0 +1,94 @@
+/*
+* Copyright (c) 2006-2010 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#ifndef B2_THREAD_POOL_H
+#define B2_THREAD_POOL_H
+
+#include <Box2D/Common/b2Settings.h>
+#include <Box2D/Common/b2StackAllocator.h>
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+
+/// A piece of work that is run on all threads of a b2ThreadPool at once.
+/// Implementations usually hand out work items through an atomic counter.
+class b2ThreadTask
+{
+public:
+	virtual ~b2ThreadTask() {}
+
+	/// Called once on every thread of the pool.
+	/// @param threadIndex 0 for the thread that called b2ThreadPool::Run,
+	/// 1 ... GetThreadCount() - 1 for the worker threads.
+	virtual void Execute(int32 threadIndex) = 0;
+};
+
+/// A fixed set of worker threads that wait for tasks of the world.
+/// Every thread, including the one calling Run, owns a stack allocator
+/// for the temporary memory it needs while executing a task.
+class b2ThreadPool
+{
+public:
+	/// Start threadCount - 1 worker threads. The thread calling Run
+	/// counts as the first thread.
+	b2ThreadPool(int32 threadCount);
+
+	/// Stop and join the worker threads.
+	~b2ThreadPool();
+
+	/// Get the number of threads, including the calling thread.
+	int32 GetThreadCount() const;
+
+	/// Get the stack allocator of a thread.
+	b2StackAllocator* GetStackAllocator(int32 threadIndex);
+
+	/// Execute the task on all threads and return when every thread is done.
+	void Run(b2ThreadTask* task);
+
+private:
+
+	void WorkerMain(int32 threadIndex);
+
+	int32 m_threadCount;
+	b2StackAllocator* m_allocators;
+	std::vector<std::thread> m_threads;
+
+	std::mutex m_mutex;
+	std::condition_variable m_taskReady;
+	std::condition_variable m_taskDone;
+	b2ThreadTask* m_task;
+	uint32 m_generation;
+	int32 m_pendingCount;
+	bool m_quit;
+};
+
+inline int32 b2ThreadPool::GetThreadCount() const
+{
+	return m_threadCount;
+}
+
+inline b2StackAllocator* b2ThreadPool::GetStackAllocator(int32 threadIndex)
+{
+	b2Assert(0 <= threadIndex && threadIndex < m_threadCount);
+	return m_allocators + threadIndex;
+}
+
+#endif
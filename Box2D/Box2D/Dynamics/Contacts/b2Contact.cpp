@@ -24,10 +24,16 @@
 #include <Box2D/Dynamics/Contacts/b2EdgeAndPolygonContact.h>
 #include <Box2D/Dynamics/Contacts/b2ChainAndCircleContact.h>
 #include <Box2D/Dynamics/Contacts/b2ChainAndPolygonContact.h>
+#include <Box2D/Dynamics/Contacts/b2CapsuleContact.h>
+#include <Box2D/Dynamics/Contacts/b2CapsuleAndCircleContact.h>
+#include <Box2D/Dynamics/Contacts/b2CapsuleAndPolygonContact.h>
+#include <Box2D/Dynamics/Contacts/b2EdgeAndCapsuleContact.h>
+#include <Box2D/Dynamics/Contacts/b2ChainAndCapsuleContact.h>
 #include <Box2D/Dynamics/Contacts/b2ContactSolver.h>
 
 #include <Box2D/Collision/b2Collision.h>
 #include <Box2D/Collision/b2TimeOfImpact.h>
+#include <Box2D/Collision/b2Distance.h>
 #include <Box2D/Collision/Shapes/b2Shape.h>
 #include <Box2D/Common/b2BlockAllocator.h>
 #include <Box2D/Dynamics/b2Body.h>
@@ -46,6 +52,11 @@ void b2Contact::InitializeRegisters()
 	AddType(b2EdgeAndPolygonContact::Create, b2EdgeAndPolygonContact::Destroy, b2Shape::e_edge, b2Shape::e_polygon);
 	AddType(b2ChainAndCircleContact::Create, b2ChainAndCircleContact::Destroy, b2Shape::e_chain, b2Shape::e_circle);
 	AddType(b2ChainAndPolygonContact::Create, b2ChainAndPolygonContact::Destroy, b2Shape::e_chain, b2Shape::e_polygon);
+	AddType(b2CapsuleContact::Create, b2CapsuleContact::Destroy, b2Shape::e_capsule, b2Shape::e_capsule);
+	AddType(b2CapsuleAndCircleContact::Create, b2CapsuleAndCircleContact::Destroy, b2Shape::e_capsule, b2Shape::e_circle);
+	AddType(b2CapsuleAndPolygonContact::Create, b2CapsuleAndPolygonContact::Destroy, b2Shape::e_capsule, b2Shape::e_polygon);
+	AddType(b2EdgeAndCapsuleContact::Create, b2EdgeAndCapsuleContact::Destroy, b2Shape::e_edge, b2Shape::e_capsule);
+	AddType(b2ChainAndCapsuleContact::Create, b2ChainAndCapsuleContact::Destroy, b2Shape::e_chain, b2Shape::e_capsule);
 }
 
 void b2Contact::AddType(b2ContactCreateFcn* createFcn, b2ContactDestroyFcn* destoryFcn,
@@ -158,15 +169,18 @@ b2Contact::b2Contact(b2Fixture* fA, int32 indexA, b2Fixture* fB, int32 indexB)
 
 // Update the contact manifold and touching status.
 // Note: do not assume the fixture AABBs are overlapping or are valid.
-void b2Contact::Update(b2ContactListener* listener)
+void b2Contact::Update(b2ContactListener* listener, float32 speculativeTime)
 {
-	b2Manifold oldManifold = m_manifold;
+	b2Manifold oldManifold;
+	bool touching = UpdateManifold(&oldManifold, speculativeTime);
+	UpdateState(touching, &oldManifold, listener);
+}
 
-	// Re-enable this contact.
-	m_flags |= e_enabledFlag;
+bool b2Contact::UpdateManifold(b2Manifold* oldManifold, float32 speculativeTime)
+{
+	*oldManifold = m_manifold;
 
 	bool touching = false;
-	bool wasTouching = (m_flags & e_touchingFlag) == e_touchingFlag;
 
 	bool sensorA = m_fixtureA->IsSensor();
 	bool sensorB = m_fixtureB->IsSensor();
@@ -177,6 +191,12 @@ void b2Contact::Update(b2ContactListener* listener)
 	const b2Transform& xfA = bodyA->GetTransform();
 	const b2Transform& xfB = bodyB->GetTransform();
 
+	m_flags &= ~(e_speculativeFlag | e_speculativePointFlag);
+	if (speculativeTime > 0.0f && sensor == false && (bodyA->IsBullet() || bodyB->IsBullet()))
+	{
+		m_flags |= e_speculativeFlag;
+	}
+
 	// Is this contact a sensor?
 	if (sensor)
 	{
@@ -190,6 +210,10 @@ void b2Contact::Update(b2ContactListener* listener)
 	else
 	{
 		Evaluate(&m_manifold, xfA, xfB);
+		if (m_manifold.pointCount == 0 && (m_flags & e_speculativeFlag))
+		{
+			EvaluateSpeculative(&m_manifold, xfA, xfB, speculativeTime);
+		}
 		touching = m_manifold.pointCount > 0;
 
 		// Match old contact ids to new contact ids and copy the
@@ -201,9 +225,9 @@ void b2Contact::Update(b2ContactListener* listener)
 			mp2->tangentImpulse = 0.0f;
 			b2ContactID id2 = mp2->id;
 
-			for (int32 j = 0; j < oldManifold.pointCount; ++j)
+			for (int32 j = 0; j < oldManifold->pointCount; ++j)
 			{
-				b2ManifoldPoint* mp1 = oldManifold.points + j;
+				const b2ManifoldPoint* mp1 = oldManifold->points + j;
 
 				if (mp1->id.key == id2.key)
 				{
@@ -213,12 +237,78 @@ void b2Contact::Update(b2ContactListener* listener)
 				}
 			}
 		}
+	}
 
-		if (touching != wasTouching)
-		{
-			bodyA->SetAwake(true);
-			bodyB->SetAwake(true);
-		}
+	return touching;
+}
+
+// Give a bullet contact a single point at the closest features of the
+// shapes if they can meet within the given time. The solver lets the bodies
+// approach by the separation of the point, so the bullet stops at the
+// surface instead of passing through it. See b2World::SetSpeculativeBullets.
+void b2Contact::EvaluateSpeculative(b2Manifold* manifold, const b2Transform& xfA, const b2Transform& xfB, float32 speculativeTime)
+{
+	const b2Shape* shapeA = m_fixtureA->GetShape();
+	const b2Shape* shapeB = m_fixtureB->GetShape();
+
+	b2DistanceInput input;
+	input.proxyA.Set(shapeA, m_indexA);
+	input.proxyB.Set(shapeB, m_indexB);
+	input.transformA = xfA;
+	input.transformB = xfB;
+	input.useRadii = false;
+
+	b2SimplexCache cache;
+	cache.count = 0;
+
+	b2DistanceOutput output;
+	b2Distance(&output, &cache, &input);
+
+	// The cores overlap, there is no meaningful normal.
+	if (output.distance < 10.0f * b2_epsilon)
+	{
+		return;
+	}
+
+	float32 separation = output.distance - input.proxyA.m_radius - input.proxyB.m_radius;
+
+	// Use the full relative speed, the bodies may be deflected in the step.
+	b2Vec2 vA = m_fixtureA->GetBody()->GetLinearVelocityFromWorldPoint(output.pointA);
+	b2Vec2 vB = m_fixtureB->GetBody()->GetLinearVelocityFromWorldPoint(output.pointB);
+	float32 speed = (vB - vA).Length();
+
+	if (separation > b2_speculativeDistance + speculativeTime * speed)
+	{
+		return;
+	}
+
+	manifold->type = b2Manifold::e_circles;
+	manifold->localNormal.SetZero();
+	manifold->localPoint = b2MulT(xfA, output.pointA);
+	manifold->points[0].localPoint = b2MulT(xfB, output.pointB);
+	manifold->points[0].id.key = 0;
+	manifold->pointCount = 1;
+
+	m_flags |= e_speculativePointFlag;
+}
+
+void b2Contact::UpdateState(bool touching, const b2Manifold* oldManifold, b2ContactListener* listener)
+{
+	// Re-enable this contact.
+	m_flags |= e_enabledFlag;
+
+	bool wasTouching = (m_flags & e_touchingFlag) == e_touchingFlag;
+	bool sensor = m_fixtureA->IsSensor() || m_fixtureB->IsSensor();
+
+	// A speculative point is solved like a touching one, but the
+	// listener only hears about the contact once the shapes touch.
+	bool wasReported = (m_flags & e_beginReportedFlag) == e_beginReportedFlag;
+	bool reported = touching && (m_flags & e_speculativePointFlag) == 0;
+
+	if (sensor == false && touching != wasTouching)
+	{
+		m_fixtureA->GetBody()->SetAwake(true);
+		m_fixtureB->GetBody()->SetAwake(true);
 	}
 
 	if (touching)
@@ -230,18 +320,27 @@ void b2Contact::Update(b2ContactListener* listener)
 		m_flags &= ~e_touchingFlag;
 	}
 
-	if (wasTouching == false && touching == true && listener)
+	if (reported)
+	{
+		m_flags |= e_beginReportedFlag;
+	}
+	else
+	{
+		m_flags &= ~e_beginReportedFlag;
+	}
+
+	if (wasReported == false && reported == true && listener)
 	{
 		listener->BeginContact(this);
 	}
 
-	if (wasTouching == true && touching == false && listener)
+	if (wasReported == true && reported == false && listener)
 	{
 		listener->EndContact(this);
 	}
 
-	if (sensor == false && touching && listener)
+	if (sensor == false && reported && listener)
 	{
-		listener->PreSolve(this, &oldManifold);
+		listener->PreSolve(this, oldManifold);
 	}
 }
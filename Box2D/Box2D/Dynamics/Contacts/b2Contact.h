@@ -86,7 +86,10 @@ public:
 	/// Get the world manifold.
 	void GetWorldManifold(b2WorldManifold* worldManifold) const;
 
-	/// Is this contact touching?
+	/// Is this contact touching? This is also true for a bullet contact whose
+	/// manifold only holds a speculative point, so that the contact is solved.
+	/// Such a contact is not reported to BeginContact, EndContact and PreSolve
+	/// before the shapes really touch. See b2World::SetSpeculativeBullets.
 	bool IsTouching() const;
 
 	/// Enable/disable this contact. This can be used inside the pre-solve
@@ -150,6 +153,8 @@ protected:
 	friend class b2ContactSolver;
 	friend class b2Body;
 	friend class b2Fixture;
+	friend class b2CollideTask;
+	friend class b2Island;
 
 	// Flags stored in m_flags
 	enum
@@ -170,7 +175,16 @@ protected:
 		e_bulletHitFlag		= 0x0010,
 
 		// This contact has a valid TOI in m_toi
-		e_toiFlag			= 0x0020
+		e_toiFlag			= 0x0020,
+
+		// This bullet contact is kept up to date speculatively
+		e_speculativeFlag	= 0x0040,
+
+		// The manifold holds a speculative point, the shapes are apart
+		e_speculativePointFlag	= 0x0080,
+
+		// BeginContact was reported and EndContact is still due
+		e_beginReportedFlag	= 0x0100
 	};
 
 	/// Flag this contact for filtering. Filtering will occur the next time step.
@@ -187,7 +201,16 @@ protected:
 	b2Contact(b2Fixture* fixtureA, int32 indexA, b2Fixture* fixtureB, int32 indexB);
 	virtual ~b2Contact() {}
 
-	void Update(b2ContactListener* listener);
+	void Update(b2ContactListener* listener, float32 speculativeTime);
+
+	// The two halves of Update. UpdateManifold only writes this contact, so
+	// different contacts can be updated concurrently. UpdateState wakes the
+	// bodies and calls the listener.
+	// Bullet contacts get a speculative point if the shapes are apart but may
+	// meet within speculativeTime. Pass zero to disable speculative points.
+	bool UpdateManifold(b2Manifold* oldManifold, float32 speculativeTime);
+	void EvaluateSpeculative(b2Manifold* manifold, const b2Transform& xfA, const b2Transform& xfB, float32 speculativeTime);
+	void UpdateState(bool touching, const b2Manifold* oldManifold, b2ContactListener* listener);
 
 	static b2ContactRegister s_registers[b2Shape::e_typeCount][b2Shape::e_typeCount];
 	static bool s_initialized;
@@ -23,9 +23,26 @@
 #include <Box2D/Dynamics/b2Fixture.h>
 #include <Box2D/Dynamics/b2World.h>
 #include <Box2D/Common/b2StackAllocator.h>
+#include <Box2D/Common/b2ThreadPool.h>
+
+#include <atomic>
+#include <string.h>
 
 #define B2_DEBUG_SOLVER 0
 
+// Solve the velocity constraints of a graph color four at a time with SSE2.
+// Define B2_SIMD_SOLVER as 0 to compare against the scalar solver.
+#ifndef B2_SIMD_SOLVER
+#define B2_SIMD_SOLVER B2_USE_SSE2
+#endif
+
+#if B2_SIMD_SOLVER
+#include <emmintrin.h>
+#endif
+
+// The number of contacts of a color that one thread solves at once.
+#define b2_colorBlockSize 32
+
 bool g_blockSolve = true;
 
 struct b2ContactPositionConstraint
@@ -53,6 +70,7 @@ b2ContactSolver::b2ContactSolver(b2ContactSolverDef* def)
 	m_positions = def->positions;
 	m_velocities = def->velocities;
 	m_contacts = def->contacts;
+	m_speculativeCount = 0;
 
 	// Initialize position independent portions of the constraints.
 	for (int32 i = 0; i < m_count; ++i)
@@ -72,12 +90,15 @@ b2ContactSolver::b2ContactSolver(b2ContactSolverDef* def)
 		int32 pointCount = manifold->pointCount;
 		b2Assert(pointCount > 0);
 
+		int32 indexA = def->indices != NULL ? def->indices[2 * i + 0] : bodyA->m_islandIndex;
+		int32 indexB = def->indices != NULL ? def->indices[2 * i + 1] : bodyB->m_islandIndex;
+
 		b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
 		vc->friction = contact->m_friction;
 		vc->restitution = contact->m_restitution;
 		vc->tangentSpeed = contact->m_tangentSpeed;
-		vc->indexA = bodyA->m_islandIndex;
-		vc->indexB = bodyB->m_islandIndex;
+		vc->indexA = indexA;
+		vc->indexB = indexB;
 		vc->invMassA = bodyA->m_invMass;
 		vc->invMassB = bodyB->m_invMass;
 		vc->invIA = bodyA->m_invI;
@@ -86,14 +107,19 @@ b2ContactSolver::b2ContactSolver(b2ContactSolverDef* def)
 		vc->pointCount = pointCount;
 		vc->K.SetZero();
 		vc->normalMass.SetZero();
+		vc->speculative = (contact->m_flags & b2Contact::e_speculativePointFlag) != 0;
+		if (vc->speculative)
+		{
+			++m_speculativeCount;
+		}
 
 		b2ContactPositionConstraint* pc = m_positionConstraints + i;
-		pc->indexA = bodyA->m_islandIndex;
-		pc->indexB = bodyB->m_islandIndex;
+		pc->indexA = indexA;
+		pc->indexB = indexB;
 		pc->invMassA = bodyA->m_invMass;
 		pc->invMassB = bodyB->m_invMass;
-		pc->localCenterA = bodyA->m_sweep.localCenter;
-		pc->localCenterB = bodyB->m_sweep.localCenter;
+		pc->localCenterA = bodyA->Sweep().localCenter;
+		pc->localCenterB = bodyB->Sweep().localCenter;
 		pc->invIA = bodyA->m_invI;
 		pc->invIB = bodyB->m_invI;
 		pc->localNormal = manifold->localNormal;
@@ -124,14 +150,129 @@ b2ContactSolver::b2ContactSolver(b2ContactSolverDef* def)
 			vcp->normalMass = 0.0f;
 			vcp->tangentMass = 0.0f;
 			vcp->velocityBias = 0.0f;
+			vcp->relativeVelocity = 0.0f;
 
 			pc->localPoints[j] = cp->localPoint;
 		}
+
+		// The wide solver gathers both points of every constraint and masks
+		// the second one out afterwards, so unused points must hold zeros
+		// rather than whatever the stack allocator left behind.
+		for (int32 j = pointCount; j < b2_maxManifoldPoints; ++j)
+		{
+			b2VelocityConstraintPoint* vcp = vc->points + j;
+			vcp->rA.SetZero();
+			vcp->rB.SetZero();
+			vcp->normalImpulse = 0.0f;
+			vcp->tangentImpulse = 0.0f;
+			vcp->normalMass = 0.0f;
+			vcp->tangentMass = 0.0f;
+			vcp->velocityBias = 0.0f;
+			vcp->relativeVelocity = 0.0f;
+			pc->localPoints[j].SetZero();
+		}
+	}
+
+	m_threadPool = def->threadPool;
+	m_colorOrder = NULL;
+	m_colorCount = 0;
+
+	if (def->useColors == false || m_count == 0)
+	{
+		return;
+	}
+
+	// Greedily assign each contact the lowest color that is not yet used by
+	// one of its bodies. Bodies without mass are never written by the solver,
+	// so they may be shared within a color.
+	int32 bodyCount = 0;
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
+		bodyCount = b2Max(bodyCount, b2Max(vc->indexA, vc->indexB) + 1);
 	}
+
+	m_colorOrder = (int32*)m_allocator->Allocate(m_count * sizeof(int32));
+	uint64* bodyColors = (uint64*)m_allocator->Allocate(bodyCount * sizeof(uint64));
+	int32* contactColors = (int32*)m_allocator->Allocate(m_count * sizeof(int32));
+	memset(bodyColors, 0, bodyCount * sizeof(uint64));
+
+	int32 colorCounts[b2_maxGraphColors + 1];
+	memset(colorCounts, 0, sizeof(colorCounts));
+
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
+		bool massA = vc->invMassA > 0.0f || vc->invIA > 0.0f;
+		bool massB = vc->invMassB > 0.0f || vc->invIB > 0.0f;
+
+		uint64 used = 0;
+		if (massA)
+		{
+			used |= bodyColors[vc->indexA];
+		}
+		if (massB)
+		{
+			used |= bodyColors[vc->indexB];
+		}
+
+		// Contacts that find no free color go to the extra color.
+		int32 color = 0;
+		while (color < b2_maxGraphColors && (used & ((uint64)1 << color)) != 0)
+		{
+			++color;
+		}
+
+		if (color < b2_maxGraphColors)
+		{
+			uint64 bit = (uint64)1 << color;
+			if (massA)
+			{
+				bodyColors[vc->indexA] |= bit;
+			}
+			if (massB)
+			{
+				bodyColors[vc->indexB] |= bit;
+			}
+		}
+
+		contactColors[i] = color;
+		++colorCounts[color];
+	}
+
+	// A contact only gets a color if all lower colors are in use by its
+	// bodies, so the used colors are contiguous.
+	for (int32 c = 0; c <= b2_maxGraphColors; ++c)
+	{
+		if (colorCounts[c] > 0)
+		{
+			m_colorCount = c + 1;
+		}
+	}
+
+	m_colorStarts[0] = 0;
+	for (int32 c = 0; c < m_colorCount; ++c)
+	{
+		m_colorStarts[c + 1] = m_colorStarts[c] + colorCounts[c];
+		colorCounts[c] = m_colorStarts[c];
+	}
+
+	// Sort the contacts by color, keeping their order within a color.
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		m_colorOrder[colorCounts[contactColors[i]]++] = i;
+	}
+
+	m_allocator->Free(contactColors);
+	m_allocator->Free(bodyColors);
 }
 
 b2ContactSolver::~b2ContactSolver()
 {
+	if (m_colorOrder != NULL)
+	{
+		m_allocator->Free(m_colorOrder);
+	}
 	m_allocator->Free(m_velocityConstraints);
 	m_allocator->Free(m_positionConstraints);
 }
@@ -208,7 +349,18 @@ void b2ContactSolver::InitializeVelocityConstraints()
 			// Setup a velocity bias for restitution.
 			vcp->velocityBias = 0.0f;
 			float32 vRel = b2Dot(vc->normal, vB + b2Cross(wB, vcp->rB) - vA - b2Cross(wA, vcp->rA));
-			if (vRel < -b2_velocityThreshold)
+			if (vc->speculative)
+			{
+				// Allow the bodies to close the gap within this step, but no more.
+				// Restitution is applied afterwards, see ApplyRestitution.
+				float32 separation = worldManifold.separations[j];
+				if (separation > 0.0f)
+				{
+					vcp->velocityBias = -separation * m_step.inv_dt;
+				}
+				vcp->relativeVelocity = vRel;
+			}
+			else if (vRel < -b2_velocityThreshold)
 			{
 				vcp->velocityBias = -vc->restitution * vRel;
 			}
@@ -243,6 +395,8 @@ void b2ContactSolver::InitializeVelocityConstraints()
 				// The constraints are redundant, just use one.
 				// TODO_ERIN use deepest?
 				vc->pointCount = 1;
+				vc->K.SetZero();
+				vc->normalMass.SetZero();
 			}
 		}
 	}
@@ -292,306 +446,381 @@ void b2ContactSolver::SolveVelocityConstraints()
 {
 	for (int32 i = 0; i < m_count; ++i)
 	{
-		b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
+		SolveVelocityConstraint(m_velocityConstraints + i);
+	}
+}
 
-		int32 indexA = vc->indexA;
-		int32 indexB = vc->indexB;
-		float32 mA = vc->invMassA;
-		float32 iA = vc->invIA;
-		float32 mB = vc->invMassB;
-		float32 iB = vc->invIB;
-		int32 pointCount = vc->pointCount;
+// Bodies without mass are not written back, so contacts that only share such
+// bodies may be solved concurrently.
+void b2ContactSolver::SolveVelocityConstraint(b2ContactVelocityConstraint* vc)
+{
+	int32 indexA = vc->indexA;
+	int32 indexB = vc->indexB;
+	float32 mA = vc->invMassA;
+	float32 iA = vc->invIA;
+	float32 mB = vc->invMassB;
+	float32 iB = vc->invIB;
+	int32 pointCount = vc->pointCount;
+
+	b2Vec2 vA = m_velocities[indexA].v;
+	float32 wA = m_velocities[indexA].w;
+	b2Vec2 vB = m_velocities[indexB].v;
+	float32 wB = m_velocities[indexB].w;
+
+	b2Vec2 normal = vc->normal;
+	b2Vec2 tangent = b2Cross(normal, 1.0f);
+	float32 friction = vc->friction;
+
+	b2Assert(pointCount == 1 || pointCount == 2);
+
+	// Solve tangent constraints first because non-penetration is more important
+	// than friction.
+	for (int32 j = 0; j < pointCount; ++j)
+	{
+		b2VelocityConstraintPoint* vcp = vc->points + j;
 
-		b2Vec2 vA = m_velocities[indexA].v;
-		float32 wA = m_velocities[indexA].w;
-		b2Vec2 vB = m_velocities[indexB].v;
-		float32 wB = m_velocities[indexB].w;
+		// Relative velocity at contact
+		b2Vec2 dv = vB + b2Cross(wB, vcp->rB) - vA - b2Cross(wA, vcp->rA);
 
-		b2Vec2 normal = vc->normal;
-		b2Vec2 tangent = b2Cross(normal, 1.0f);
-		float32 friction = vc->friction;
+		// Compute tangent force
+		float32 vt = b2Dot(dv, tangent) - vc->tangentSpeed;
+		float32 lambda = vcp->tangentMass * (-vt);
 
-		b2Assert(pointCount == 1 || pointCount == 2);
+		// b2Clamp the accumulated force
+		float32 maxFriction = friction * vcp->normalImpulse;
+		float32 newImpulse = b2Clamp(vcp->tangentImpulse + lambda, -maxFriction, maxFriction);
+		lambda = newImpulse - vcp->tangentImpulse;
+		vcp->tangentImpulse = newImpulse;
 
-		// Solve tangent constraints first because non-penetration is more important
-		// than friction.
-		for (int32 j = 0; j < pointCount; ++j)
+		// Apply contact impulse
+		b2Vec2 P = lambda * tangent;
+
+		vA -= mA * P;
+		wA -= iA * b2Cross(vcp->rA, P);
+
+		vB += mB * P;
+		wB += iB * b2Cross(vcp->rB, P);
+	}
+
+	// Solve normal constraints
+	if (pointCount == 1 || g_blockSolve == false)
+	{
+		for (int32 i = 0; i < pointCount; ++i)
 		{
-			b2VelocityConstraintPoint* vcp = vc->points + j;
+			b2VelocityConstraintPoint* vcp = vc->points + i;
 
 			// Relative velocity at contact
 			b2Vec2 dv = vB + b2Cross(wB, vcp->rB) - vA - b2Cross(wA, vcp->rA);
 
-			// Compute tangent force
-			float32 vt = b2Dot(dv, tangent) - vc->tangentSpeed;
-			float32 lambda = vcp->tangentMass * (-vt);
+			// Compute normal impulse
+			float32 vn = b2Dot(dv, normal);
+			float32 lambda = -vcp->normalMass * (vn - vcp->velocityBias);
 
-			// b2Clamp the accumulated force
-			float32 maxFriction = friction * vcp->normalImpulse;
-			float32 newImpulse = b2Clamp(vcp->tangentImpulse + lambda, -maxFriction, maxFriction);
-			lambda = newImpulse - vcp->tangentImpulse;
-			vcp->tangentImpulse = newImpulse;
+			// b2Clamp the accumulated impulse
+			float32 newImpulse = b2Max(vcp->normalImpulse + lambda, 0.0f);
+			lambda = newImpulse - vcp->normalImpulse;
+			vcp->normalImpulse = newImpulse;
 
 			// Apply contact impulse
-			b2Vec2 P = lambda * tangent;
-
+			b2Vec2 P = lambda * normal;
 			vA -= mA * P;
 			wA -= iA * b2Cross(vcp->rA, P);
 
 			vB += mB * P;
 			wB += iB * b2Cross(vcp->rB, P);
 		}
-
-		// Solve normal constraints
-		if (pointCount == 1 || g_blockSolve == false)
-		{
-			for (int32 i = 0; i < pointCount; ++i)
-			{
-				b2VelocityConstraintPoint* vcp = vc->points + i;
-
-				// Relative velocity at contact
-				b2Vec2 dv = vB + b2Cross(wB, vcp->rB) - vA - b2Cross(wA, vcp->rA);
-
-				// Compute normal impulse
-				float32 vn = b2Dot(dv, normal);
-				float32 lambda = -vcp->normalMass * (vn - vcp->velocityBias);
-
-				// b2Clamp the accumulated impulse
-				float32 newImpulse = b2Max(vcp->normalImpulse + lambda, 0.0f);
-				lambda = newImpulse - vcp->normalImpulse;
-				vcp->normalImpulse = newImpulse;
-
-				// Apply contact impulse
-				b2Vec2 P = lambda * normal;
-				vA -= mA * P;
-				wA -= iA * b2Cross(vcp->rA, P);
-
-				vB += mB * P;
-				wB += iB * b2Cross(vcp->rB, P);
-			}
-		}
-		else
+	}
+	else
+	{
+		// Block solver developed in collaboration with Dirk Gregorius (back in 01/07 on Box2D_Lite).
+		// Build the mini LCP for this contact patch
+		//
+		// vn = A * x + b, vn >= 0, , vn >= 0, x >= 0 and vn_i * x_i = 0 with i = 1..2
+		//
+		// A = J * W * JT and J = ( -n, -r1 x n, n, r2 x n )
+		// b = vn0 - velocityBias
+		//
+		// The system is solved using the "Total enumeration method" (s. Murty). The complementary constraint vn_i * x_i
+		// implies that we must have in any solution either vn_i = 0 or x_i = 0. So for the 2D contact problem the cases
+		// vn1 = 0 and vn2 = 0, x1 = 0 and x2 = 0, x1 = 0 and vn2 = 0, x2 = 0 and vn1 = 0 need to be tested. The first valid
+		// solution that satisfies the problem is chosen.
+		// 
+		// In order to account of the accumulated impulse 'a' (because of the iterative nature of the solver which only requires
+		// that the accumulated impulse is clamped and not the incremental impulse) we change the impulse variable (x_i).
+		//
+		// Substitute:
+		// 
+		// x = a + d
+		// 
+		// a := old total impulse
+		// x := new total impulse
+		// d := incremental impulse 
+		//
+		// For the current iteration we extend the formula for the incremental impulse
+		// to compute the new total impulse:
+		//
+		// vn = A * d + b
+		//    = A * (x - a) + b
+		//    = A * x + b - A * a
+		//    = A * x + b'
+		// b' = b - A * a;
+
+		b2VelocityConstraintPoint* cp1 = vc->points + 0;
+		b2VelocityConstraintPoint* cp2 = vc->points + 1;
+
+		b2Vec2 a(cp1->normalImpulse, cp2->normalImpulse);
+		b2Assert(a.x >= 0.0f && a.y >= 0.0f);
+
+		// Relative velocity at contact
+		b2Vec2 dv1 = vB + b2Cross(wB, cp1->rB) - vA - b2Cross(wA, cp1->rA);
+		b2Vec2 dv2 = vB + b2Cross(wB, cp2->rB) - vA - b2Cross(wA, cp2->rA);
+
+		// Compute normal velocity
+		float32 vn1 = b2Dot(dv1, normal);
+		float32 vn2 = b2Dot(dv2, normal);
+
+		b2Vec2 b;
+		b.x = vn1 - cp1->velocityBias;
+		b.y = vn2 - cp2->velocityBias;
+
+		// Compute b'
+		b -= b2Mul(vc->K, a);
+
+		const float32 k_errorTol = 1e-3f;
+		B2_NOT_USED(k_errorTol);
+
+		for (;;)
 		{
-			// Block solver developed in collaboration with Dirk Gregorius (back in 01/07 on Box2D_Lite).
-			// Build the mini LCP for this contact patch
 			//
-			// vn = A * x + b, vn >= 0, , vn >= 0, x >= 0 and vn_i * x_i = 0 with i = 1..2
+			// Case 1: vn = 0
 			//
-			// A = J * W * JT and J = ( -n, -r1 x n, n, r2 x n )
-			// b = vn0 - velocityBias
+			// 0 = A * x + b'
 			//
-			// The system is solved using the "Total enumeration method" (s. Murty). The complementary constraint vn_i * x_i
-			// implies that we must have in any solution either vn_i = 0 or x_i = 0. So for the 2D contact problem the cases
-			// vn1 = 0 and vn2 = 0, x1 = 0 and x2 = 0, x1 = 0 and vn2 = 0, x2 = 0 and vn1 = 0 need to be tested. The first valid
-			// solution that satisfies the problem is chosen.
-			// 
-			// In order to account of the accumulated impulse 'a' (because of the iterative nature of the solver which only requires
-			// that the accumulated impulse is clamped and not the incremental impulse) we change the impulse variable (x_i).
-			//
-			// Substitute:
-			// 
-			// x = a + d
-			// 
-			// a := old total impulse
-			// x := new total impulse
-			// d := incremental impulse 
+			// Solve for x:
 			//
-			// For the current iteration we extend the formula for the incremental impulse
-			// to compute the new total impulse:
+			// x = - inv(A) * b'
 			//
-			// vn = A * d + b
-			//    = A * (x - a) + b
-			//    = A * x + b - A * a
-			//    = A * x + b'
-			// b' = b - A * a;
+			b2Vec2 x = - b2Mul(vc->normalMass, b);
 
-			b2VelocityConstraintPoint* cp1 = vc->points + 0;
-			b2VelocityConstraintPoint* cp2 = vc->points + 1;
+			if (x.x >= 0.0f && x.y >= 0.0f)
+			{
+				// Get the incremental impulse
+				b2Vec2 d = x - a;
 
-			b2Vec2 a(cp1->normalImpulse, cp2->normalImpulse);
-			b2Assert(a.x >= 0.0f && a.y >= 0.0f);
+				// Apply incremental impulse
+				b2Vec2 P1 = d.x * normal;
+				b2Vec2 P2 = d.y * normal;
+				vA -= mA * (P1 + P2);
+				wA -= iA * (b2Cross(cp1->rA, P1) + b2Cross(cp2->rA, P2));
 
-			// Relative velocity at contact
-			b2Vec2 dv1 = vB + b2Cross(wB, cp1->rB) - vA - b2Cross(wA, cp1->rA);
-			b2Vec2 dv2 = vB + b2Cross(wB, cp2->rB) - vA - b2Cross(wA, cp2->rA);
+				vB += mB * (P1 + P2);
+				wB += iB * (b2Cross(cp1->rB, P1) + b2Cross(cp2->rB, P2));
 
-			// Compute normal velocity
-			float32 vn1 = b2Dot(dv1, normal);
-			float32 vn2 = b2Dot(dv2, normal);
+				// Accumulate
+				cp1->normalImpulse = x.x;
+				cp2->normalImpulse = x.y;
 
-			b2Vec2 b;
-			b.x = vn1 - cp1->velocityBias;
-			b.y = vn2 - cp2->velocityBias;
+#if B2_DEBUG_SOLVER == 1
+				// Postconditions
+				dv1 = vB + b2Cross(wB, cp1->rB) - vA - b2Cross(wA, cp1->rA);
+				dv2 = vB + b2Cross(wB, cp2->rB) - vA - b2Cross(wA, cp2->rA);
+
+				// Compute normal velocity
+				vn1 = b2Dot(dv1, normal);
+				vn2 = b2Dot(dv2, normal);
 
-			// Compute b'
-			b -= b2Mul(vc->K, a);
+				b2Assert(b2Abs(vn1 - cp1->velocityBias) < k_errorTol);
+				b2Assert(b2Abs(vn2 - cp2->velocityBias) < k_errorTol);
+#endif
+				break;
+			}
 
-			const float32 k_errorTol = 1e-3f;
-			B2_NOT_USED(k_errorTol);
+			//
+			// Case 2: vn1 = 0 and x2 = 0
+			//
+			//   0 = a11 * x1 + a12 * 0 + b1' 
+			// vn2 = a21 * x1 + a22 * 0 + b2'
+			//
+			x.x = - cp1->normalMass * b.x;
+			x.y = 0.0f;
+			vn1 = 0.0f;
+			vn2 = vc->K.ex.y * x.x + b.y;
 
-			for (;;)
+			if (x.x >= 0.0f && vn2 >= 0.0f)
 			{
-				//
-				// Case 1: vn = 0
-				//
-				// 0 = A * x + b'
-				//
-				// Solve for x:
-				//
-				// x = - inv(A) * b'
-				//
-				b2Vec2 x = - b2Mul(vc->normalMass, b);
-
-				if (x.x >= 0.0f && x.y >= 0.0f)
-				{
-					// Get the incremental impulse
-					b2Vec2 d = x - a;
+				// Get the incremental impulse
+				b2Vec2 d = x - a;
 
-					// Apply incremental impulse
-					b2Vec2 P1 = d.x * normal;
-					b2Vec2 P2 = d.y * normal;
-					vA -= mA * (P1 + P2);
-					wA -= iA * (b2Cross(cp1->rA, P1) + b2Cross(cp2->rA, P2));
+				// Apply incremental impulse
+				b2Vec2 P1 = d.x * normal;
+				b2Vec2 P2 = d.y * normal;
+				vA -= mA * (P1 + P2);
+				wA -= iA * (b2Cross(cp1->rA, P1) + b2Cross(cp2->rA, P2));
 
-					vB += mB * (P1 + P2);
-					wB += iB * (b2Cross(cp1->rB, P1) + b2Cross(cp2->rB, P2));
+				vB += mB * (P1 + P2);
+				wB += iB * (b2Cross(cp1->rB, P1) + b2Cross(cp2->rB, P2));
 
-					// Accumulate
-					cp1->normalImpulse = x.x;
-					cp2->normalImpulse = x.y;
+				// Accumulate
+				cp1->normalImpulse = x.x;
+				cp2->normalImpulse = x.y;
 
 #if B2_DEBUG_SOLVER == 1
-					// Postconditions
-					dv1 = vB + b2Cross(wB, cp1->rB) - vA - b2Cross(wA, cp1->rA);
-					dv2 = vB + b2Cross(wB, cp2->rB) - vA - b2Cross(wA, cp2->rA);
+				// Postconditions
+				dv1 = vB + b2Cross(wB, cp1->rB) - vA - b2Cross(wA, cp1->rA);
 
-					// Compute normal velocity
-					vn1 = b2Dot(dv1, normal);
-					vn2 = b2Dot(dv2, normal);
+				// Compute normal velocity
+				vn1 = b2Dot(dv1, normal);
 
-					b2Assert(b2Abs(vn1 - cp1->velocityBias) < k_errorTol);
-					b2Assert(b2Abs(vn2 - cp2->velocityBias) < k_errorTol);
+				b2Assert(b2Abs(vn1 - cp1->velocityBias) < k_errorTol);
 #endif
-					break;
-				}
+				break;
+			}
 
-				//
-				// Case 2: vn1 = 0 and x2 = 0
-				//
-				//   0 = a11 * x1 + a12 * 0 + b1' 
-				// vn2 = a21 * x1 + a22 * 0 + b2'
-				//
-				x.x = - cp1->normalMass * b.x;
-				x.y = 0.0f;
-				vn1 = 0.0f;
-				vn2 = vc->K.ex.y * x.x + b.y;
-
-				if (x.x >= 0.0f && vn2 >= 0.0f)
-				{
-					// Get the incremental impulse
-					b2Vec2 d = x - a;
 
-					// Apply incremental impulse
-					b2Vec2 P1 = d.x * normal;
-					b2Vec2 P2 = d.y * normal;
-					vA -= mA * (P1 + P2);
-					wA -= iA * (b2Cross(cp1->rA, P1) + b2Cross(cp2->rA, P2));
+			//
+			// Case 3: vn2 = 0 and x1 = 0
+			//
+			// vn1 = a11 * 0 + a12 * x2 + b1' 
+			//   0 = a21 * 0 + a22 * x2 + b2'
+			//
+			x.x = 0.0f;
+			x.y = - cp2->normalMass * b.y;
+			vn1 = vc->K.ey.x * x.y + b.x;
+			vn2 = 0.0f;
+
+			if (x.y >= 0.0f && vn1 >= 0.0f)
+			{
+				// Resubstitute for the incremental impulse
+				b2Vec2 d = x - a;
+
+				// Apply incremental impulse
+				b2Vec2 P1 = d.x * normal;
+				b2Vec2 P2 = d.y * normal;
+				vA -= mA * (P1 + P2);
+				wA -= iA * (b2Cross(cp1->rA, P1) + b2Cross(cp2->rA, P2));
 
-					vB += mB * (P1 + P2);
-					wB += iB * (b2Cross(cp1->rB, P1) + b2Cross(cp2->rB, P2));
+				vB += mB * (P1 + P2);
+				wB += iB * (b2Cross(cp1->rB, P1) + b2Cross(cp2->rB, P2));
 
-					// Accumulate
-					cp1->normalImpulse = x.x;
-					cp2->normalImpulse = x.y;
+				// Accumulate
+				cp1->normalImpulse = x.x;
+				cp2->normalImpulse = x.y;
 
 #if B2_DEBUG_SOLVER == 1
-					// Postconditions
-					dv1 = vB + b2Cross(wB, cp1->rB) - vA - b2Cross(wA, cp1->rA);
+				// Postconditions
+				dv2 = vB + b2Cross(wB, cp2->rB) - vA - b2Cross(wA, cp2->rA);
 
-					// Compute normal velocity
-					vn1 = b2Dot(dv1, normal);
+				// Compute normal velocity
+				vn2 = b2Dot(dv2, normal);
 
-					b2Assert(b2Abs(vn1 - cp1->velocityBias) < k_errorTol);
+				b2Assert(b2Abs(vn2 - cp2->velocityBias) < k_errorTol);
 #endif
-					break;
-				}
-
+				break;
+			}
 
-				//
-				// Case 3: vn2 = 0 and x1 = 0
-				//
-				// vn1 = a11 * 0 + a12 * x2 + b1' 
-				//   0 = a21 * 0 + a22 * x2 + b2'
-				//
-				x.x = 0.0f;
-				x.y = - cp2->normalMass * b.y;
-				vn1 = vc->K.ey.x * x.y + b.x;
-				vn2 = 0.0f;
+			//
+			// Case 4: x1 = 0 and x2 = 0
+			// 
+			// vn1 = b1
+			// vn2 = b2;
+			x.x = 0.0f;
+			x.y = 0.0f;
+			vn1 = b.x;
+			vn2 = b.y;
+
+			if (vn1 >= 0.0f && vn2 >= 0.0f )
+			{
+				// Resubstitute for the incremental impulse
+				b2Vec2 d = x - a;
 
-				if (x.y >= 0.0f && vn1 >= 0.0f)
-				{
-					// Resubstitute for the incremental impulse
-					b2Vec2 d = x - a;
+				// Apply incremental impulse
+				b2Vec2 P1 = d.x * normal;
+				b2Vec2 P2 = d.y * normal;
+				vA -= mA * (P1 + P2);
+				wA -= iA * (b2Cross(cp1->rA, P1) + b2Cross(cp2->rA, P2));
 
-					// Apply incremental impulse
-					b2Vec2 P1 = d.x * normal;
-					b2Vec2 P2 = d.y * normal;
-					vA -= mA * (P1 + P2);
-					wA -= iA * (b2Cross(cp1->rA, P1) + b2Cross(cp2->rA, P2));
+				vB += mB * (P1 + P2);
+				wB += iB * (b2Cross(cp1->rB, P1) + b2Cross(cp2->rB, P2));
 
-					vB += mB * (P1 + P2);
-					wB += iB * (b2Cross(cp1->rB, P1) + b2Cross(cp2->rB, P2));
+				// Accumulate
+				cp1->normalImpulse = x.x;
+				cp2->normalImpulse = x.y;
 
-					// Accumulate
-					cp1->normalImpulse = x.x;
-					cp2->normalImpulse = x.y;
+				break;
+			}
 
-#if B2_DEBUG_SOLVER == 1
-					// Postconditions
-					dv2 = vB + b2Cross(wB, cp2->rB) - vA - b2Cross(wA, cp2->rA);
+			// No solution, give up. This is hit sometimes, but it doesn't seem to matter.
+			break;
+		}
+	}
 
-					// Compute normal velocity
-					vn2 = b2Dot(dv2, normal);
+	if (mA > 0.0f || iA > 0.0f)
+	{
+		m_velocities[indexA].v = vA;
+		m_velocities[indexA].w = wA;
+	}
+	if (mB > 0.0f || iB > 0.0f)
+	{
+		m_velocities[indexB].v = vB;
+		m_velocities[indexB].w = wB;
+	}
+}
 
-					b2Assert(b2Abs(vn2 - cp2->velocityBias) < k_errorTol);
-#endif
-					break;
-				}
+void b2ContactSolver::ApplyRestitution()
+{
+	if (m_speculativeCount == 0)
+	{
+		return;
+	}
 
-				//
-				// Case 4: x1 = 0 and x2 = 0
-				// 
-				// vn1 = b1
-				// vn2 = b2;
-				x.x = 0.0f;
-				x.y = 0.0f;
-				vn1 = b.x;
-				vn2 = b.y;
-
-				if (vn1 >= 0.0f && vn2 >= 0.0f )
-				{
-					// Resubstitute for the incremental impulse
-					b2Vec2 d = x - a;
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
+		if (vc->speculative == false || vc->restitution == 0.0f)
+		{
+			continue;
+		}
 
-					// Apply incremental impulse
-					b2Vec2 P1 = d.x * normal;
-					b2Vec2 P2 = d.y * normal;
-					vA -= mA * (P1 + P2);
-					wA -= iA * (b2Cross(cp1->rA, P1) + b2Cross(cp2->rA, P2));
+		int32 indexA = vc->indexA;
+		int32 indexB = vc->indexB;
+		float32 mA = vc->invMassA;
+		float32 iA = vc->invIA;
+		float32 mB = vc->invMassB;
+		float32 iB = vc->invIB;
+		b2Vec2 normal = vc->normal;
 
-					vB += mB * (P1 + P2);
-					wB += iB * (b2Cross(cp1->rB, P1) + b2Cross(cp2->rB, P2));
+		b2Vec2 vA = m_velocities[indexA].v;
+		float32 wA = m_velocities[indexA].w;
+		b2Vec2 vB = m_velocities[indexB].v;
+		float32 wB = m_velocities[indexB].w;
 
-					// Accumulate
-					cp1->normalImpulse = x.x;
-					cp2->normalImpulse = x.y;
+		b2Manifold* manifold = m_contacts[vc->contactIndex]->GetManifold();
 
-					break;
-				}
+		for (int32 j = 0; j < vc->pointCount; ++j)
+		{
+			b2VelocityConstraintPoint* vcp = vc->points + j;
 
-				// No solution, give up. This is hit sometimes, but it doesn't seem to matter.
-				break;
+			// Only bounce points that were hit fast enough.
+			if (vcp->relativeVelocity > -b2_velocityThreshold || vcp->normalImpulse == 0.0f)
+			{
+				continue;
 			}
+
+			b2Vec2 dv = vB + b2Cross(wB, vcp->rB) - vA - b2Cross(wA, vcp->rA);
+			float32 vn = b2Dot(dv, normal);
+
+			float32 lambda = -vcp->normalMass * (vn + vc->restitution * vcp->relativeVelocity);
+			float32 newImpulse = b2Max(vcp->normalImpulse + lambda, 0.0f);
+			lambda = newImpulse - vcp->normalImpulse;
+			vcp->normalImpulse = newImpulse;
+			manifold->points[j].normalImpulse = newImpulse;
+
+			b2Vec2 P = lambda * normal;
+			vA -= mA * P;
+			wA -= iA * b2Cross(vcp->rA, P);
+
+			vB += mB * P;
+			wB += iB * b2Cross(vcp->rB, P);
 		}
 
 		m_velocities[indexA].v = vA;
@@ -667,6 +896,7 @@ struct b2PositionSolverManifold
 	float32 separation;
 };
 
+
 // Sequential solver.
 bool b2ContactSolver::SolvePositionConstraints()
 {
@@ -674,76 +904,490 @@ bool b2ContactSolver::SolvePositionConstraints()
 
 	for (int32 i = 0; i < m_count; ++i)
 	{
-		b2ContactPositionConstraint* pc = m_positionConstraints + i;
+		minSeparation = b2Min(minSeparation, SolvePositionConstraint(m_positionConstraints + i));
+	}
 
-		int32 indexA = pc->indexA;
-		int32 indexB = pc->indexB;
-		b2Vec2 localCenterA = pc->localCenterA;
-		float32 mA = pc->invMassA;
-		float32 iA = pc->invIA;
-		b2Vec2 localCenterB = pc->localCenterB;
-		float32 mB = pc->invMassB;
-		float32 iB = pc->invIB;
-		int32 pointCount = pc->pointCount;
+	// We can't expect minSpeparation >= -b2_linearSlop because we don't
+	// push the separation above -b2_linearSlop.
+	return minSeparation >= -3.0f * b2_linearSlop;
+}
 
-		b2Vec2 cA = m_positions[indexA].c;
-		float32 aA = m_positions[indexA].a;
+// Returns the minimum separation of the contact before the correction.
+float32 b2ContactSolver::SolvePositionConstraint(b2ContactPositionConstraint* pc)
+{
+	float32 minSeparation = 0.0f;
 
-		b2Vec2 cB = m_positions[indexB].c;
-		float32 aB = m_positions[indexB].a;
+	int32 indexA = pc->indexA;
+	int32 indexB = pc->indexB;
+	b2Vec2 localCenterA = pc->localCenterA;
+	float32 mA = pc->invMassA;
+	float32 iA = pc->invIA;
+	b2Vec2 localCenterB = pc->localCenterB;
+	float32 mB = pc->invMassB;
+	float32 iB = pc->invIB;
+	int32 pointCount = pc->pointCount;
 
-		// Solve normal constraints
-		for (int32 j = 0; j < pointCount; ++j)
-		{
-			b2Transform xfA, xfB;
-			xfA.q.Set(aA);
-			xfB.q.Set(aB);
-			xfA.p = cA - b2Mul(xfA.q, localCenterA);
-			xfB.p = cB - b2Mul(xfB.q, localCenterB);
+	b2Vec2 cA = m_positions[indexA].c;
+	float32 aA = m_positions[indexA].a;
 
-			b2PositionSolverManifold psm;
-			psm.Initialize(pc, xfA, xfB, j);
-			b2Vec2 normal = psm.normal;
+	b2Vec2 cB = m_positions[indexB].c;
+	float32 aB = m_positions[indexB].a;
 
-			b2Vec2 point = psm.point;
-			float32 separation = psm.separation;
+	// Solve normal constraints
+	for (int32 j = 0; j < pointCount; ++j)
+	{
+		b2Transform xfA, xfB;
+		xfA.q.Set(aA);
+		xfB.q.Set(aB);
+		xfA.p = cA - b2Mul(xfA.q, localCenterA);
+		xfB.p = cB - b2Mul(xfB.q, localCenterB);
 
-			b2Vec2 rA = point - cA;
-			b2Vec2 rB = point - cB;
+		b2PositionSolverManifold psm;
+		psm.Initialize(pc, xfA, xfB, j);
+		b2Vec2 normal = psm.normal;
 
-			// Track max constraint error.
-			minSeparation = b2Min(minSeparation, separation);
+		b2Vec2 point = psm.point;
+		float32 separation = psm.separation;
 
-			// Prevent large corrections and allow slop.
-			float32 C = b2Clamp(b2_baumgarte * (separation + b2_linearSlop), -b2_maxLinearCorrection, 0.0f);
+		b2Vec2 rA = point - cA;
+		b2Vec2 rB = point - cB;
 
-			// Compute the effective mass.
-			float32 rnA = b2Cross(rA, normal);
-			float32 rnB = b2Cross(rB, normal);
-			float32 K = mA + mB + iA * rnA * rnA + iB * rnB * rnB;
+		// Track max constraint error.
+		minSeparation = b2Min(minSeparation, separation);
 
-			// Compute normal impulse
-			float32 impulse = K > 0.0f ? - C / K : 0.0f;
+		// Prevent large corrections and allow slop.
+		float32 C = b2Clamp(b2_baumgarte * (separation + b2_linearSlop), -b2_maxLinearCorrection, 0.0f);
 
-			b2Vec2 P = impulse * normal;
+		// Compute the effective mass.
+		float32 rnA = b2Cross(rA, normal);
+		float32 rnB = b2Cross(rB, normal);
+		float32 K = mA + mB + iA * rnA * rnA + iB * rnB * rnB;
 
-			cA -= mA * P;
-			aA -= iA * b2Cross(rA, P);
+		// Compute normal impulse
+		float32 impulse = K > 0.0f ? - C / K : 0.0f;
 
-			cB += mB * P;
-			aB += iB * b2Cross(rB, P);
-		}
+		b2Vec2 P = impulse * normal;
 
+		cA -= mA * P;
+		aA -= iA * b2Cross(rA, P);
+
+		cB += mB * P;
+		aB += iB * b2Cross(rB, P);
+	}
+
+	if (mA > 0.0f || iA > 0.0f)
+	{
 		m_positions[indexA].c = cA;
 		m_positions[indexA].a = aA;
-
+	}
+	if (mB > 0.0f || iB > 0.0f)
+	{
 		m_positions[indexB].c = cB;
 		m_positions[indexB].a = aB;
 	}
 
-	// We can't expect minSpeparation >= -b2_linearSlop because we don't
-	// push the separation above -b2_linearSlop.
-	return minSeparation >= -3.0f * b2_linearSlop;
+	return minSeparation;
+}
+
+#if B2_SIMD_SOLVER
+
+static inline __m128 b2SelectW(__m128 mask, __m128 a, __m128 b)
+{
+	return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+static inline __m128 b2NegW(__m128 a)
+{
+	return _mm_xor_ps(a, _mm_set1_ps(-0.0f));
+}
+
+// b2Cross(r, P) of four vectors
+static inline __m128 b2CrossW(__m128 rx, __m128 ry, __m128 Px, __m128 Py)
+{
+	return _mm_sub_ps(_mm_mul_ps(rx, Py), _mm_mul_ps(ry, Px));
+}
+
+#define b2_gatherW(p, member) _mm_setr_ps(p[0]->member, p[1]->member, p[2]->member, p[3]->member)
+
+// Solve four contacts that share no body with mass, one contact per SSE lane.
+// Every lane does the same operations in the same order as
+// b2ContactSolver::SolveVelocityConstraint, so the results are identical.
+static void b2SolveVelocityConstraintsW(b2ContactSolver* solver, const int32* indices)
+{
+	b2ContactVelocityConstraint* vc[4];
+	b2Velocity* velocityA[4];
+	b2Velocity* velocityB[4];
+	for (int32 k = 0; k < 4; ++k)
+	{
+		vc[k] = solver->m_velocityConstraints + indices[k];
+		velocityA[k] = solver->m_velocities + vc[k]->indexA;
+		velocityB[k] = solver->m_velocities + vc[k]->indexB;
+	}
+
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 twoPoints = _mm_castsi128_ps(_mm_setr_epi32(
+		vc[0]->pointCount == 2 ? -1 : 0, vc[1]->pointCount == 2 ? -1 : 0,
+		vc[2]->pointCount == 2 ? -1 : 0, vc[3]->pointCount == 2 ? -1 : 0));
+
+	__m128 mA = b2_gatherW(vc, invMassA);
+	__m128 iA = b2_gatherW(vc, invIA);
+	__m128 mB = b2_gatherW(vc, invMassB);
+	__m128 iB = b2_gatherW(vc, invIB);
+
+	__m128 vAx = b2_gatherW(velocityA, v.x);
+	__m128 vAy = b2_gatherW(velocityA, v.y);
+	__m128 wA = b2_gatherW(velocityA, w);
+	__m128 vBx = b2_gatherW(velocityB, v.x);
+	__m128 vBy = b2_gatherW(velocityB, v.y);
+	__m128 wB = b2_gatherW(velocityB, w);
+
+	__m128 nx = b2_gatherW(vc, normal.x);
+	__m128 ny = b2_gatherW(vc, normal.y);
+	__m128 tx = ny;
+	__m128 ty = b2NegW(nx);
+	__m128 friction = b2_gatherW(vc, friction);
+	__m128 tangentSpeed = b2_gatherW(vc, tangentSpeed);
+
+	__m128 rAx[2], rAy[2], rBx[2], rBy[2];
+	__m128 normalImpulse[2], tangentImpulse[2];
+	for (int32 j = 0; j < 2; ++j)
+	{
+		rAx[j] = b2_gatherW(vc, points[j].rA.x);
+		rAy[j] = b2_gatherW(vc, points[j].rA.y);
+		rBx[j] = b2_gatherW(vc, points[j].rB.x);
+		rBy[j] = b2_gatherW(vc, points[j].rB.y);
+		normalImpulse[j] = b2_gatherW(vc, points[j].normalImpulse);
+		tangentImpulse[j] = b2_gatherW(vc, points[j].tangentImpulse);
+	}
+
+	// Solve tangent constraints first because non-penetration is more important
+	// than friction. The second point only applies to lanes with two points.
+	for (int32 j = 0; j < 2; ++j)
+	{
+		__m128 tangentMass = b2_gatherW(vc, points[j].tangentMass);
+
+		// Relative velocity at contact
+		__m128 dvx = _mm_sub_ps(_mm_sub_ps(_mm_add_ps(vBx, _mm_mul_ps(b2NegW(wB), rBy[j])), vAx), _mm_mul_ps(b2NegW(wA), rAy[j]));
+		__m128 dvy = _mm_sub_ps(_mm_sub_ps(_mm_add_ps(vBy, _mm_mul_ps(wB, rBx[j])), vAy), _mm_mul_ps(wA, rAx[j]));
+
+		// Compute tangent force
+		__m128 vt = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(dvx, tx), _mm_mul_ps(dvy, ty)), tangentSpeed);
+		__m128 lambda = _mm_mul_ps(tangentMass, b2NegW(vt));
+
+		// b2Clamp the accumulated force
+		__m128 maxFriction = _mm_mul_ps(friction, normalImpulse[j]);
+		__m128 newImpulse = _mm_max_ps(b2NegW(maxFriction), _mm_min_ps(_mm_add_ps(tangentImpulse[j], lambda), maxFriction));
+		lambda = _mm_sub_ps(newImpulse, tangentImpulse[j]);
+
+		// Apply contact impulse
+		__m128 Px = _mm_mul_ps(lambda, tx);
+		__m128 Py = _mm_mul_ps(lambda, ty);
+
+		__m128 newVAx = _mm_sub_ps(vAx, _mm_mul_ps(mA, Px));
+		__m128 newVAy = _mm_sub_ps(vAy, _mm_mul_ps(mA, Py));
+		__m128 newWA = _mm_sub_ps(wA, _mm_mul_ps(iA, b2CrossW(rAx[j], rAy[j], Px, Py)));
+		__m128 newVBx = _mm_add_ps(vBx, _mm_mul_ps(mB, Px));
+		__m128 newVBy = _mm_add_ps(vBy, _mm_mul_ps(mB, Py));
+		__m128 newWB = _mm_add_ps(wB, _mm_mul_ps(iB, b2CrossW(rBx[j], rBy[j], Px, Py)));
+
+		if (j == 0)
+		{
+			tangentImpulse[0] = newImpulse;
+			vAx = newVAx; vAy = newVAy; wA = newWA;
+			vBx = newVBx; vBy = newVBy; wB = newWB;
+		}
+		else
+		{
+			tangentImpulse[1] = b2SelectW(twoPoints, newImpulse, tangentImpulse[1]);
+			vAx = b2SelectW(twoPoints, newVAx, vAx);
+			vAy = b2SelectW(twoPoints, newVAy, vAy);
+			wA = b2SelectW(twoPoints, newWA, wA);
+			vBx = b2SelectW(twoPoints, newVBx, vBx);
+			vBy = b2SelectW(twoPoints, newVBy, vBy);
+			wB = b2SelectW(twoPoints, newWB, wB);
+		}
+	}
+
+	// Lanes with one point solve the normal constraint directly.
+	__m128 dvx1 = _mm_sub_ps(_mm_sub_ps(_mm_add_ps(vBx, _mm_mul_ps(b2NegW(wB), rBy[0])), vAx), _mm_mul_ps(b2NegW(wA), rAy[0]));
+	__m128 dvy1 = _mm_sub_ps(_mm_sub_ps(_mm_add_ps(vBy, _mm_mul_ps(wB, rBx[0])), vAy), _mm_mul_ps(wA, rAx[0]));
+	__m128 dvx2 = _mm_sub_ps(_mm_sub_ps(_mm_add_ps(vBx, _mm_mul_ps(b2NegW(wB), rBy[1])), vAx), _mm_mul_ps(b2NegW(wA), rAy[1]));
+	__m128 dvy2 = _mm_sub_ps(_mm_sub_ps(_mm_add_ps(vBy, _mm_mul_ps(wB, rBx[1])), vAy), _mm_mul_ps(wA, rAx[1]));
+	__m128 vn1 = _mm_add_ps(_mm_mul_ps(dvx1, nx), _mm_mul_ps(dvy1, ny));
+	__m128 vn2 = _mm_add_ps(_mm_mul_ps(dvx2, nx), _mm_mul_ps(dvy2, ny));
+
+	__m128 normalMass1 = b2_gatherW(vc, points[0].normalMass);
+	__m128 normalMass2 = b2_gatherW(vc, points[1].normalMass);
+	__m128 velocityBias1 = b2_gatherW(vc, points[0].velocityBias);
+	__m128 velocityBias2 = b2_gatherW(vc, points[1].velocityBias);
+
+	__m128 lambda = _mm_mul_ps(b2NegW(normalMass1), _mm_sub_ps(vn1, velocityBias1));
+	__m128 singleImpulse = _mm_max_ps(_mm_add_ps(normalImpulse[0], lambda), zero);
+	lambda = _mm_sub_ps(singleImpulse, normalImpulse[0]);
+	__m128 Px = _mm_mul_ps(lambda, nx);
+	__m128 Py = _mm_mul_ps(lambda, ny);
+	__m128 singleVAx = _mm_sub_ps(vAx, _mm_mul_ps(mA, Px));
+	__m128 singleVAy = _mm_sub_ps(vAy, _mm_mul_ps(mA, Py));
+	__m128 singleWA = _mm_sub_ps(wA, _mm_mul_ps(iA, b2CrossW(rAx[0], rAy[0], Px, Py)));
+	__m128 singleVBx = _mm_add_ps(vBx, _mm_mul_ps(mB, Px));
+	__m128 singleVBy = _mm_add_ps(vBy, _mm_mul_ps(mB, Py));
+	__m128 singleWB = _mm_add_ps(wB, _mm_mul_ps(iB, b2CrossW(rBx[0], rBy[0], Px, Py)));
+
+	// Lanes with two points use the block solver. All four cases are evaluated
+	// and the first valid one is taken, as in the scalar solver.
+	__m128 ax = normalImpulse[0];
+	__m128 ay = normalImpulse[1];
+	__m128 Kexx = b2_gatherW(vc, K.ex.x);
+	__m128 Kexy = b2_gatherW(vc, K.ex.y);
+	__m128 Keyx = b2_gatherW(vc, K.ey.x);
+	__m128 Keyy = b2_gatherW(vc, K.ey.y);
+	__m128 bx = _mm_sub_ps(_mm_sub_ps(vn1, velocityBias1), _mm_add_ps(_mm_mul_ps(Kexx, ax), _mm_mul_ps(Keyx, ay)));
+	__m128 by = _mm_sub_ps(_mm_sub_ps(vn2, velocityBias2), _mm_add_ps(_mm_mul_ps(Kexy, ax), _mm_mul_ps(Keyy, ay)));
+
+	// Case 1: vn = 0
+	__m128 x1x = b2NegW(_mm_add_ps(_mm_mul_ps(b2_gatherW(vc, normalMass.ex.x), bx), _mm_mul_ps(b2_gatherW(vc, normalMass.ey.x), by)));
+	__m128 x1y = b2NegW(_mm_add_ps(_mm_mul_ps(b2_gatherW(vc, normalMass.ex.y), bx), _mm_mul_ps(b2_gatherW(vc, normalMass.ey.y), by)));
+	__m128 valid1 = _mm_and_ps(_mm_cmpge_ps(x1x, zero), _mm_cmpge_ps(x1y, zero));
+
+	// Case 2: vn1 = 0 and x2 = 0
+	__m128 x2x = _mm_mul_ps(b2NegW(normalMass1), bx);
+	__m128 valid2 = _mm_and_ps(_mm_cmpge_ps(x2x, zero), _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(Kexy, x2x), by), zero));
+
+	// Case 3: vn2 = 0 and x1 = 0
+	__m128 x3y = _mm_mul_ps(b2NegW(normalMass2), by);
+	__m128 valid3 = _mm_and_ps(_mm_cmpge_ps(x3y, zero), _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(Keyx, x3y), bx), zero));
+
+	// Case 4: x1 = x2 = 0
+	__m128 valid4 = _mm_and_ps(_mm_cmpge_ps(bx, zero), _mm_cmpge_ps(by, zero));
+
+	__m128 solved = _mm_or_ps(_mm_or_ps(valid1, valid2), _mm_or_ps(valid3, valid4));
+	__m128 xx = b2SelectW(valid1, x1x, b2SelectW(valid2, x2x, zero));
+	__m128 xy = b2SelectW(valid1, x1y, b2SelectW(valid2, zero, b2SelectW(valid3, x3y, zero)));
+
+	__m128 dx = _mm_sub_ps(xx, ax);
+	__m128 dy = _mm_sub_ps(xy, ay);
+	__m128 P1x = _mm_mul_ps(dx, nx);
+	__m128 P1y = _mm_mul_ps(dx, ny);
+	__m128 P2x = _mm_mul_ps(dy, nx);
+	__m128 P2y = _mm_mul_ps(dy, ny);
+	__m128 blockVAx = _mm_sub_ps(vAx, _mm_mul_ps(mA, _mm_add_ps(P1x, P2x)));
+	__m128 blockVAy = _mm_sub_ps(vAy, _mm_mul_ps(mA, _mm_add_ps(P1y, P2y)));
+	__m128 blockWA = _mm_sub_ps(wA, _mm_mul_ps(iA, _mm_add_ps(b2CrossW(rAx[0], rAy[0], P1x, P1y), b2CrossW(rAx[1], rAy[1], P2x, P2y))));
+	__m128 blockVBx = _mm_add_ps(vBx, _mm_mul_ps(mB, _mm_add_ps(P1x, P2x)));
+	__m128 blockVBy = _mm_add_ps(vBy, _mm_mul_ps(mB, _mm_add_ps(P1y, P2y)));
+	__m128 blockWB = _mm_add_ps(wB, _mm_mul_ps(iB, _mm_add_ps(b2CrossW(rBx[0], rBy[0], P1x, P1y), b2CrossW(rBx[1], rBy[1], P2x, P2y))));
+
+	// Lanes without a valid case keep their state.
+	__m128 block = _mm_and_ps(twoPoints, solved);
+	vAx = b2SelectW(block, blockVAx, b2SelectW(twoPoints, vAx, singleVAx));
+	vAy = b2SelectW(block, blockVAy, b2SelectW(twoPoints, vAy, singleVAy));
+	wA = b2SelectW(block, blockWA, b2SelectW(twoPoints, wA, singleWA));
+	vBx = b2SelectW(block, blockVBx, b2SelectW(twoPoints, vBx, singleVBx));
+	vBy = b2SelectW(block, blockVBy, b2SelectW(twoPoints, vBy, singleVBy));
+	wB = b2SelectW(block, blockWB, b2SelectW(twoPoints, wB, singleWB));
+	normalImpulse[0] = b2SelectW(block, xx, b2SelectW(twoPoints, ax, singleImpulse));
+	normalImpulse[1] = b2SelectW(block, xy, ay);
+
+	float32 out[10][4];
+	_mm_storeu_ps(out[0], vAx);
+	_mm_storeu_ps(out[1], vAy);
+	_mm_storeu_ps(out[2], wA);
+	_mm_storeu_ps(out[3], vBx);
+	_mm_storeu_ps(out[4], vBy);
+	_mm_storeu_ps(out[5], wB);
+	_mm_storeu_ps(out[6], normalImpulse[0]);
+	_mm_storeu_ps(out[7], normalImpulse[1]);
+	_mm_storeu_ps(out[8], tangentImpulse[0]);
+	_mm_storeu_ps(out[9], tangentImpulse[1]);
+
+	for (int32 k = 0; k < 4; ++k)
+	{
+		b2ContactVelocityConstraint* c = vc[k];
+		c->points[0].normalImpulse = out[6][k];
+		c->points[0].tangentImpulse = out[8][k];
+		if (c->pointCount == 2)
+		{
+			c->points[1].normalImpulse = out[7][k];
+			c->points[1].tangentImpulse = out[9][k];
+		}
+
+		if (c->invMassA > 0.0f || c->invIA > 0.0f)
+		{
+			velocityA[k]->v.Set(out[0][k], out[1][k]);
+			velocityA[k]->w = out[2][k];
+		}
+		if (c->invMassB > 0.0f || c->invIB > 0.0f)
+		{
+			velocityB[k]->v.Set(out[3][k], out[4][k]);
+			velocityB[k]->w = out[5][k];
+		}
+	}
+}
+
+#undef b2_gatherW
+
+#endif
+
+// Solves the colors of a b2ContactSolver on all threads of a pool. The colors
+// of all iterations are cut into blocks that the threads take in order. A
+// block is solved as soon as all blocks of the preceding colors are done.
+class b2ColoredSolverTask : public b2ThreadTask
+{
+public:
+	b2ColoredSolverTask(b2ContactSolver* solver, int32 iterations, bool positions)
+		: m_solver(solver), m_positions(positions), m_next(0), m_done(0), m_failedIteration(-1), m_stop(false)
+	{
+		const int32* colorStarts = solver->m_colorStarts;
+		int32 blockCount = 0;
+		for (int32 c = 0; c < solver->m_colorCount; ++c)
+		{
+			m_colorBlockStarts[c] = blockCount;
+
+			// The extra color may share bodies, so it stays in one block.
+			int32 count = colorStarts[c + 1] - colorStarts[c];
+			blockCount += c == b2_maxGraphColors ? 1 : (count + b2_colorBlockSize - 1) / b2_colorBlockSize;
+		}
+		m_colorBlockStarts[solver->m_colorCount] = blockCount;
+
+		m_iterationBlockCount = blockCount;
+		m_blockCount = iterations * blockCount;
+	}
+
+	void Execute(int32 threadIndex)
+	{
+		B2_NOT_USED(threadIndex);
+
+		for (;;)
+		{
+			int32 block = m_next++;
+			if (block >= m_blockCount)
+			{
+				break;
+			}
+
+			int32 iteration = block / m_iterationBlockCount;
+			int32 offset = block - iteration * m_iterationBlockCount;
+			int32 color = 0;
+			while (m_colorBlockStarts[color + 1] <= offset)
+			{
+				++color;
+			}
+
+			// Wait for the blocks of the preceding colors.
+			int32 stageStart = iteration * m_iterationBlockCount + m_colorBlockStarts[color];
+			while (m_done.load(std::memory_order_acquire) < stageStart && m_stop.load() == false)
+			{
+				std::this_thread::yield();
+			}
+
+			// Stop once an iteration has solved the positions.
+			if (m_positions && iteration > 0 && m_failedIteration.load() < iteration - 1)
+			{
+				m_stop = true;
+			}
+
+			if (m_stop.load())
+			{
+				break;
+			}
+
+			const int32* colorStarts = m_solver->m_colorStarts;
+			int32 first = colorStarts[color] + (offset - m_colorBlockStarts[color]) * b2_colorBlockSize;
+			int32 last = color == b2_maxGraphColors ? colorStarts[color + 1] : b2Min(first + b2_colorBlockSize, colorStarts[color + 1]);
+
+			if (m_positions)
+			{
+				float32 minSeparation = 0.0f;
+				for (int32 i = first; i < last; ++i)
+				{
+					int32 index = m_solver->m_colorOrder[i];
+					minSeparation = b2Min(minSeparation, m_solver->SolvePositionConstraint(m_solver->m_positionConstraints + index));
+				}
+
+				if (minSeparation < -3.0f * b2_linearSlop)
+				{
+					int32 failed = m_failedIteration.load();
+					while (failed < iteration && m_failedIteration.compare_exchange_weak(failed, iteration) == false)
+					{
+					}
+				}
+			}
+			else
+			{
+				int32 i = first;
+#if B2_SIMD_SOLVER
+				if (g_blockSolve && color != b2_maxGraphColors)
+				{
+					for (; i + 4 <= last; i += 4)
+					{
+						b2SolveVelocityConstraintsW(m_solver, m_solver->m_colorOrder + i);
+					}
+				}
+#endif
+				for (; i < last; ++i)
+				{
+					int32 index = m_solver->m_colorOrder[i];
+					m_solver->SolveVelocityConstraint(m_solver->m_velocityConstraints + index);
+				}
+			}
+
+			m_done.fetch_add(1, std::memory_order_release);
+		}
+	}
+
+	// Returns true if the positions were solved within an iteration.
+	bool IsSolved(int32 iterations) const
+	{
+		return m_stop.load() || m_failedIteration.load() < iterations - 1;
+	}
+
+private:
+	b2ContactSolver* m_solver;
+	bool m_positions;
+	int32 m_colorBlockStarts[b2_maxGraphColors + 2];
+	int32 m_iterationBlockCount;
+	int32 m_blockCount;
+	std::atomic<int32> m_next;
+	std::atomic<int32> m_done;
+	std::atomic<int32> m_failedIteration;
+	std::atomic<bool> m_stop;
+};
+
+void b2ContactSolver::SolveColoredVelocityConstraints(int32 iterations)
+{
+	b2Assert(IsColored());
+
+	b2ColoredSolverTask task(this, iterations, false);
+	if (m_threadPool != NULL)
+	{
+		m_threadPool->Run(&task);
+	}
+	else
+	{
+		task.Execute(0);
+	}
+}
+
+bool b2ContactSolver::SolveColoredPositionConstraints(int32 iterations)
+{
+	b2Assert(IsColored());
+
+	if (iterations <= 0)
+	{
+		return false;
+	}
+
+	b2ColoredSolverTask task(this, iterations, true);
+	if (m_threadPool != NULL)
+	{
+		m_threadPool->Run(&task);
+	}
+	else
+	{
+		task.Execute(0);
+	}
+
+	return task.IsSolved(iterations);
 }
 
 // Sequential position solver for position constraints.
@@ -26,8 +26,13 @@
 class b2Contact;
 class b2Body;
 class b2StackAllocator;
+class b2ThreadPool;
 struct b2ContactPositionConstraint;
 
+/// The maximum number of graph colors. Contacts that do not fit into
+/// these colors are solved sequentially in an extra color.
+#define b2_maxGraphColors		64
+
 struct b2VelocityConstraintPoint
 {
 	b2Vec2 rA;
@@ -37,6 +42,7 @@ struct b2VelocityConstraintPoint
 	float32 normalMass;
 	float32 tangentMass;
 	float32 velocityBias;
+	float32 relativeVelocity;
 };
 
 struct b2ContactVelocityConstraint
@@ -54,6 +60,7 @@ struct b2ContactVelocityConstraint
 	float32 tangentSpeed;
 	int32 pointCount;
 	int32 contactIndex;
+	bool speculative;
 };
 
 struct b2ContactSolverDef
@@ -61,9 +68,12 @@ struct b2ContactSolverDef
 	b2TimeStep step;
 	b2Contact** contacts;
 	int32 count;
+	const int32* indices;	///< island indices of the bodies, two per contact; NULL to use b2Body::m_islandIndex
 	b2Position* positions;
 	b2Velocity* velocities;
 	b2StackAllocator* allocator;
+	b2ThreadPool* threadPool;	///< the pool solving the colors; NULL to solve them on the calling thread
+	bool useColors;				///< partition the contacts into graph colors, see SolveColoredVelocityConstraints
 };
 
 class b2ContactSolver
@@ -78,9 +88,28 @@ public:
 	void SolveVelocityConstraints();
 	void StoreImpulses();
 
+	/// Bounce the speculative contacts that were hit in this step. Their
+	/// velocity bias is spent on the approach, so restitution is applied
+	/// after the positions were integrated, when the bodies have met.
+	void ApplyRestitution();
+
 	bool SolvePositionConstraints();
 	bool SolveTOIPositionConstraints(int32 toiIndexA, int32 toiIndexB);
 
+	/// Run all velocity iterations color by color. No two contacts of a color
+	/// share a body with mass, so the contacts of a color are solved in parallel.
+	/// The result does not depend on the number of threads.
+	void SolveColoredVelocityConstraints(int32 iterations);
+
+	/// Run up to the given number of position iterations color by color.
+	/// @return true if the positions were solved within an iteration.
+	bool SolveColoredPositionConstraints(int32 iterations);
+
+	void SolveVelocityConstraint(b2ContactVelocityConstraint* vc);
+	float32 SolvePositionConstraint(b2ContactPositionConstraint* pc);
+
+	bool IsColored() const { return m_colorOrder != NULL; }
+
 	b2TimeStep m_step;
 	b2Position* m_positions;
 	b2Velocity* m_velocities;
@@ -89,6 +118,11 @@ public:
 	b2ContactVelocityConstraint* m_velocityConstraints;
 	b2Contact** m_contacts;
 	int m_count;
+	int32 m_speculativeCount;
+	b2ThreadPool* m_threadPool;
+	int32* m_colorOrder;
+	int32 m_colorStarts[b2_maxGraphColors + 2];
+	int32 m_colorCount;
 };
 
 #endif
@@ -61,10 +61,10 @@ b2GearJoint::b2GearJoint(const b2GearJointDef* def)
 	m_bodyA = m_joint1->GetBodyB();
 
 	// Get geometry of joint1
-	b2Transform xfA = m_bodyA->m_xf;
-	float32 aA = m_bodyA->m_sweep.a;
-	b2Transform xfC = m_bodyC->m_xf;
-	float32 aC = m_bodyC->m_sweep.a;
+	b2Transform xfA = m_bodyA->Transform();
+	float32 aA = m_bodyA->Sweep().a;
+	b2Transform xfC = m_bodyC->Transform();
+	float32 aC = m_bodyC->Sweep().a;
 
 	if (m_typeA == e_revoluteJoint)
 	{
@@ -93,10 +93,10 @@ b2GearJoint::b2GearJoint(const b2GearJointDef* def)
 	m_bodyB = m_joint2->GetBodyB();
 
 	// Get geometry of joint2
-	b2Transform xfB = m_bodyB->m_xf;
-	float32 aB = m_bodyB->m_sweep.a;
-	b2Transform xfD = m_bodyD->m_xf;
-	float32 aD = m_bodyD->m_sweep.a;
+	b2Transform xfB = m_bodyB->Transform();
+	float32 aB = m_bodyB->Sweep().a;
+	b2Transform xfD = m_bodyD->Transform();
+	float32 aD = m_bodyD->Sweep().a;
 
 	if (m_typeB == e_revoluteJoint)
 	{
@@ -134,10 +134,10 @@ void b2GearJoint::InitVelocityConstraints(const b2SolverData& data)
 	m_indexB = m_bodyB->m_islandIndex;
 	m_indexC = m_bodyC->m_islandIndex;
 	m_indexD = m_bodyD->m_islandIndex;
-	m_lcA = m_bodyA->m_sweep.localCenter;
-	m_lcB = m_bodyB->m_sweep.localCenter;
-	m_lcC = m_bodyC->m_sweep.localCenter;
-	m_lcD = m_bodyD->m_sweep.localCenter;
+	m_lcA = m_bodyA->Sweep().localCenter;
+	m_lcB = m_bodyB->Sweep().localCenter;
+	m_lcC = m_bodyC->Sweep().localCenter;
+	m_lcD = m_bodyD->Sweep().localCenter;
 	m_mA = m_bodyA->m_invMass;
 	m_mB = m_bodyB->m_invMass;
 	m_mC = m_bodyC->m_invMass;
@@ -31,48 +31,49 @@ b2Body::b2Body(const b2BodyDef* bd, b2World* world)
 	b2Assert(b2IsValid(bd->angularDamping) && bd->angularDamping >= 0.0f);
 	b2Assert(b2IsValid(bd->linearDamping) && bd->linearDamping >= 0.0f);
 
-	m_flags = 0;
+	m_world = world;
+	world->CreateBodyState(this);
+
+	Flags() = 0;
 
 	if (bd->bullet)
 	{
-		m_flags |= e_bulletFlag;
+		Flags() |= e_bulletFlag;
 	}
 	if (bd->fixedRotation)
 	{
-		m_flags |= e_fixedRotationFlag;
+		Flags() |= e_fixedRotationFlag;
 	}
 	if (bd->allowSleep)
 	{
-		m_flags |= e_autoSleepFlag;
+		Flags() |= e_autoSleepFlag;
 	}
 	if (bd->awake)
 	{
-		m_flags |= e_awakeFlag;
+		Flags() |= e_awakeFlag;
 	}
 	if (bd->active)
 	{
-		m_flags |= e_activeFlag;
+		Flags() |= e_activeFlag;
 	}
 
-	m_world = world;
+	Transform().p = bd->position;
+	Transform().q.Set(bd->angle);
 
-	m_xf.p = bd->position;
-	m_xf.q.Set(bd->angle);
-
-	m_sweep.localCenter.SetZero();
-	m_sweep.c0 = m_xf.p;
-	m_sweep.c = m_xf.p;
-	m_sweep.a0 = bd->angle;
-	m_sweep.a = bd->angle;
-	m_sweep.alpha0 = 0.0f;
+	Sweep().localCenter.SetZero();
+	Sweep().c0 = Transform().p;
+	Sweep().c = Transform().p;
+	Sweep().a0 = bd->angle;
+	Sweep().a = bd->angle;
+	Sweep().alpha0 = 0.0f;
 
 	m_jointList = NULL;
 	m_contactList = NULL;
 	m_prev = NULL;
 	m_next = NULL;
 
-	m_linearVelocity = bd->linearVelocity;
-	m_angularVelocity = bd->angularVelocity;
+	LinearVelocity() = bd->linearVelocity;
+	AngularVelocity() = bd->angularVelocity;
 
 	m_linearDamping = bd->linearDamping;
 	m_angularDamping = bd->angularDamping;
@@ -99,7 +100,7 @@ b2Body::b2Body(const b2BodyDef* bd, b2World* world)
 	m_I = 0.0f;
 	m_invI = 0.0f;
 
-	m_userData = bd->userData;
+	SetUserData(bd->userData);
 
 	m_fixtureList = NULL;
 	m_fixtureCount = 0;
@@ -123,16 +124,17 @@ void b2Body::SetType(b2BodyType type)
 		return;
 	}
 
+	bool wasStatic = m_type == b2_staticBody;
 	m_type = type;
 
 	ResetMassData();
 
 	if (m_type == b2_staticBody)
 	{
-		m_linearVelocity.SetZero();
-		m_angularVelocity = 0.0f;
-		m_sweep.a0 = m_sweep.a;
-		m_sweep.c0 = m_sweep.c;
+		LinearVelocity().SetZero();
+		AngularVelocity() = 0.0f;
+		Sweep().a0 = Sweep().a;
+		Sweep().c0 = Sweep().c;
 		SynchronizeFixtures();
 	}
 
@@ -155,6 +157,15 @@ void b2Body::SetType(b2BodyType type)
 	b2BroadPhase* broadPhase = &m_world->m_contactManager.m_broadPhase;
 	for (b2Fixture* f = m_fixtureList; f; f = f->m_next)
 	{
+		if (wasStatic != (m_type == b2_staticBody) && f->m_proxyCount > 0)
+		{
+			// The proxies have to move to the other broad-phase tree.
+			// New proxies are buffered as moved, just like touched ones.
+			f->DestroyProxies(broadPhase);
+			f->CreateProxies(broadPhase, Transform());
+			continue;
+		}
+
 		int32 proxyCount = f->m_proxyCount;
 		for (int32 i = 0; i < proxyCount; ++i)
 		{
@@ -177,10 +188,10 @@ b2Fixture* b2Body::CreateFixture(const b2FixtureDef* def)
 	b2Fixture* fixture = new (memory) b2Fixture;
 	fixture->Create(allocator, this, def);
 
-	if (m_flags & e_activeFlag)
+	if (Flags() & e_activeFlag)
 	{
 		b2BroadPhase* broadPhase = &m_world->m_contactManager.m_broadPhase;
-		fixture->CreateProxies(broadPhase, m_xf);
+		fixture->CreateProxies(broadPhase, Transform());
 	}
 
 	fixture->m_next = m_fixtureList;
@@ -260,7 +271,7 @@ void b2Body::DestroyFixture(b2Fixture* fixture)
 
 	b2BlockAllocator* allocator = &m_world->m_blockAllocator;
 
-	if (m_flags & e_activeFlag)
+	if (Flags() & e_activeFlag)
 	{
 		b2BroadPhase* broadPhase = &m_world->m_contactManager.m_broadPhase;
 		fixture->DestroyProxies(broadPhase);
@@ -285,14 +296,14 @@ void b2Body::ResetMassData()
 	m_invMass = 0.0f;
 	m_I = 0.0f;
 	m_invI = 0.0f;
-	m_sweep.localCenter.SetZero();
+	Sweep().localCenter.SetZero();
 
 	// Static and kinematic bodies have zero mass.
 	if (m_type == b2_staticBody || m_type == b2_kinematicBody)
 	{
-		m_sweep.c0 = m_xf.p;
-		m_sweep.c = m_xf.p;
-		m_sweep.a0 = m_sweep.a;
+		Sweep().c0 = Transform().p;
+		Sweep().c = Transform().p;
+		Sweep().a0 = Sweep().a;
 		return;
 	}
 
@@ -327,7 +338,7 @@ void b2Body::ResetMassData()
 		m_invMass = 1.0f;
 	}
 
-	if (m_I > 0.0f && (m_flags & e_fixedRotationFlag) == 0)
+	if (m_I > 0.0f && (Flags() & e_fixedRotationFlag) == 0)
 	{
 		// Center the inertia about the center of mass.
 		m_I -= m_mass * b2Dot(localCenter, localCenter);
@@ -342,12 +353,12 @@ void b2Body::ResetMassData()
 	}
 
 	// Move center of mass.
-	b2Vec2 oldCenter = m_sweep.c;
-	m_sweep.localCenter = localCenter;
-	m_sweep.c0 = m_sweep.c = b2Mul(m_xf, m_sweep.localCenter);
+	b2Vec2 oldCenter = Sweep().c;
+	Sweep().localCenter = localCenter;
+	Sweep().c0 = Sweep().c = b2Mul(Transform(), Sweep().localCenter);
 
 	// Update center of mass velocity.
-	m_linearVelocity += b2Cross(m_angularVelocity, m_sweep.c - oldCenter);
+	LinearVelocity() += b2Cross(AngularVelocity(), Sweep().c - oldCenter);
 }
 
 void b2Body::SetMassData(const b2MassData* massData)
@@ -375,7 +386,7 @@ void b2Body::SetMassData(const b2MassData* massData)
 
 	m_invMass = 1.0f / m_mass;
 
-	if (massData->I > 0.0f && (m_flags & b2Body::e_fixedRotationFlag) == 0)
+	if (massData->I > 0.0f && (Flags() & b2Body::e_fixedRotationFlag) == 0)
 	{
 		m_I = massData->I - m_mass * b2Dot(massData->center, massData->center);
 		b2Assert(m_I > 0.0f);
@@ -383,12 +394,12 @@ void b2Body::SetMassData(const b2MassData* massData)
 	}
 
 	// Move center of mass.
-	b2Vec2 oldCenter = m_sweep.c;
-	m_sweep.localCenter =  massData->center;
-	m_sweep.c0 = m_sweep.c = b2Mul(m_xf, m_sweep.localCenter);
+	b2Vec2 oldCenter = Sweep().c;
+	Sweep().localCenter =  massData->center;
+	Sweep().c0 = Sweep().c = b2Mul(Transform(), Sweep().localCenter);
 
 	// Update center of mass velocity.
-	m_linearVelocity += b2Cross(m_angularVelocity, m_sweep.c - oldCenter);
+	LinearVelocity() += b2Cross(AngularVelocity(), Sweep().c - oldCenter);
 }
 
 bool b2Body::ShouldCollide(const b2Body* other) const
@@ -422,33 +433,53 @@ void b2Body::SetTransform(const b2Vec2& position, float32 angle)
 		return;
 	}
 
-	m_xf.q.Set(angle);
-	m_xf.p = position;
+	Transform().q.Set(angle);
+	Transform().p = position;
 
-	m_sweep.c = b2Mul(m_xf, m_sweep.localCenter);
-	m_sweep.a = angle;
+	Sweep().c = b2Mul(Transform(), Sweep().localCenter);
+	Sweep().a = angle;
 
-	m_sweep.c0 = m_sweep.c;
-	m_sweep.a0 = angle;
+	Sweep().c0 = Sweep().c;
+	Sweep().a0 = angle;
 
 	b2BroadPhase* broadPhase = &m_world->m_contactManager.m_broadPhase;
 	for (b2Fixture* f = m_fixtureList; f; f = f->m_next)
 	{
-		f->Synchronize(broadPhase, m_xf, m_xf);
+		f->Synchronize(broadPhase, Transform(), Transform());
 	}
+
+	m_world->AddMovedBody(this);
 }
 
 void b2Body::SynchronizeFixtures()
 {
 	b2Transform xf1;
-	xf1.q.Set(m_sweep.a0);
-	xf1.p = m_sweep.c0 - b2Mul(xf1.q, m_sweep.localCenter);
+	xf1.q.Set(Sweep().a0);
+	xf1.p = Sweep().c0 - b2Mul(xf1.q, Sweep().localCenter);
 
 	b2BroadPhase* broadPhase = &m_world->m_contactManager.m_broadPhase;
 	for (b2Fixture* f = m_fixtureList; f; f = f->m_next)
 	{
-		f->Synchronize(broadPhase, xf1, m_xf);
+		f->Synchronize(broadPhase, xf1, Transform());
 	}
+
+	m_world->AddMovedBody(this);
+}
+
+// Cover the distance the body can travel in the next step instead of the
+// last one, so that the contacts a bullet may run into exist before it
+// gets there.
+void b2Body::SynchronizeSpeculativeFixtures(float32 dt)
+{
+	float32 distance = dt * LinearVelocity().Length();
+
+	b2BroadPhase* broadPhase = &m_world->m_contactManager.m_broadPhase;
+	for (b2Fixture* f = m_fixtureList; f; f = f->m_next)
+	{
+		f->SynchronizeSpeculative(broadPhase, Transform(), distance);
+	}
+
+	m_world->AddMovedBody(this);
 }
 
 void b2Body::SetActive(bool flag)
@@ -462,20 +493,20 @@ void b2Body::SetActive(bool flag)
 
 	if (flag)
 	{
-		m_flags |= e_activeFlag;
+		Flags() |= e_activeFlag;
 
 		// Create all proxies.
 		b2BroadPhase* broadPhase = &m_world->m_contactManager.m_broadPhase;
 		for (b2Fixture* f = m_fixtureList; f; f = f->m_next)
 		{
-			f->CreateProxies(broadPhase, m_xf);
+			f->CreateProxies(broadPhase, Transform());
 		}
 
 		// Contacts are created the next time step.
 	}
 	else
 	{
-		m_flags &= ~e_activeFlag;
+		Flags() &= ~e_activeFlag;
 
 		// Destroy all proxies.
 		b2BroadPhase* broadPhase = &m_world->m_contactManager.m_broadPhase;
@@ -498,7 +529,7 @@ void b2Body::SetActive(bool flag)
 
 void b2Body::SetFixedRotation(bool flag)
 {
-	bool status = (m_flags & e_fixedRotationFlag) == e_fixedRotationFlag;
+	bool status = (Flags() & e_fixedRotationFlag) == e_fixedRotationFlag;
 	if (status == flag)
 	{
 		return;
@@ -506,14 +537,14 @@ void b2Body::SetFixedRotation(bool flag)
 
 	if (flag)
 	{
-		m_flags |= e_fixedRotationFlag;
+		Flags() |= e_fixedRotationFlag;
 	}
 	else
 	{
-		m_flags &= ~e_fixedRotationFlag;
+		Flags() &= ~e_fixedRotationFlag;
 	}
 
-	m_angularVelocity = 0.0f;
+	AngularVelocity() = 0.0f;
 
 	ResetMassData();
 }
@@ -525,17 +556,17 @@ void b2Body::Dump()
 	b2Log("{\n");
 	b2Log("  b2BodyDef bd;\n");
 	b2Log("  bd.type = b2BodyType(%d);\n", m_type);
-	b2Log("  bd.position.Set(%.15lef, %.15lef);\n", m_xf.p.x, m_xf.p.y);
-	b2Log("  bd.angle = %.15lef;\n", m_sweep.a);
-	b2Log("  bd.linearVelocity.Set(%.15lef, %.15lef);\n", m_linearVelocity.x, m_linearVelocity.y);
-	b2Log("  bd.angularVelocity = %.15lef;\n", m_angularVelocity);
+	b2Log("  bd.position.Set(%.15lef, %.15lef);\n", Transform().p.x, Transform().p.y);
+	b2Log("  bd.angle = %.15lef;\n", Sweep().a);
+	b2Log("  bd.linearVelocity.Set(%.15lef, %.15lef);\n", LinearVelocity().x, LinearVelocity().y);
+	b2Log("  bd.angularVelocity = %.15lef;\n", AngularVelocity());
 	b2Log("  bd.linearDamping = %.15lef;\n", m_linearDamping);
 	b2Log("  bd.angularDamping = %.15lef;\n", m_angularDamping);
-	b2Log("  bd.allowSleep = bool(%d);\n", m_flags & e_autoSleepFlag);
-	b2Log("  bd.awake = bool(%d);\n", m_flags & e_awakeFlag);
-	b2Log("  bd.fixedRotation = bool(%d);\n", m_flags & e_fixedRotationFlag);
-	b2Log("  bd.bullet = bool(%d);\n", m_flags & e_bulletFlag);
-	b2Log("  bd.active = bool(%d);\n", m_flags & e_activeFlag);
+	b2Log("  bd.allowSleep = bool(%d);\n", Flags() & e_autoSleepFlag);
+	b2Log("  bd.awake = bool(%d);\n", Flags() & e_awakeFlag);
+	b2Log("  bd.fixedRotation = bool(%d);\n", Flags() & e_fixedRotationFlag);
+	b2Log("  bd.bullet = bool(%d);\n", Flags() & e_bulletFlag);
+	b2Log("  bd.active = bool(%d);\n", Flags() & e_activeFlag);
 	b2Log("  bd.gravityScale = %.15lef;\n", m_gravityScale);
 	b2Log("  bodies[%d] = m_world->CreateBody(&bd);\n", m_islandIndex);
 	b2Log("\n");
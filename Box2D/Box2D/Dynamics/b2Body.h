@@ -23,6 +23,7 @@
 #include <Box2D/Collision/Shapes/b2Shape.h>
 #include <memory>
 
+class b2Body;
 class b2Fixture;
 class b2Joint;
 class b2Contact;
@@ -122,6 +123,22 @@ struct b2BodyDef
 	float32 gravityScale;
 };
 
+/// The state of b2_bodyStateBlockSize bodies that every time step reads and
+/// writes, kept in one array per member. A body's state is found at
+/// m_stateIndex of its block; blocks never move, so the state keeps its
+/// address for the lifetime of the body. The owning body and its user data
+/// are kept alongside, so that loops over body ids need not touch b2Body.
+struct b2BodyStateBlock
+{
+	uint16 flags[b2_bodyStateBlockSize];
+	b2Transform transforms[b2_bodyStateBlockSize];
+	b2Sweep sweeps[b2_bodyStateBlockSize];
+	b2Vec2 linearVelocities[b2_bodyStateBlockSize];
+	float32 angularVelocities[b2_bodyStateBlockSize];
+	b2Body* bodies[b2_bodyStateBlockSize];
+	void* userData[b2_bodyStateBlockSize];
+};
+
 /// A rigid body. These are created via b2World::CreateBody.
 class b2Body
 {
@@ -373,6 +390,10 @@ public:
 	/// Get the user data pointer that was provided in the body definition.
 	void* GetUserData() const;
 
+	/// Get the id of this body's state, see b2World::GetBodyTransform.
+	/// Ids are stable while the body exists and reused after it is destroyed.
+	int32 GetId() const;
+
 	/// Set the user data. Use this to store your application specific data.
 	void SetUserData(void* data);
 
@@ -403,7 +424,7 @@ private:
 	friend class b2WeldJoint;
 	friend class b2WheelJoint;
 
-	// m_flags
+	// Flags()
 	enum
 	{
 		e_islandFlag		= 0x0001,
@@ -412,13 +433,15 @@ private:
 		e_bulletFlag		= 0x0008,
 		e_fixedRotationFlag	= 0x0010,
 		e_activeFlag		= 0x0020,
-		e_toiFlag			= 0x0040
+		e_toiFlag			= 0x0040,
+		e_movedFlag			= 0x0080
 	};
 
 	b2Body(const b2BodyDef* bd, b2World* world);
 	~b2Body();
 
 	void SynchronizeFixtures();
+	void SynchronizeSpeculativeFixtures(float32 dt);
 	void SynchronizeTransform();
 
 	// This is used to prevent connected bodies from colliding.
@@ -427,17 +450,27 @@ private:
 
 	void Advance(float32 t);
 
+	// The state touched by every step lives in the world's body state
+	// blocks, so that loops over all bodies stream through memory.
+	uint16& Flags();
+	uint16 Flags() const;
+	b2Transform& Transform();		// the body origin transform
+	const b2Transform& Transform() const;
+	b2Sweep& Sweep();		// the swept motion for CCD
+	const b2Sweep& Sweep() const;
+	b2Vec2& LinearVelocity();
+	const b2Vec2& LinearVelocity() const;
+	float32& AngularVelocity();
+	float32 AngularVelocity() const;
+
 	b2BodyType m_type;
 
-	uint16 m_flags;
+	int32 m_id;
+	b2BodyStateBlock* m_states;
+	int32 m_stateIndex;
 
 	int32 m_islandIndex;
-
-	b2Transform m_xf;		// the body origin transform
-	b2Sweep m_sweep;		// the swept motion for CCD
-
-	b2Vec2 m_linearVelocity;
-	float32 m_angularVelocity;
+	int32 m_movedIndex;
 
 	b2Vec2 m_force;
 	float32 m_torque;
@@ -462,10 +495,58 @@ private:
 	float32 m_gravityScale;
 
 	float32 m_sleepTime;
-
-	void* m_userData;
 };
 
+inline uint16& b2Body::Flags()
+{
+	return m_states->flags[m_stateIndex];
+}
+
+inline uint16 b2Body::Flags() const
+{
+	return m_states->flags[m_stateIndex];
+}
+
+inline b2Transform& b2Body::Transform()
+{
+	return m_states->transforms[m_stateIndex];
+}
+
+inline const b2Transform& b2Body::Transform() const
+{
+	return m_states->transforms[m_stateIndex];
+}
+
+inline b2Sweep& b2Body::Sweep()
+{
+	return m_states->sweeps[m_stateIndex];
+}
+
+inline const b2Sweep& b2Body::Sweep() const
+{
+	return m_states->sweeps[m_stateIndex];
+}
+
+inline b2Vec2& b2Body::LinearVelocity()
+{
+	return m_states->linearVelocities[m_stateIndex];
+}
+
+inline const b2Vec2& b2Body::LinearVelocity() const
+{
+	return m_states->linearVelocities[m_stateIndex];
+}
+
+inline float32& b2Body::AngularVelocity()
+{
+	return m_states->angularVelocities[m_stateIndex];
+}
+
+inline float32 b2Body::AngularVelocity() const
+{
+	return m_states->angularVelocities[m_stateIndex];
+}
+
 inline b2BodyType b2Body::GetType() const
 {
 	return m_type;
@@ -473,27 +554,27 @@ inline b2BodyType b2Body::GetType() const
 
 inline const b2Transform& b2Body::GetTransform() const
 {
-	return m_xf;
+	return Transform();
 }
 
 inline const b2Vec2& b2Body::GetPosition() const
 {
-	return m_xf.p;
+	return Transform().p;
 }
 
 inline float32 b2Body::GetAngle() const
 {
-	return m_sweep.a;
+	return Sweep().a;
 }
 
 inline const b2Vec2& b2Body::GetWorldCenter() const
 {
-	return m_sweep.c;
+	return Sweep().c;
 }
 
 inline const b2Vec2& b2Body::GetLocalCenter() const
 {
-	return m_sweep.localCenter;
+	return Sweep().localCenter;
 }
 
 inline void b2Body::SetLinearVelocity(const b2Vec2& v)
@@ -508,12 +589,12 @@ inline void b2Body::SetLinearVelocity(const b2Vec2& v)
 		SetAwake(true);
 	}
 
-	m_linearVelocity = v;
+	LinearVelocity() = v;
 }
 
 inline const b2Vec2& b2Body::GetLinearVelocity() const
 {
-	return m_linearVelocity;
+	return LinearVelocity();
 }
 
 inline void b2Body::SetAngularVelocity(float32 w)
@@ -528,12 +609,12 @@ inline void b2Body::SetAngularVelocity(float32 w)
 		SetAwake(true);
 	}
 
-	m_angularVelocity = w;
+	AngularVelocity() = w;
 }
 
 inline float32 b2Body::GetAngularVelocity() const
 {
-	return m_angularVelocity;
+	return AngularVelocity();
 }
 
 inline float32 b2Body::GetMass() const
@@ -543,39 +624,39 @@ inline float32 b2Body::GetMass() const
 
 inline float32 b2Body::GetInertia() const
 {
-	return m_I + m_mass * b2Dot(m_sweep.localCenter, m_sweep.localCenter);
+	return m_I + m_mass * b2Dot(Sweep().localCenter, Sweep().localCenter);
 }
 
 inline void b2Body::GetMassData(b2MassData* data) const
 {
 	data->mass = m_mass;
-	data->I = m_I + m_mass * b2Dot(m_sweep.localCenter, m_sweep.localCenter);
-	data->center = m_sweep.localCenter;
+	data->I = m_I + m_mass * b2Dot(Sweep().localCenter, Sweep().localCenter);
+	data->center = Sweep().localCenter;
 }
 
 inline b2Vec2 b2Body::GetWorldPoint(const b2Vec2& localPoint) const
 {
-	return b2Mul(m_xf, localPoint);
+	return b2Mul(Transform(), localPoint);
 }
 
 inline b2Vec2 b2Body::GetWorldVector(const b2Vec2& localVector) const
 {
-	return b2Mul(m_xf.q, localVector);
+	return b2Mul(Transform().q, localVector);
 }
 
 inline b2Vec2 b2Body::GetLocalPoint(const b2Vec2& worldPoint) const
 {
-	return b2MulT(m_xf, worldPoint);
+	return b2MulT(Transform(), worldPoint);
 }
 
 inline b2Vec2 b2Body::GetLocalVector(const b2Vec2& worldVector) const
 {
-	return b2MulT(m_xf.q, worldVector);
+	return b2MulT(Transform().q, worldVector);
 }
 
 inline b2Vec2 b2Body::GetLinearVelocityFromWorldPoint(const b2Vec2& worldPoint) const
 {
-	return m_linearVelocity + b2Cross(m_angularVelocity, worldPoint - m_sweep.c);
+	return LinearVelocity() + b2Cross(AngularVelocity(), worldPoint - Sweep().c);
 }
 
 inline b2Vec2 b2Body::GetLinearVelocityFromLocalPoint(const b2Vec2& localPoint) const
@@ -617,35 +698,35 @@ inline void b2Body::SetBullet(bool flag)
 {
 	if (flag)
 	{
-		m_flags |= e_bulletFlag;
+		Flags() |= e_bulletFlag;
 	}
 	else
 	{
-		m_flags &= ~e_bulletFlag;
+		Flags() &= ~e_bulletFlag;
 	}
 }
 
 inline bool b2Body::IsBullet() const
 {
-	return (m_flags & e_bulletFlag) == e_bulletFlag;
+	return (Flags() & e_bulletFlag) == e_bulletFlag;
 }
 
 inline void b2Body::SetAwake(bool flag)
 {
 	if (flag)
 	{
-		if ((m_flags & e_awakeFlag) == 0)
+		if ((Flags() & e_awakeFlag) == 0)
 		{
-			m_flags |= e_awakeFlag;
+			Flags() |= e_awakeFlag;
 			m_sleepTime = 0.0f;
 		}
 	}
 	else
 	{
-		m_flags &= ~e_awakeFlag;
+		Flags() &= ~e_awakeFlag;
 		m_sleepTime = 0.0f;
-		m_linearVelocity.SetZero();
-		m_angularVelocity = 0.0f;
+		LinearVelocity().SetZero();
+		AngularVelocity() = 0.0f;
 		m_force.SetZero();
 		m_torque = 0.0f;
 	}
@@ -653,35 +734,35 @@ inline void b2Body::SetAwake(bool flag)
 
 inline bool b2Body::IsAwake() const
 {
-	return (m_flags & e_awakeFlag) == e_awakeFlag;
+	return (Flags() & e_awakeFlag) == e_awakeFlag;
 }
 
 inline bool b2Body::IsActive() const
 {
-	return (m_flags & e_activeFlag) == e_activeFlag;
+	return (Flags() & e_activeFlag) == e_activeFlag;
 }
 
 inline bool b2Body::IsFixedRotation() const
 {
-	return (m_flags & e_fixedRotationFlag) == e_fixedRotationFlag;
+	return (Flags() & e_fixedRotationFlag) == e_fixedRotationFlag;
 }
 
 inline void b2Body::SetSleepingAllowed(bool flag)
 {
 	if (flag)
 	{
-		m_flags |= e_autoSleepFlag;
+		Flags() |= e_autoSleepFlag;
 	}
 	else
 	{
-		m_flags &= ~e_autoSleepFlag;
+		Flags() &= ~e_autoSleepFlag;
 		SetAwake(true);
 	}
 }
 
 inline bool b2Body::IsSleepingAllowed() const
 {
-	return (m_flags & e_autoSleepFlag) == e_autoSleepFlag;
+	return (Flags() & e_autoSleepFlag) == e_autoSleepFlag;
 }
 
 inline b2Fixture* b2Body::GetFixtureList()
@@ -726,12 +807,17 @@ inline const b2Body* b2Body::GetNext() const
 
 inline void b2Body::SetUserData(void* data)
 {
-	m_userData = data;
+	m_states->userData[m_stateIndex] = data;
 }
 
 inline void* b2Body::GetUserData() const
 {
-	return m_userData;
+	return m_states->userData[m_stateIndex];
+}
+
+inline int32 b2Body::GetId() const
+{
+	return m_id;
 }
 
 inline void b2Body::ApplyForce(const b2Vec2& force, const b2Vec2& point, bool wake)
@@ -741,16 +827,16 @@ inline void b2Body::ApplyForce(const b2Vec2& force, const b2Vec2& point, bool wa
 		return;
 	}
 
-	if (wake && (m_flags & e_awakeFlag) == 0)
+	if (wake && (Flags() & e_awakeFlag) == 0)
 	{
 		SetAwake(true);
 	}
 
 	// Don't accumulate a force if the body is sleeping.
-	if (m_flags & e_awakeFlag)
+	if (Flags() & e_awakeFlag)
 	{
 		m_force += force;
-		m_torque += b2Cross(point - m_sweep.c, force);
+		m_torque += b2Cross(point - Sweep().c, force);
 	}
 }
 
@@ -761,13 +847,13 @@ inline void b2Body::ApplyForceToCenter(const b2Vec2& force, bool wake)
 		return;
 	}
 
-	if (wake && (m_flags & e_awakeFlag) == 0)
+	if (wake && (Flags() & e_awakeFlag) == 0)
 	{
 		SetAwake(true);
 	}
 
 	// Don't accumulate a force if the body is sleeping
-	if (m_flags & e_awakeFlag)
+	if (Flags() & e_awakeFlag)
 	{
 		m_force += force;
 	}
@@ -780,13 +866,13 @@ inline void b2Body::ApplyTorque(float32 torque, bool wake)
 		return;
 	}
 
-	if (wake && (m_flags & e_awakeFlag) == 0)
+	if (wake && (Flags() & e_awakeFlag) == 0)
 	{
 		SetAwake(true);
 	}
 
 	// Don't accumulate a force if the body is sleeping
-	if (m_flags & e_awakeFlag)
+	if (Flags() & e_awakeFlag)
 	{
 		m_torque += torque;
 	}
@@ -799,16 +885,16 @@ inline void b2Body::ApplyLinearImpulse(const b2Vec2& impulse, const b2Vec2& poin
 		return;
 	}
 
-	if (wake && (m_flags & e_awakeFlag) == 0)
+	if (wake && (Flags() & e_awakeFlag) == 0)
 	{
 		SetAwake(true);
 	}
 
 	// Don't accumulate velocity if the body is sleeping
-	if (m_flags & e_awakeFlag)
+	if (Flags() & e_awakeFlag)
 	{
-		m_linearVelocity += m_invMass * impulse;
-		m_angularVelocity += m_invI * b2Cross(point - m_sweep.c, impulse);
+		LinearVelocity() += m_invMass * impulse;
+		AngularVelocity() += m_invI * b2Cross(point - Sweep().c, impulse);
 	}
 }
 
@@ -819,32 +905,32 @@ inline void b2Body::ApplyAngularImpulse(float32 impulse, bool wake)
 		return;
 	}
 
-	if (wake && (m_flags & e_awakeFlag) == 0)
+	if (wake && (Flags() & e_awakeFlag) == 0)
 	{
 		SetAwake(true);
 	}
 
 	// Don't accumulate velocity if the body is sleeping
-	if (m_flags & e_awakeFlag)
+	if (Flags() & e_awakeFlag)
 	{
-		m_angularVelocity += m_invI * impulse;
+		AngularVelocity() += m_invI * impulse;
 	}
 }
 
 inline void b2Body::SynchronizeTransform()
 {
-	m_xf.q.Set(m_sweep.a);
-	m_xf.p = m_sweep.c - b2Mul(m_xf.q, m_sweep.localCenter);
+	Transform().q.Set(Sweep().a);
+	Transform().p = Sweep().c - b2Mul(Transform().q, Sweep().localCenter);
 }
 
 inline void b2Body::Advance(float32 alpha)
 {
 	// Advance to the new safe time. This doesn't sync the broad-phase.
-	m_sweep.Advance(alpha);
-	m_sweep.c = m_sweep.c0;
-	m_sweep.a = m_sweep.a0;
-	m_xf.q.Set(m_sweep.a);
-	m_xf.p = m_sweep.c - b2Mul(m_xf.q, m_sweep.localCenter);
+	Sweep().Advance(alpha);
+	Sweep().c = Sweep().c0;
+	Sweep().a = Sweep().a0;
+	Transform().q.Set(Sweep().a);
+	Transform().p = Sweep().c - b2Mul(Transform().q, Sweep().localCenter);
 }
 
 inline b2World* b2Body::GetWorld()
@@ -21,6 +21,9 @@
 #include <Box2D/Dynamics/b2Fixture.h>
 #include <Box2D/Dynamics/b2WorldCallbacks.h>
 #include <Box2D/Dynamics/Contacts/b2Contact.h>
+#include <Box2D/Common/b2ThreadPool.h>
+
+#include <atomic>
 
 b2ContactFilter b2_defaultFilter;
 b2ContactListener b2_defaultListener;
@@ -32,6 +35,8 @@ b2ContactManager::b2ContactManager()
 	m_contactFilter = &b2_defaultFilter;
 	m_contactListener = &b2_defaultListener;
 	m_allocator = NULL;
+	m_threadPool = NULL;
+	m_speculativeTime = 0.0f;
 }
 
 void b2ContactManager::Destroy(b2Contact* c)
@@ -41,7 +46,7 @@ void b2ContactManager::Destroy(b2Contact* c)
 	b2Body* bodyA = fixtureA->GetBody();
 	b2Body* bodyB = fixtureB->GetBody();
 
-	if (m_contactListener && c->IsTouching())
+	if (m_contactListener && (c->m_flags & b2Contact::e_beginReportedFlag))
 	{
 		m_contactListener->EndContact(c);
 	}
@@ -102,71 +107,195 @@ void b2ContactManager::Destroy(b2Contact* c)
 // This is the top level collision call for the time step. Here
 // all the narrow phase collision is processed for the world
 // contact list.
-void b2ContactManager::Collide()
+// Below this many contacts the manifolds are updated on the calling thread.
+#define b2_minParallelContacts 128
+
+// The number of contacts that one thread updates at once.
+#define b2_collideBlockSize 32
+
+// Filter a contact and decide whether Collide destroys, updates or skips it.
+b2ContactManager::CollideAction b2ContactManager::GetCollideAction(b2Contact* c)
+{
+	b2Fixture* fixtureA = c->GetFixtureA();
+	b2Fixture* fixtureB = c->GetFixtureB();
+	int32 indexA = c->GetChildIndexA();
+	int32 indexB = c->GetChildIndexB();
+	b2Body* bodyA = fixtureA->GetBody();
+	b2Body* bodyB = fixtureB->GetBody();
+
+	// Is this contact flagged for filtering?
+	if (c->m_flags & b2Contact::e_filterFlag)
+	{
+		// Should these bodies collide?
+		if (bodyB->ShouldCollide(bodyA) == false)
+		{
+			return e_destroyContact;
+		}
+
+		// Check user filtering.
+		if (m_contactFilter && m_contactFilter->ShouldCollide(fixtureA, fixtureB) == false)
+		{
+			return e_destroyContact;
+		}
+
+		// Clear the filtering flag.
+		c->m_flags &= ~b2Contact::e_filterFlag;
+	}
+
+	bool activeA = bodyA->IsAwake() && bodyA->m_type != b2_staticBody;
+	bool activeB = bodyB->IsAwake() && bodyB->m_type != b2_staticBody;
+
+	// At least one body must be awake and it must be dynamic or kinematic.
+	if (activeA == false && activeB == false)
+	{
+		return e_skipContact;
+	}
+
+	int32 proxyIdA = fixtureA->m_proxies[indexA].proxyId;
+	int32 proxyIdB = fixtureB->m_proxies[indexB].proxyId;
+	bool overlap = m_broadPhase.TestOverlap(proxyIdA, proxyIdB);
+
+	// Here we destroy contacts that cease to overlap in the broad-phase.
+	if (overlap == false)
+	{
+		return e_destroyContact;
+	}
+
+	// The contact persists.
+	return e_updateContact;
+}
+
+// Updates the manifolds of a list of contacts on all threads of a pool.
+class b2CollideTask : public b2ThreadTask
 {
-	// Update awake contacts.
-	b2Contact* c = m_contactList;
-	while (c)
+public:
+	b2CollideTask(b2Contact** contacts, const int32* updates, int32 updateCount, b2Manifold* oldManifolds, bool* touching, float32 speculativeTime)
+		: m_contacts(contacts), m_updates(updates), m_updateCount(updateCount),
+		  m_oldManifolds(oldManifolds), m_touching(touching), m_speculativeTime(speculativeTime), m_next(0)
 	{
-		b2Fixture* fixtureA = c->GetFixtureA();
-		b2Fixture* fixtureB = c->GetFixtureB();
-		int32 indexA = c->GetChildIndexA();
-		int32 indexB = c->GetChildIndexB();
-		b2Body* bodyA = fixtureA->GetBody();
-		b2Body* bodyB = fixtureB->GetBody();
-		 
-		// Is this contact flagged for filtering?
-		if (c->m_flags & b2Contact::e_filterFlag)
+	}
+
+	void Execute(int32 threadIndex)
+	{
+		B2_NOT_USED(threadIndex);
+
+		for (;;)
 		{
-			// Should these bodies collide?
-			if (bodyB->ShouldCollide(bodyA) == false)
+			int32 first = m_next.fetch_add(b2_collideBlockSize);
+			if (first >= m_updateCount)
 			{
-				b2Contact* cNuke = c;
-				c = cNuke->GetNext();
-				Destroy(cNuke);
-				continue;
+				break;
 			}
 
-			// Check user filtering.
-			if (m_contactFilter && m_contactFilter->ShouldCollide(fixtureA, fixtureB) == false)
+			int32 last = b2Min(first + b2_collideBlockSize, m_updateCount);
+			for (int32 i = first; i < last; ++i)
 			{
-				b2Contact* cNuke = c;
-				c = cNuke->GetNext();
-				Destroy(cNuke);
-				continue;
+				int32 index = m_updates[i];
+				m_touching[index] = m_contacts[index]->UpdateManifold(m_oldManifolds + index, m_speculativeTime);
 			}
-
-			// Clear the filtering flag.
-			c->m_flags &= ~b2Contact::e_filterFlag;
 		}
+	}
 
-		bool activeA = bodyA->IsAwake() && bodyA->m_type != b2_staticBody;
-		bool activeB = bodyB->IsAwake() && bodyB->m_type != b2_staticBody;
+private:
+	b2Contact** m_contacts;
+	const int32* m_updates;
+	int32 m_updateCount;
+	b2Manifold* m_oldManifolds;
+	bool* m_touching;
+	float32 m_speculativeTime;
+	std::atomic<int32> m_next;
+};
 
-		// At least one body must be awake and it must be dynamic or kinematic.
-		if (activeA == false && activeB == false)
+void b2ContactManager::Collide()
+{
+	if (m_threadPool == NULL || m_threadPool->GetThreadCount() == 1 || m_contactCount < b2_minParallelContacts)
+	{
+		// Update awake contacts.
+		b2Contact* c = m_contactList;
+		while (c)
 		{
-			c = c->GetNext();
-			continue;
-		}
+			b2Contact* next = c->GetNext();
+			switch (GetCollideAction(c))
+			{
+			case e_destroyContact:
+				Destroy(c);
+				break;
 
-		int32 proxyIdA = fixtureA->m_proxies[indexA].proxyId;
-		int32 proxyIdB = fixtureB->m_proxies[indexB].proxyId;
-		bool overlap = m_broadPhase.TestOverlap(proxyIdA, proxyIdB);
+			case e_updateContact:
+				c->Update(m_contactListener, m_speculativeTime);
+				break;
 
-		// Here we destroy contacts that cease to overlap in the broad-phase.
-		if (overlap == false)
+			default:
+				break;
+			}
+			c = next;
+		}
+		return;
+	}
+
+	// Only the manifolds are updated on all threads. Destroying contacts,
+	// waking bodies and the listener callbacks follow in list order, which
+	// gives the same results and callbacks as updating one contact after another.
+	b2StackAllocator* allocator = m_threadPool->GetStackAllocator(0);
+	int32 count = m_contactCount;
+	b2Contact** contacts = (b2Contact**)allocator->Allocate(count * sizeof(b2Contact*));
+	int32* actions = (int32*)allocator->Allocate(count * sizeof(int32));
+	int32* updates = (int32*)allocator->Allocate(count * sizeof(int32));
+	b2Manifold* oldManifolds = (b2Manifold*)allocator->Allocate(count * sizeof(b2Manifold));
+	bool* touching = (bool*)allocator->Allocate(count * sizeof(bool));
+
+	int32 updateCount = 0;
+	int32 index = 0;
+	for (b2Contact* c = m_contactList; c; c = c->GetNext(), ++index)
+	{
+		contacts[index] = c;
+		actions[index] = GetCollideAction(c);
+		if (actions[index] == e_updateContact)
 		{
-			b2Contact* cNuke = c;
-			c = cNuke->GetNext();
-			Destroy(cNuke);
-			continue;
+			updates[updateCount++] = index;
 		}
+	}
+
+	b2CollideTask task(contacts, updates, updateCount, oldManifolds, touching, m_speculativeTime);
+	m_threadPool->Run(&task);
+
+	for (int32 i = 0; i < count; ++i)
+	{
+		b2Contact* c = contacts[i];
+		switch (actions[i])
+		{
+		case e_destroyContact:
+			Destroy(c);
+			break;
 
-		// The contact persists.
-		c->Update(m_contactListener);
-		c = c->GetNext();
+		case e_updateContact:
+			c->UpdateState(touching[i], oldManifolds + i, m_contactListener);
+			break;
+
+		default:
+			// An earlier contact may have woken one of the bodies since.
+			switch (GetCollideAction(c))
+			{
+			case e_destroyContact:
+				Destroy(c);
+				break;
+
+			case e_updateContact:
+				c->Update(m_contactListener, m_speculativeTime);
+				break;
+
+			default:
+				break;
+			}
+			break;
+		}
 	}
+
+	allocator->Free(touching);
+	allocator->Free(oldManifolds);
+	allocator->Free(updates);
+	allocator->Free(actions);
+	allocator->Free(contacts);
 }
 
 void b2ContactManager::FindNewContacts()
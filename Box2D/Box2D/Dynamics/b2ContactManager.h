@@ -25,6 +25,7 @@ class b2Contact;
 class b2ContactFilter;
 class b2ContactListener;
 class b2BlockAllocator;
+class b2ThreadPool;
 
 // Delegate of b2World.
 class b2ContactManager
@@ -47,6 +48,18 @@ public:
 	b2ContactFilter* m_contactFilter;
 	b2ContactListener* m_contactListener;
 	b2BlockAllocator* m_allocator;
+	b2ThreadPool* m_threadPool;
+	float32 m_speculativeTime;	///< see b2Contact::UpdateManifold
+
+private:
+	enum CollideAction
+	{
+		e_skipContact,
+		e_destroyContact,
+		e_updateContact
+	};
+
+	CollideAction GetCollideAction(b2Contact* c);
 };
 
 #endif
@@ -23,6 +23,7 @@
 #include <Box2D/Collision/Shapes/b2EdgeShape.h>
 #include <Box2D/Collision/Shapes/b2PolygonShape.h>
 #include <Box2D/Collision/Shapes/b2ChainShape.h>
+#include <Box2D/Collision/Shapes/b2CapsuleShape.h>
 #include <Box2D/Collision/b2BroadPhase.h>
 #include <Box2D/Collision/b2Collision.h>
 #include <Box2D/Common/b2BlockAllocator.h>
@@ -111,6 +112,14 @@ void b2Fixture::Destroy(b2BlockAllocator* allocator)
 		}
 		break;
 
+	case b2Shape::e_capsule:
+		{
+			b2CapsuleShape* s = (b2CapsuleShape*)m_shape;
+			s->~b2CapsuleShape();
+			allocator->Free(s, sizeof(b2CapsuleShape));
+		}
+		break;
+
 	default:
 		b2Assert(false);
 		break;
@@ -125,12 +134,13 @@ void b2Fixture::CreateProxies(b2BroadPhase* broadPhase, const b2Transform& xf)
 
 	// Create proxies in the broad-phase.
 	m_proxyCount = m_shape->GetChildCount();
+	bool isStatic = m_body->GetType() == b2_staticBody;
 
 	for (int32 i = 0; i < m_proxyCount; ++i)
 	{
 		b2FixtureProxy* proxy = m_proxies + i;
 		m_shape->ComputeAABB(&proxy->aabb, xf, i);
-		proxy->proxyId = broadPhase->CreateProxy(proxy->aabb, proxy);
+		proxy->proxyId = broadPhase->CreateProxy(proxy->aabb, proxy, isStatic);
 		proxy->fixture = this;
 		proxy->childIndex = i;
 	}
@@ -173,6 +183,23 @@ void b2Fixture::Synchronize(b2BroadPhase* broadPhase, const b2Transform& transfo
 	}
 }
 
+void b2Fixture::SynchronizeSpeculative(b2BroadPhase* broadPhase, const b2Transform& xf, float32 distance)
+{
+	// Cover every position within the distance, in whatever direction the
+	// body is deflected during the next step (may miss some rotation effect).
+	b2Vec2 r(distance, distance);
+	for (int32 i = 0; i < m_proxyCount; ++i)
+	{
+		b2FixtureProxy* proxy = m_proxies + i;
+
+		m_shape->ComputeAABB(&proxy->aabb, xf, proxy->childIndex);
+		proxy->aabb.lowerBound -= r;
+		proxy->aabb.upperBound += r;
+
+		broadPhase->MoveProxy(proxy->proxyId, proxy->aabb, b2Vec2_zero);
+	}
+}
+
 void b2Fixture::SetFilterData(const b2Filter& filter)
 {
 	m_filter = filter;
@@ -292,6 +319,16 @@ void b2Fixture::Dump(int32 bodyIndex)
 		}
 		break;
 
+	case b2Shape::e_capsule:
+		{
+			b2CapsuleShape* s = (b2CapsuleShape*)m_shape;
+			b2Log("    b2CapsuleShape shape;\n");
+			b2Log("    shape.m_radius = %.15lef;\n", s->m_radius);
+			b2Log("    shape.m_vertex1.Set(%.15lef, %.15lef);\n", s->m_vertex1.x, s->m_vertex1.y);
+			b2Log("    shape.m_vertex2.Set(%.15lef, %.15lef);\n", s->m_vertex2.x, s->m_vertex2.y);
+		}
+		break;
+
 	default:
 		return;
 	}
@@ -214,6 +214,7 @@ protected:
 	void DestroyProxies(b2BroadPhase* broadPhase);
 
 	void Synchronize(b2BroadPhase* broadPhase, const b2Transform& xf1, const b2Transform& xf2);
+	void SynchronizeSpeculative(b2BroadPhase* broadPhase, const b2Transform& xf, float32 distance);
 
 	float32 m_density;
 
@@ -161,6 +161,10 @@ b2Island::b2Island(
 
 	m_allocator = allocator;
 	m_listener = listener;
+	m_contactIndices = NULL;
+	m_impulses = NULL;
+	m_useColors = false;
+	m_threadPool = NULL;
 
 	m_bodies = (b2Body**)m_allocator->Allocate(bodyCapacity * sizeof(b2Body*));
 	m_contacts = (b2Contact**)m_allocator->Allocate(contactCapacity	 * sizeof(b2Contact*));
@@ -180,7 +184,7 @@ b2Island::~b2Island()
 	m_allocator->Free(m_bodies);
 }
 
-void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& gravity, bool allowSleep)
+bool b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& gravity, bool allowSleep)
 {
 	b2Timer timer;
 
@@ -191,14 +195,18 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 	{
 		b2Body* b = m_bodies[i];
 
-		b2Vec2 c = b->m_sweep.c;
-		float32 a = b->m_sweep.a;
-		b2Vec2 v = b->m_linearVelocity;
-		float32 w = b->m_angularVelocity;
+		b2Vec2 c = b->Sweep().c;
+		float32 a = b->Sweep().a;
+		b2Vec2 v = b->LinearVelocity();
+		float32 w = b->AngularVelocity();
 
 		// Store positions for continuous collision.
-		b->m_sweep.c0 = b->m_sweep.c;
-		b->m_sweep.a0 = b->m_sweep.a;
+		// Static bodies never move, so they are left untouched.
+		if (b->m_type != b2_staticBody)
+		{
+			b->Sweep().c0 = b->Sweep().c;
+			b->Sweep().a0 = b->Sweep().a;
+		}
 
 		if (b->m_type == b2_dynamicBody)
 		{
@@ -236,9 +244,12 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 	contactSolverDef.step = step;
 	contactSolverDef.contacts = m_contacts;
 	contactSolverDef.count = m_contactCount;
+	contactSolverDef.indices = m_contactIndices;
 	contactSolverDef.positions = m_positions;
 	contactSolverDef.velocities = m_velocities;
 	contactSolverDef.allocator = m_allocator;
+	contactSolverDef.threadPool = m_threadPool;
+	contactSolverDef.useColors = m_useColors && m_jointCount == 0;
 
 	b2ContactSolver contactSolver(&contactSolverDef);
 	contactSolver.InitializeVelocityConstraints();
@@ -257,14 +268,21 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 
 	// Solve velocity constraints
 	timer.Reset();
-	for (int32 i = 0; i < step.velocityIterations; ++i)
+	if (contactSolver.IsColored())
 	{
-		for (int32 j = 0; j < m_jointCount; ++j)
+		contactSolver.SolveColoredVelocityConstraints(step.velocityIterations);
+	}
+	else
+	{
+		for (int32 i = 0; i < step.velocityIterations; ++i)
 		{
-			m_joints[j]->SolveVelocityConstraints(solverData);
-		}
+			for (int32 j = 0; j < m_jointCount; ++j)
+			{
+				m_joints[j]->SolveVelocityConstraints(solverData);
+			}
 
-		contactSolver.SolveVelocityConstraints();
+			contactSolver.SolveVelocityConstraints();
+		}
 	}
 
 	// Store impulses for warm starting
@@ -304,25 +322,34 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 		m_velocities[i].w = w;
 	}
 
+	contactSolver.ApplyRestitution();
+
 	// Solve position constraints
 	timer.Reset();
 	bool positionSolved = false;
-	for (int32 i = 0; i < step.positionIterations; ++i)
+	if (contactSolver.IsColored())
 	{
-		bool contactsOkay = contactSolver.SolvePositionConstraints();
-
-		bool jointsOkay = true;
-		for (int32 i = 0; i < m_jointCount; ++i)
+		positionSolved = contactSolver.SolveColoredPositionConstraints(step.positionIterations);
+	}
+	else
+	{
+		for (int32 i = 0; i < step.positionIterations; ++i)
 		{
-			bool jointOkay = m_joints[i]->SolvePositionConstraints(solverData);
-			jointsOkay = jointsOkay && jointOkay;
-		}
+			bool contactsOkay = contactSolver.SolvePositionConstraints();
 
-		if (contactsOkay && jointsOkay)
-		{
-			// Exit early if the position errors are small.
-			positionSolved = true;
-			break;
+			bool jointsOkay = true;
+			for (int32 i = 0; i < m_jointCount; ++i)
+			{
+				bool jointOkay = m_joints[i]->SolvePositionConstraints(solverData);
+				jointsOkay = jointsOkay && jointOkay;
+			}
+
+			if (contactsOkay && jointsOkay)
+			{
+				// Exit early if the position errors are small.
+				positionSolved = true;
+				break;
+			}
 		}
 	}
 
@@ -330,10 +357,15 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 	for (int32 i = 0; i < m_bodyCount; ++i)
 	{
 		b2Body* body = m_bodies[i];
-		body->m_sweep.c = m_positions[i].c;
-		body->m_sweep.a = m_positions[i].a;
-		body->m_linearVelocity = m_velocities[i].v;
-		body->m_angularVelocity = m_velocities[i].w;
+		if (body->m_type == b2_staticBody)
+		{
+			continue;
+		}
+
+		body->Sweep().c = m_positions[i].c;
+		body->Sweep().a = m_positions[i].a;
+		body->LinearVelocity() = m_velocities[i].v;
+		body->AngularVelocity() = m_velocities[i].w;
 		body->SynchronizeTransform();
 	}
 
@@ -341,6 +373,7 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 
 	Report(contactSolver.m_velocityConstraints);
 
+	bool sleep = false;
 	if (allowSleep)
 	{
 		float32 minSleepTime = b2_maxFloat;
@@ -356,9 +389,9 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 				continue;
 			}
 
-			if ((b->m_flags & b2Body::e_autoSleepFlag) == 0 ||
-				b->m_angularVelocity * b->m_angularVelocity > angTolSqr ||
-				b2Dot(b->m_linearVelocity, b->m_linearVelocity) > linTolSqr)
+			if ((b->Flags() & b2Body::e_autoSleepFlag) == 0 ||
+				b->AngularVelocity() * b->AngularVelocity() > angTolSqr ||
+				b2Dot(b->LinearVelocity(), b->LinearVelocity()) > linTolSqr)
 			{
 				b->m_sleepTime = 0.0f;
 				minSleepTime = 0.0f;
@@ -370,15 +403,10 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 			}
 		}
 
-		if (minSleepTime >= b2_timeToSleep && positionSolved)
-		{
-			for (int32 i = 0; i < m_bodyCount; ++i)
-			{
-				b2Body* b = m_bodies[i];
-				b->SetAwake(false);
-			}
-		}
+		sleep = minSleepTime >= b2_timeToSleep && positionSolved;
 	}
+
+	return sleep;
 }
 
 void b2Island::SolveTOI(const b2TimeStep& subStep, int32 toiIndexA, int32 toiIndexB)
@@ -390,19 +418,22 @@ void b2Island::SolveTOI(const b2TimeStep& subStep, int32 toiIndexA, int32 toiInd
 	for (int32 i = 0; i < m_bodyCount; ++i)
 	{
 		b2Body* b = m_bodies[i];
-		m_positions[i].c = b->m_sweep.c;
-		m_positions[i].a = b->m_sweep.a;
-		m_velocities[i].v = b->m_linearVelocity;
-		m_velocities[i].w = b->m_angularVelocity;
+		m_positions[i].c = b->Sweep().c;
+		m_positions[i].a = b->Sweep().a;
+		m_velocities[i].v = b->LinearVelocity();
+		m_velocities[i].w = b->AngularVelocity();
 	}
 
 	b2ContactSolverDef contactSolverDef;
 	contactSolverDef.contacts = m_contacts;
 	contactSolverDef.count = m_contactCount;
+	contactSolverDef.indices = NULL;
 	contactSolverDef.allocator = m_allocator;
 	contactSolverDef.step = subStep;
 	contactSolverDef.positions = m_positions;
 	contactSolverDef.velocities = m_velocities;
+	contactSolverDef.threadPool = NULL;
+	contactSolverDef.useColors = false;
 	b2ContactSolver contactSolver(&contactSolverDef);
 
 	// Solve position constraints.
@@ -449,10 +480,10 @@ void b2Island::SolveTOI(const b2TimeStep& subStep, int32 toiIndexA, int32 toiInd
 #endif
 
 	// Leap of faith to new safe state.
-	m_bodies[toiIndexA]->m_sweep.c0 = m_positions[toiIndexA].c;
-	m_bodies[toiIndexA]->m_sweep.a0 = m_positions[toiIndexA].a;
-	m_bodies[toiIndexB]->m_sweep.c0 = m_positions[toiIndexB].c;
-	m_bodies[toiIndexB]->m_sweep.a0 = m_positions[toiIndexB].a;
+	m_bodies[toiIndexA]->Sweep().c0 = m_positions[toiIndexA].c;
+	m_bodies[toiIndexA]->Sweep().a0 = m_positions[toiIndexA].a;
+	m_bodies[toiIndexB]->Sweep().c0 = m_positions[toiIndexB].c;
+	m_bodies[toiIndexB]->Sweep().a0 = m_positions[toiIndexB].a;
 
 	// No warm starting is needed for TOI events because warm
 	// starting impulses were applied in the discrete solver.
@@ -503,10 +534,10 @@ void b2Island::SolveTOI(const b2TimeStep& subStep, int32 toiIndexA, int32 toiInd
 
 		// Sync bodies
 		b2Body* body = m_bodies[i];
-		body->m_sweep.c = c;
-		body->m_sweep.a = a;
-		body->m_linearVelocity = v;
-		body->m_angularVelocity = w;
+		body->Sweep().c = c;
+		body->Sweep().a = a;
+		body->LinearVelocity() = v;
+		body->AngularVelocity() = w;
 		body->SynchronizeTransform();
 	}
 
@@ -515,7 +546,7 @@ void b2Island::SolveTOI(const b2TimeStep& subStep, int32 toiIndexA, int32 toiInd
 
 void b2Island::Report(const b2ContactVelocityConstraint* constraints)
 {
-	if (m_listener == NULL)
+	if (m_listener == NULL && m_impulses == NULL)
 	{
 		return;
 	}
@@ -534,6 +565,18 @@ void b2Island::Report(const b2ContactVelocityConstraint* constraints)
 			impulse.tangentImpulses[j] = vc->points[j].tangentImpulse;
 		}
 
-		m_listener->PostSolve(c, &impulse);
+		if (m_impulses != NULL)
+		{
+			m_impulses[i] = impulse;
+		}
+		else if ((c->m_flags & b2Contact::e_speculativePointFlag) && impulse.normalImpulses[0] == 0.0f)
+		{
+			// The bullet did not reach the shape in this step.
+			continue;
+		}
+		else
+		{
+			m_listener->PostSolve(c, &impulse);
+		}
 	}
 }
@@ -26,8 +26,10 @@
 class b2Contact;
 class b2Joint;
 class b2StackAllocator;
+class b2ThreadPool;
 class b2ContactListener;
 struct b2ContactVelocityConstraint;
+struct b2ContactImpulse;
 struct b2Profile;
 
 /// This is an internal class.
@@ -45,7 +47,10 @@ public:
 		m_jointCount = 0;
 	}
 
-	void Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& gravity, bool allowSleep);
+	/// Solve the island. Static bodies are only read, so islands that share them
+	/// can be solved concurrently if m_contactIndices is set.
+	/// @return true if the island has come to rest and may be put to sleep.
+	bool Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& gravity, bool allowSleep);
 
 	void SolveTOI(const b2TimeStep& subStep, int32 toiIndexA, int32 toiIndexB);
 
@@ -88,6 +93,20 @@ public:
 	int32 m_bodyCapacity;
 	int32 m_contactCapacity;
 	int32 m_jointCapacity;
+
+	/// Island indices of the two bodies of each contact. If NULL, the
+	/// indices are taken from the bodies, which requires that no other
+	/// island using the same static bodies has been built in the meantime.
+	const int32* m_contactIndices;
+
+	/// If not NULL, Report stores the impulses of each contact here
+	/// instead of passing them to the listener.
+	b2ContactImpulse* m_impulses;
+
+	/// Solve the contacts of an island without joints in graph colors,
+	/// on the threads of m_threadPool if it is not NULL.
+	bool m_useColors;
+	b2ThreadPool* m_threadPool;
 };
 
 #endif
@@ -29,9 +29,13 @@
 #include <Box2D/Collision/Shapes/b2EdgeShape.h>
 #include <Box2D/Collision/Shapes/b2ChainShape.h>
 #include <Box2D/Collision/Shapes/b2PolygonShape.h>
+#include <Box2D/Collision/Shapes/b2CapsuleShape.h>
 #include <Box2D/Collision/b2TimeOfImpact.h>
 #include <Box2D/Common/b2Draw.h>
 #include <Box2D/Common/b2Timer.h>
+#include <Box2D/Common/b2ThreadPool.h>
+#include <algorithm>
+#include <atomic>
 #include <new>
 
 b2World::b2World(const b2Vec2& gravity)
@@ -45,9 +49,21 @@ b2World::b2World(const b2Vec2& gravity)
 	m_bodyCount = 0;
 	m_jointCount = 0;
 
+	m_bodyStateBlocks = NULL;
+	m_bodyStateBlockCount = 0;
+	m_bodyStateBlockCapacity = 0;
+	m_bodyStateCount = 0;
+
+	m_movedBodies = NULL;
+	m_movedBodyCount = 0;
+	m_movedBodyCapacity = 0;
+
 	m_warmStarting = true;
 	m_continuousPhysics = true;
 	m_subStepping = false;
+	m_speculativeBullets = false;
+	m_deterministic = false;
+	m_abandonMemory = false;
 
 	m_stepComplete = true;
 
@@ -60,11 +76,23 @@ b2World::b2World(const b2Vec2& gravity)
 
 	m_contactManager.m_allocator = &m_blockAllocator;
 
+	void* mem = b2Alloc(sizeof(b2ThreadPool));
+	m_threadPool = new (mem) b2ThreadPool(1);
+	m_contactManager.m_threadPool = m_threadPool;
+
 	memset(&m_profile, 0, sizeof(b2Profile));
 }
 
 b2World::~b2World()
 {
+	if (m_abandonMemory)
+	{
+		// The allocator owns everything and is about to drop it at once.
+		m_blockAllocator.Abandon();
+		m_threadPool->~b2ThreadPool();
+		return;
+	}
+
 	// Some shapes allocate using b2Alloc.
 	b2Body* b = m_bodyList;
 	while (b)
@@ -82,6 +110,16 @@ b2World::~b2World()
 
 		b = bNext;
 	}
+
+	for (int32 i = 0; i < m_bodyStateBlockCount; ++i)
+	{
+		b2Free(m_bodyStateBlocks[i]);
+	}
+	b2Free(m_bodyStateBlocks);
+	b2Free(m_movedBodies);
+
+	m_threadPool->~b2ThreadPool();
+	b2Free(m_threadPool);
 }
 
 void b2World::SetDestructionListener(b2DestructionListener* listener)
@@ -205,10 +243,105 @@ void b2World::DestroyBody(b2Body* b)
 	}
 
 	--m_bodyCount;
+	RemoveMovedBody(b);
+	DestroyBodyState(b);
 	b->~b2Body();
 	m_blockAllocator.Free(b, sizeof(b2Body));
 }
 
+void b2World::CreateBodyState(b2Body* body)
+{
+	int32 id;
+	if (m_freeBodyStates.GetCount() > 0)
+	{
+		id = m_freeBodyStates.Pop();
+	}
+	else
+	{
+		id = m_bodyStateCount++;
+		if (id == m_bodyStateBlockCount * b2_bodyStateBlockSize)
+		{
+			if (m_bodyStateBlockCount == m_bodyStateBlockCapacity)
+			{
+				b2BodyStateBlock** oldBlocks = m_bodyStateBlocks;
+				m_bodyStateBlockCapacity = b2Max(2 * m_bodyStateBlockCapacity, 4);
+				m_bodyStateBlocks = (b2BodyStateBlock**)b2Alloc(m_bodyStateBlockCapacity * sizeof(b2BodyStateBlock*));
+				if (oldBlocks)
+				{
+					memcpy(m_bodyStateBlocks, oldBlocks, m_bodyStateBlockCount * sizeof(b2BodyStateBlock*));
+					b2Free(oldBlocks);
+				}
+			}
+
+			void* mem = b2Alloc(sizeof(b2BodyStateBlock));
+			b2BodyStateBlock* block = new (mem) b2BodyStateBlock;
+			memset(block->flags, 0, sizeof(block->flags));
+			m_bodyStateBlocks[m_bodyStateBlockCount++] = block;
+		}
+	}
+
+	body->m_id = id;
+	body->m_states = m_bodyStateBlocks[id / b2_bodyStateBlockSize];
+	body->m_stateIndex = id % b2_bodyStateBlockSize;
+	body->m_states->bodies[body->m_stateIndex] = body;
+}
+
+void b2World::DestroyBodyState(b2Body* body)
+{
+	// Loops over all states rely on free slots having no flags set.
+	body->Flags() = 0;
+	body->m_states->bodies[body->m_stateIndex] = NULL;
+	body->m_states->userData[body->m_stateIndex] = NULL;
+	m_freeBodyStates.Push(body->m_id);
+}
+
+void b2World::AddMovedBody(b2Body* body)
+{
+	if (body->Flags() & b2Body::e_movedFlag)
+	{
+		return;
+	}
+
+	if (m_movedBodyCount == m_movedBodyCapacity)
+	{
+		int32* oldBodies = m_movedBodies;
+		m_movedBodyCapacity = b2Max(2 * m_movedBodyCapacity, 64);
+		m_movedBodies = (int32*)b2Alloc(m_movedBodyCapacity * sizeof(int32));
+		if (oldBodies)
+		{
+			memcpy(m_movedBodies, oldBodies, m_movedBodyCount * sizeof(int32));
+			b2Free(oldBodies);
+		}
+	}
+
+	body->Flags() |= b2Body::e_movedFlag;
+	body->m_movedIndex = m_movedBodyCount;
+	m_movedBodies[m_movedBodyCount++] = body->m_id;
+}
+
+void b2World::RemoveMovedBody(b2Body* body)
+{
+	if ((body->Flags() & b2Body::e_movedFlag) == 0)
+	{
+		return;
+	}
+
+	int32 last = m_movedBodies[--m_movedBodyCount];
+	m_movedBodies[body->m_movedIndex] = last;
+	GetBody(last)->m_movedIndex = body->m_movedIndex;
+	body->Flags() &= ~b2Body::e_movedFlag;
+}
+
+void b2World::ClearMovedBodies()
+{
+	for (int32 i = 0; i < m_movedBodyCount; ++i)
+	{
+		int32 id = m_movedBodies[i];
+		m_bodyStateBlocks[id / b2_bodyStateBlockSize]->flags[id % b2_bodyStateBlockSize] &= ~b2Body::e_movedFlag;
+	}
+	m_movedBodyCount = 0;
+}
+
 b2Joint* b2World::CreateJoint(const b2JointDef* def)
 {
 	b2Assert(IsLocked() == false);
@@ -382,6 +515,143 @@ void b2World::SetAllowSleeping(bool flag)
 	}
 }
 
+void b2World::SetThreadCount(int32 count)
+{
+	b2Assert(IsLocked() == false);
+	count = b2Max(count, 1);
+	if (IsLocked() || count == m_threadPool->GetThreadCount())
+	{
+		return;
+	}
+
+	m_threadPool->~b2ThreadPool();
+	m_threadPool = new (m_threadPool) b2ThreadPool(count);
+}
+
+int32 b2World::GetThreadCount() const
+{
+	return m_threadPool->GetThreadCount();
+}
+
+// An island as ranges of the buffers filled by b2World::Solve,
+// plus the results of solving it.
+struct b2IslandRange
+{
+	int32 bodyStart;
+	int32 bodyCount;
+	int32 contactStart;
+	int32 contactCount;
+	int32 jointStart;
+	int32 jointCount;
+	bool sleep;
+	b2Profile profile;
+};
+
+struct b2IslandBuffers
+{
+	b2Body** bodies;
+	b2Contact** contacts;
+	int32* contactIndices;
+	b2Joint** joints;
+	b2ContactImpulse* impulses;
+	b2IslandRange* islands;
+};
+
+// Islands without joints that have at least this many contacts are solved
+// in graph colors by all threads together.
+#define b2_minColoredContacts 128
+
+// Solve an island, keeping its results in its range. Joints take the island indices
+// from their bodies, so islands with joints must not be solved concurrently.
+// If colorPool is not NULL, the contacts are solved in graph colors on its threads.
+static void b2SolveIsland(const b2IslandBuffers& buffers, b2IslandRange* range, const b2TimeStep& step,
+						  const b2Vec2& gravity, bool allowSleep, b2StackAllocator* allocator,
+						  b2ThreadPool* colorPool)
+{
+	b2Island island(range->bodyCount, range->contactCount, range->jointCount, allocator, NULL);
+	island.m_useColors = colorPool != NULL;
+	island.m_threadPool = colorPool;
+
+	if (range->jointCount > 0)
+	{
+		for (int32 i = 0; i < range->bodyCount; ++i)
+		{
+			island.Add(buffers.bodies[range->bodyStart + i]);
+		}
+	}
+	else
+	{
+		memcpy(island.m_bodies, buffers.bodies + range->bodyStart, range->bodyCount * sizeof(b2Body*));
+		island.m_bodyCount = range->bodyCount;
+	}
+
+	memcpy(island.m_contacts, buffers.contacts + range->contactStart, range->contactCount * sizeof(b2Contact*));
+	island.m_contactCount = range->contactCount;
+	memcpy(island.m_joints, buffers.joints + range->jointStart, range->jointCount * sizeof(b2Joint*));
+	island.m_jointCount = range->jointCount;
+
+	island.m_contactIndices = buffers.contactIndices + 2 * range->contactStart;
+	if (buffers.impulses != NULL)
+	{
+		island.m_impulses = buffers.impulses + range->contactStart;
+	}
+
+	range->sleep = island.Solve(&range->profile, step, gravity, allowSleep);
+}
+
+// Solves the islands of a job list on all threads of the pool.
+class b2SolveIslandsTask : public b2ThreadTask
+{
+public:
+	b2SolveIslandsTask(b2ThreadPool* threadPool, const b2IslandBuffers& buffers, const int32* jobs, int32 jobCount,
+					   const b2TimeStep& step, const b2Vec2& gravity, bool allowSleep)
+		: m_threadPool(threadPool), m_buffers(buffers), m_jobs(jobs), m_jobCount(jobCount),
+		  m_step(step), m_gravity(gravity), m_allowSleep(allowSleep), m_next(0)
+	{
+	}
+
+	void Execute(int32 threadIndex)
+	{
+		b2StackAllocator* allocator = m_threadPool->GetStackAllocator(threadIndex);
+		for (;;)
+		{
+			int32 job = m_next++;
+			if (job >= m_jobCount)
+			{
+				break;
+			}
+
+			b2SolveIsland(m_buffers, m_buffers.islands + m_jobs[job], m_step, m_gravity, m_allowSleep, allocator, NULL);
+		}
+	}
+
+private:
+	b2ThreadPool* m_threadPool;
+	const b2IslandBuffers& m_buffers;
+	const int32* m_jobs;
+	int32 m_jobCount;
+	const b2TimeStep& m_step;
+	const b2Vec2& m_gravity;
+	bool m_allowSleep;
+	std::atomic<int32> m_next;
+};
+
+// Orders island jobs by decreasing size, so that the big islands
+// do not end up last on a single thread.
+struct b2IslandLarger
+{
+	b2IslandLarger(const b2IslandRange* islands) : m_islands(islands) {}
+
+	bool operator()(int32 a, int32 b) const
+	{
+		int32 sizeA = m_islands[a].bodyCount + m_islands[a].contactCount;
+		int32 sizeB = m_islands[b].bodyCount + m_islands[b].contactCount;
+		return sizeA > sizeB || (sizeA == sizeB && a < b);
+	}
+
+	const b2IslandRange* m_islands;
+};
+
 // Find islands, integrate and solve constraints, solve position constraints
 void b2World::Solve(const b2TimeStep& step)
 {
@@ -397,9 +667,13 @@ void b2World::Solve(const b2TimeStep& step)
 					m_contactManager.m_contactListener);
 
 	// Clear all the island flags.
-	for (b2Body* b = m_bodyList; b; b = b->m_next)
+	for (int32 i = 0; i < m_bodyStateBlockCount; ++i)
 	{
-		b->m_flags &= ~b2Body::e_islandFlag;
+		uint16* flags = m_bodyStateBlocks[i]->flags;
+		for (int32 j = 0; j < b2_bodyStateBlockSize; ++j)
+		{
+			flags[j] &= ~b2Body::e_islandFlag;
+		}
 	}
 	for (b2Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
 	{
@@ -410,12 +684,32 @@ void b2World::Solve(const b2TimeStep& step)
 		j->m_islandFlag = false;
 	}
 
-	// Build and simulate all awake islands.
+	// Collect all awake islands first. A static body joins every island it
+	// touches, so there are at most as many static entries as contacts and joints.
+	int32 contactCount = m_contactManager.m_contactCount;
+	b2IslandBuffers buffers;
+	buffers.bodies = (b2Body**)m_stackAllocator.Allocate((m_bodyCount + contactCount + m_jointCount) * sizeof(b2Body*));
+	buffers.contacts = (b2Contact**)m_stackAllocator.Allocate(contactCount * sizeof(b2Contact*));
+	buffers.contactIndices = (int32*)m_stackAllocator.Allocate(2 * contactCount * sizeof(int32));
+	buffers.joints = (b2Joint**)m_stackAllocator.Allocate(m_jointCount * sizeof(b2Joint*));
+	buffers.islands = (b2IslandRange*)m_stackAllocator.Allocate(m_bodyCount * sizeof(b2IslandRange));
+	buffers.impulses = NULL;
+	b2ContactListener* listener = m_contactManager.m_contactListener;
+	if (listener != NULL)
+	{
+		buffers.impulses = (b2ContactImpulse*)m_stackAllocator.Allocate(contactCount * sizeof(b2ContactImpulse));
+	}
+
+	int32 islandCount = 0;
+	int32 bodyStart = 0;
+	int32 contactStart = 0;
+	int32 jointStart = 0;
+
 	int32 stackSize = m_bodyCount;
 	b2Body** stack = (b2Body**)m_stackAllocator.Allocate(stackSize * sizeof(b2Body*));
 	for (b2Body* seed = m_bodyList; seed; seed = seed->m_next)
 	{
-		if (seed->m_flags & b2Body::e_islandFlag)
+		if (seed->Flags() & b2Body::e_islandFlag)
 		{
 			continue;
 		}
@@ -435,7 +729,7 @@ void b2World::Solve(const b2TimeStep& step)
 		island.Clear();
 		int32 stackCount = 0;
 		stack[stackCount++] = seed;
-		seed->m_flags |= b2Body::e_islandFlag;
+		seed->Flags() |= b2Body::e_islandFlag;
 
 		// Perform a depth first search (DFS) on the constraint graph.
 		while (stackCount > 0)
@@ -487,14 +781,14 @@ void b2World::Solve(const b2TimeStep& step)
 				b2Body* other = ce->other;
 
 				// Was the other body already added to this island?
-				if (other->m_flags & b2Body::e_islandFlag)
+				if (other->Flags() & b2Body::e_islandFlag)
 				{
 					continue;
 				}
 
 				b2Assert(stackCount < stackSize);
 				stack[stackCount++] = other;
-				other->m_flags |= b2Body::e_islandFlag;
+				other->Flags() |= b2Body::e_islandFlag;
 			}
 
 			// Search all joints connect to this body.
@@ -516,44 +810,144 @@ void b2World::Solve(const b2TimeStep& step)
 				island.Add(je->joint);
 				je->joint->m_islandFlag = true;
 
-				if (other->m_flags & b2Body::e_islandFlag)
+				if (other->Flags() & b2Body::e_islandFlag)
 				{
 					continue;
 				}
 
 				b2Assert(stackCount < stackSize);
 				stack[stackCount++] = other;
-				other->m_flags |= b2Body::e_islandFlag;
+				other->Flags() |= b2Body::e_islandFlag;
 			}
 		}
 
-		b2Profile profile;
-		island.Solve(&profile, step, m_gravity, m_allowSleep);
-		m_profile.solveInit += profile.solveInit;
-		m_profile.solveVelocity += profile.solveVelocity;
-		m_profile.solvePosition += profile.solvePosition;
+		b2IslandRange* range = buffers.islands + islandCount;
+		++islandCount;
+		range->bodyStart = bodyStart;
+		range->bodyCount = island.m_bodyCount;
+		range->contactStart = contactStart;
+		range->contactCount = island.m_contactCount;
+		range->jointStart = jointStart;
+		range->jointCount = island.m_jointCount;
+		range->sleep = false;
+		range->profile.solveInit = 0.0f;
+		range->profile.solveVelocity = 0.0f;
+		range->profile.solvePosition = 0.0f;
+
+		memcpy(buffers.bodies + bodyStart, island.m_bodies, island.m_bodyCount * sizeof(b2Body*));
+		memcpy(buffers.contacts + contactStart, island.m_contacts, island.m_contactCount * sizeof(b2Contact*));
+		memcpy(buffers.joints + jointStart, island.m_joints, island.m_jointCount * sizeof(b2Joint*));
+
+		// The island indices of static bodies are overwritten by the next island
+		// that touches them, so the contacts keep their own copy.
+		for (int32 i = 0; i < island.m_contactCount; ++i)
+		{
+			b2Contact* contact = island.m_contacts[i];
+			buffers.contactIndices[2 * (contactStart + i) + 0] = contact->m_fixtureA->m_body->m_islandIndex;
+			buffers.contactIndices[2 * (contactStart + i) + 1] = contact->m_fixtureB->m_body->m_islandIndex;
+		}
+
+		bodyStart += island.m_bodyCount;
+		contactStart += island.m_contactCount;
+		jointStart += island.m_jointCount;
 
-		// Post solve cleanup.
 		for (int32 i = 0; i < island.m_bodyCount; ++i)
 		{
 			// Allow static bodies to participate in other islands.
 			b2Body* b = island.m_bodies[i];
 			if (b->GetType() == b2_staticBody)
 			{
-				b->m_flags &= ~b2Body::e_islandFlag;
+				b->Flags() &= ~b2Body::e_islandFlag;
 			}
 		}
 	}
 
 	m_stackAllocator.Free(stack);
 
+	// Islands without joints share nothing but read-only static bodies,
+	// so they are solved on all threads of the pool. Large islands are
+	// instead solved one after another, each on all threads.
+	bool useColors = m_deterministic || m_threadPool->GetThreadCount() > 1;
+	int32* jobs = (int32*)m_stackAllocator.Allocate(islandCount * sizeof(int32));
+	int32 jobCount = 0;
+	for (int32 i = 0; i < islandCount; ++i)
+	{
+		const b2IslandRange* range = buffers.islands + i;
+		if (range->jointCount == 0 && (useColors == false || range->contactCount < b2_minColoredContacts))
+		{
+			jobs[jobCount++] = i;
+		}
+	}
+
+	b2SolveIslandsTask task(m_threadPool, buffers, jobs, jobCount, step, m_gravity, m_allowSleep);
+	if (jobCount > 1)
+	{
+		std::sort(jobs, jobs + jobCount, b2IslandLarger(buffers.islands));
+		m_threadPool->Run(&task);
+	}
+	else
+	{
+		task.Execute(0);
+	}
+
+	// Solve the remaining islands and merge all results in island order,
+	// so that they do not depend on the number of threads.
+	for (int32 i = 0; i < islandCount; ++i)
+	{
+		b2IslandRange* range = buffers.islands + i;
+		if (range->jointCount > 0)
+		{
+			b2SolveIsland(buffers, range, step, m_gravity, m_allowSleep, m_threadPool->GetStackAllocator(0), NULL);
+		}
+		else if (useColors && range->contactCount >= b2_minColoredContacts)
+		{
+			b2SolveIsland(buffers, range, step, m_gravity, m_allowSleep, m_threadPool->GetStackAllocator(0), m_threadPool);
+		}
+
+		m_profile.solveInit += range->profile.solveInit;
+		m_profile.solveVelocity += range->profile.solveVelocity;
+		m_profile.solvePosition += range->profile.solvePosition;
+
+		if (listener != NULL)
+		{
+			for (int32 j = range->contactStart; j < range->contactStart + range->contactCount; ++j)
+			{
+				// Skip speculative points that the bullet did not reach, see b2Island::Report.
+				if ((buffers.contacts[j]->m_flags & b2Contact::e_speculativePointFlag) && buffers.impulses[j].normalImpulses[0] == 0.0f)
+				{
+					continue;
+				}
+				listener->PostSolve(buffers.contacts[j], buffers.impulses + j);
+			}
+		}
+
+		if (range->sleep)
+		{
+			for (int32 j = range->bodyStart; j < range->bodyStart + range->bodyCount; ++j)
+			{
+				buffers.bodies[j]->SetAwake(false);
+			}
+		}
+	}
+
+	m_stackAllocator.Free(jobs);
+	if (listener != NULL)
+	{
+		m_stackAllocator.Free(buffers.impulses);
+	}
+	m_stackAllocator.Free(buffers.islands);
+	m_stackAllocator.Free(buffers.joints);
+	m_stackAllocator.Free(buffers.contactIndices);
+	m_stackAllocator.Free(buffers.contacts);
+	m_stackAllocator.Free(buffers.bodies);
+
 	{
 		b2Timer timer;
 		// Synchronize fixtures, check for out of range bodies.
 		for (b2Body* b = m_bodyList; b; b = b->GetNext())
 		{
 			// If a body was not in an island then it did not move.
-			if ((b->m_flags & b2Body::e_islandFlag) == 0)
+			if ((b->Flags() & b2Body::e_islandFlag) == 0)
 			{
 				continue;
 			}
@@ -564,7 +958,14 @@ void b2World::Solve(const b2TimeStep& step)
 			}
 
 			// Update fixtures (for broad-phase).
-			b->SynchronizeFixtures();
+			if (m_speculativeBullets && b->IsBullet())
+			{
+				b->SynchronizeSpeculativeFixtures(step.dt);
+			}
+			else
+			{
+				b->SynchronizeFixtures();
+			}
 		}
 
 		// Look for new contacts.
@@ -580,10 +981,14 @@ void b2World::SolveTOI(const b2TimeStep& step)
 
 	if (m_stepComplete)
 	{
-		for (b2Body* b = m_bodyList; b; b = b->m_next)
+		for (int32 i = 0; i < m_bodyStateBlockCount; ++i)
 		{
-			b->m_flags &= ~b2Body::e_islandFlag;
-			b->m_sweep.alpha0 = 0.0f;
+			b2BodyStateBlock* block = m_bodyStateBlocks[i];
+			for (int32 j = 0; j < b2_bodyStateBlockSize; ++j)
+			{
+				block->flags[j] &= ~b2Body::e_islandFlag;
+				block->sweeps[j].alpha0 = 0.0f;
+			}
 		}
 
 		for (b2Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
@@ -649,6 +1054,12 @@ void b2World::SolveTOI(const b2TimeStep& step)
 					continue;
 				}
 
+				// Speculative contacts take care of bullets.
+				if (m_speculativeBullets && (bA->IsBullet() || bB->IsBullet()))
+				{
+					continue;
+				}
+
 				bool collideA = bA->IsBullet() || typeA != b2_dynamicBody;
 				bool collideB = bB->IsBullet() || typeB != b2_dynamicBody;
 
@@ -660,17 +1071,17 @@ void b2World::SolveTOI(const b2TimeStep& step)
 
 				// Compute the TOI for this contact.
 				// Put the sweeps onto the same time interval.
-				float32 alpha0 = bA->m_sweep.alpha0;
+				float32 alpha0 = bA->Sweep().alpha0;
 
-				if (bA->m_sweep.alpha0 < bB->m_sweep.alpha0)
+				if (bA->Sweep().alpha0 < bB->Sweep().alpha0)
 				{
-					alpha0 = bB->m_sweep.alpha0;
-					bA->m_sweep.Advance(alpha0);
+					alpha0 = bB->Sweep().alpha0;
+					bA->Sweep().Advance(alpha0);
 				}
-				else if (bB->m_sweep.alpha0 < bA->m_sweep.alpha0)
+				else if (bB->Sweep().alpha0 < bA->Sweep().alpha0)
 				{
-					alpha0 = bA->m_sweep.alpha0;
-					bB->m_sweep.Advance(alpha0);
+					alpha0 = bA->Sweep().alpha0;
+					bB->Sweep().Advance(alpha0);
 				}
 
 				b2Assert(alpha0 < 1.0f);
@@ -682,8 +1093,8 @@ void b2World::SolveTOI(const b2TimeStep& step)
 				b2TOIInput input;
 				input.proxyA.Set(fA->GetShape(), indexA);
 				input.proxyB.Set(fB->GetShape(), indexB);
-				input.sweepA = bA->m_sweep;
-				input.sweepB = bB->m_sweep;
+				input.sweepA = bA->Sweep();
+				input.sweepB = bB->Sweep();
 				input.tMax = 1.0f;
 
 				b2TOIOutput output;
@@ -725,14 +1136,14 @@ void b2World::SolveTOI(const b2TimeStep& step)
 		b2Body* bA = fA->GetBody();
 		b2Body* bB = fB->GetBody();
 
-		b2Sweep backup1 = bA->m_sweep;
-		b2Sweep backup2 = bB->m_sweep;
+		b2Sweep backup1 = bA->Sweep();
+		b2Sweep backup2 = bB->Sweep();
 
 		bA->Advance(minAlpha);
 		bB->Advance(minAlpha);
 
 		// The TOI contact likely has some new contact points.
-		minContact->Update(m_contactManager.m_contactListener);
+		minContact->Update(m_contactManager.m_contactListener, 0.0f);
 		minContact->m_flags &= ~b2Contact::e_toiFlag;
 		++minContact->m_toiCount;
 
@@ -741,8 +1152,8 @@ void b2World::SolveTOI(const b2TimeStep& step)
 		{
 			// Restore the sweeps.
 			minContact->SetEnabled(false);
-			bA->m_sweep = backup1;
-			bB->m_sweep = backup2;
+			bA->Sweep() = backup1;
+			bB->Sweep() = backup2;
 			bA->SynchronizeTransform();
 			bB->SynchronizeTransform();
 			continue;
@@ -757,8 +1168,8 @@ void b2World::SolveTOI(const b2TimeStep& step)
 		island.Add(bB);
 		island.Add(minContact);
 
-		bA->m_flags |= b2Body::e_islandFlag;
-		bB->m_flags |= b2Body::e_islandFlag;
+		bA->Flags() |= b2Body::e_islandFlag;
+		bB->Flags() |= b2Body::e_islandFlag;
 		minContact->m_flags |= b2Contact::e_islandFlag;
 
 		// Get contacts on bodyA and bodyB.
@@ -796,6 +1207,12 @@ void b2World::SolveTOI(const b2TimeStep& step)
 						continue;
 					}
 
+					// Speculative bullets are solved in the regular step only.
+					if (m_speculativeBullets && other->IsBullet())
+					{
+						continue;
+					}
+
 					// Skip sensors.
 					bool sensorA = contact->m_fixtureA->m_isSensor;
 					bool sensorB = contact->m_fixtureB->m_isSensor;
@@ -805,19 +1222,19 @@ void b2World::SolveTOI(const b2TimeStep& step)
 					}
 
 					// Tentatively advance the body to the TOI.
-					b2Sweep backup = other->m_sweep;
-					if ((other->m_flags & b2Body::e_islandFlag) == 0)
+					b2Sweep backup = other->Sweep();
+					if ((other->Flags() & b2Body::e_islandFlag) == 0)
 					{
 						other->Advance(minAlpha);
 					}
 
 					// Update the contact points
-					contact->Update(m_contactManager.m_contactListener);
+					contact->Update(m_contactManager.m_contactListener, 0.0f);
 
 					// Was the contact disabled by the user?
 					if (contact->IsEnabled() == false)
 					{
-						other->m_sweep = backup;
+						other->Sweep() = backup;
 						other->SynchronizeTransform();
 						continue;
 					}
@@ -825,7 +1242,7 @@ void b2World::SolveTOI(const b2TimeStep& step)
 					// Are there contact points?
 					if (contact->IsTouching() == false)
 					{
-						other->m_sweep = backup;
+						other->Sweep() = backup;
 						other->SynchronizeTransform();
 						continue;
 					}
@@ -835,13 +1252,13 @@ void b2World::SolveTOI(const b2TimeStep& step)
 					island.Add(contact);
 
 					// Has the other body already been added to the island?
-					if (other->m_flags & b2Body::e_islandFlag)
+					if (other->Flags() & b2Body::e_islandFlag)
 					{
 						continue;
 					}
 					
 					// Add the other body to the island.
-					other->m_flags |= b2Body::e_islandFlag;
+					other->Flags() |= b2Body::e_islandFlag;
 
 					if (other->m_type != b2_staticBody)
 					{
@@ -866,7 +1283,7 @@ void b2World::SolveTOI(const b2TimeStep& step)
 		for (int32 i = 0; i < island.m_bodyCount; ++i)
 		{
 			b2Body* body = island.m_bodies[i];
-			body->m_flags &= ~b2Body::e_islandFlag;
+			body->Flags() &= ~b2Body::e_islandFlag;
 
 			if (body->m_type != b2_dynamicBody)
 			{
@@ -927,6 +1344,7 @@ void b2World::Step(float32 dt, int32 velocityIterations, int32 positionIteration
 	// Update contacts. This is where some contacts are destroyed.
 	{
 		b2Timer timer;
+		m_contactManager.m_speculativeTime = m_speculativeBullets ? step.dt : 0.0f;
 		m_contactManager.Collide();
 		m_profile.collide = timer.GetMilliseconds();
 	}
@@ -1085,6 +1503,23 @@ void b2World::DrawShape(b2Fixture* fixture, const b2Transform& xf, const b2Color
 			g_debugDraw->DrawSolidPolygon(vertices, vertexCount, color);
 		}
 		break;
+
+	case b2Shape::e_capsule:
+		{
+			b2CapsuleShape* capsule = (b2CapsuleShape*)fixture->GetShape();
+			b2Vec2 v1 = b2Mul(xf, capsule->m_vertex1);
+			b2Vec2 v2 = b2Mul(xf, capsule->m_vertex2);
+			float32 radius = capsule->m_radius;
+			b2Vec2 axis = v2 - v1;
+			axis.Normalize();
+			b2Vec2 offset = radius * b2Cross(axis, 1.0f);
+
+			g_debugDraw->DrawSolidCircle(v1, radius, axis, color);
+			g_debugDraw->DrawSolidCircle(v2, radius, axis, color);
+			g_debugDraw->DrawSegment(v1 + offset, v2 + offset, color);
+			g_debugDraw->DrawSegment(v1 - offset, v2 - offset, color);
+		}
+		break;
             
     default:
         break;
@@ -1241,6 +1676,26 @@ int32 b2World::GetProxyCount() const
 	return m_contactManager.m_broadPhase.GetProxyCount();
 }
 
+int32 b2World::GetStackOverflowCount() const
+{
+	int32 count = m_stackAllocator.GetOverflowCount();
+	for (int32 i = 0; i < m_threadPool->GetThreadCount(); ++i)
+	{
+		count += m_threadPool->GetStackAllocator(i)->GetOverflowCount();
+	}
+	return count;
+}
+
+int32 b2World::GetStackMaxAllocation() const
+{
+	int32 maxAllocation = m_stackAllocator.GetMaxAllocation();
+	for (int32 i = 0; i < m_threadPool->GetThreadCount(); ++i)
+	{
+		maxAllocation = b2Max(maxAllocation, m_threadPool->GetStackAllocator(i)->GetMaxAllocation());
+	}
+	return maxAllocation;
+}
+
 int32 b2World::GetTreeHeight() const
 {
 	return m_contactManager.m_broadPhase.GetTreeHeight();
@@ -1256,6 +1711,44 @@ float32 b2World::GetTreeQuality() const
 	return m_contactManager.m_broadPhase.GetTreeQuality();
 }
 
+void b2World::RebuildTree()
+{
+	b2Assert(IsLocked() == false);
+	if (IsLocked())
+	{
+		return;
+	}
+
+	m_contactManager.m_broadPhase.RebuildTree();
+}
+
+void b2World::SetWideTrees(bool flag)
+{
+	b2Assert(IsLocked() == false);
+	if (IsLocked())
+	{
+		return;
+	}
+
+	m_contactManager.m_broadPhase.SetWideTrees(flag);
+}
+
+bool b2World::GetWideTrees() const
+{
+	return m_contactManager.m_broadPhase.GetWideTrees();
+}
+
+void b2World::BuildWideTrees()
+{
+	b2Assert(IsLocked() == false);
+	if (IsLocked())
+	{
+		return;
+	}
+
+	m_contactManager.m_broadPhase.BuildWideTrees();
+}
+
 void b2World::ShiftOrigin(const b2Vec2& newOrigin)
 {
 	b2Assert((m_flags & e_locked) == 0);
@@ -1266,9 +1759,10 @@ void b2World::ShiftOrigin(const b2Vec2& newOrigin)
 
 	for (b2Body* b = m_bodyList; b; b = b->m_next)
 	{
-		b->m_xf.p -= newOrigin;
-		b->m_sweep.c0 -= newOrigin;
-		b->m_sweep.c -= newOrigin;
+		b->Transform().p -= newOrigin;
+		b->Sweep().c0 -= newOrigin;
+		b->Sweep().c -= newOrigin;
+		AddMovedBody(b);
 	}
 
 	for (b2Joint* j = m_jointList; j; j = j->m_next)
@@ -22,6 +22,8 @@
 #include <Box2D/Common/b2Math.h>
 #include <Box2D/Common/b2BlockAllocator.h>
 #include <Box2D/Common/b2StackAllocator.h>
+#include <Box2D/Common/b2GrowableStack.h>
+#include <Box2D/Dynamics/b2Body.h>
 #include <Box2D/Dynamics/b2ContactManager.h>
 #include <Box2D/Dynamics/b2WorldCallbacks.h>
 #include <Box2D/Dynamics/b2TimeStep.h>
@@ -34,6 +36,7 @@ class b2Body;
 class b2Draw;
 class b2Fixture;
 class b2Joint;
+class b2ThreadPool;
 
 /// The world class manages all physics entities, dynamic simulation,
 /// and asynchronous queries. The world also contains efficient memory
@@ -127,6 +130,27 @@ public:
 	b2Body* GetBodyList();
 	const b2Body* GetBodyList() const;
 
+	/// Get the ids of the bodies whose transform changed since the last call to
+	/// ClearMovedBodies, either in a time step or through b2Body::SetTransform and
+	/// ShiftOrigin. Bodies that sleep do not move and are left out. Destroyed bodies
+	/// are removed. Use this with GetBodyTransform and GetBodyUserData to update the
+	/// rendering of moving bodies only.
+	const int32* GetMovedBodies() const;
+	int32 GetMovedBodyCount() const;
+
+	/// Get the body with the given id, see b2Body::GetId.
+	b2Body* GetBody(int32 id);
+
+	/// Get the origin transform of the body with the given id. This reads the
+	/// world's state arrays directly and does not touch the body.
+	const b2Transform& GetBodyTransform(int32 id) const;
+
+	/// Get the user data of the body with the given id.
+	void* GetBodyUserData(int32 id) const;
+
+	/// Empty the list of moved bodies, typically after all sub-steps of a frame.
+	void ClearMovedBodies();
+
 	/// Get the world joint list. With the returned joint, use b2Joint::GetNext to get
 	/// the next joint in the world list. A NULL joint indicates the end of the list.
 	/// @return the head of the world joint list.
@@ -157,9 +181,46 @@ public:
 	void SetSubStepping(bool flag) { m_subStepping = flag; }
 	bool GetSubStepping() const { return m_subStepping; }
 
+	/// Set the number of threads that solve islands, including the thread
+	/// calling Step. The default is 1. Results and listener callbacks are merged
+	/// in island order. With more than one thread, the contacts of large islands
+	/// are solved in graph colors, which changes the order in which they are solved.
+	void SetThreadCount(int32 count);
+	int32 GetThreadCount() const;
+
+	/// Solve the contacts of large islands in graph colors even with a single
+	/// thread, so that the simulation does not depend on the thread count.
+	void SetDeterministic(bool flag) { m_deterministic = flag; }
+	bool GetDeterministic() const { return m_deterministic; }
+
+	/// Leave all memory to the allocator when the world is deleted: fixtures are
+	/// not destroyed and the chunks of the block allocator are not freed. Only set
+	/// this if an allocator plugged in with b2SetAllocator (see b2ArenaAllocator)
+	/// is reset right after the world is deleted.
+	void SetAbandonMemory(bool flag) { m_abandonMemory = flag; }
+	bool GetAbandonMemory() const { return m_abandonMemory; }
+
+	/// Keep bullets from tunneling with speculative contacts instead of time of
+	/// impact sub-steps. A bullet gets a contact point as soon as it can reach
+	/// another shape within the time step, and the solver stops it at the
+	/// surface. Such a contact is touching so that it is solved, but BeginContact
+	/// and PreSolve are only reported once the shapes meet, and PostSolve once
+	/// the bullet reached the shape. Contacts whose shapes really touch are
+	/// solved as usual. This works without continuous physics.
+	void SetSpeculativeBullets(bool flag) { m_speculativeBullets = flag; }
+	bool GetSpeculativeBullets() const { return m_speculativeBullets; }
+
 	/// Get the number of broad-phase proxies.
 	int32 GetProxyCount() const;
 
+	/// Get the number of per step allocations that did not fit on the stack
+	/// allocators of the world and its threads and fell back to b2Alloc.
+	int32 GetStackOverflowCount() const;
+
+	/// Get the largest number of bytes that were in use at once on any
+	/// of the stack allocators of the world and its threads.
+	int32 GetStackMaxAllocation() const;
+
 	/// Get the number of bodies.
 	int32 GetBodyCount() const;
 
@@ -179,6 +240,24 @@ public:
 	/// The minimum is 1.
 	float32 GetTreeQuality() const;
 
+	/// Rebuild the dynamic tree in one go. This yields a better tree than
+	/// inserting the proxies one by one, so call it after creating many
+	/// bodies at once. It does nothing if the world is locked.
+	void RebuildTree();
+
+	/// Enable/disable the 4-ary copies of the broad-phase trees that serve
+	/// queries, ray casts and new pairs. The default is true. Both settings
+	/// report the same fixtures in the same order. It does nothing if the world is locked.
+	/// The static copy is kept up to date by the step. The dynamic copy goes stale
+	/// when a body leaves its fat AABB; queries then use the binary dynamic tree.
+	void SetWideTrees(bool flag);
+	bool GetWideTrees() const;
+
+	/// Rebuild the stale 4-ary trees, including the dynamic one, for example
+	/// before many queries on a scene that does not move.
+	/// It does nothing if the world is locked.
+	void BuildWideTrees();
+
 	/// Change the global gravity vector.
 	void SetGravity(const b2Vec2& gravity);
 	
@@ -224,6 +303,11 @@ private:
 	friend class b2ContactManager;
 	friend class b2Controller;
 
+	void CreateBodyState(b2Body* body);
+	void DestroyBodyState(b2Body* body);
+	void AddMovedBody(b2Body* body);
+	void RemoveMovedBody(b2Body* body);
+
 	void Solve(const b2TimeStep& step);
 	void SolveTOI(const b2TimeStep& step);
 
@@ -232,6 +316,7 @@ private:
 
 	b2BlockAllocator m_blockAllocator;
 	b2StackAllocator m_stackAllocator;
+	b2ThreadPool* m_threadPool;
 
 	int32 m_flags;
 
@@ -243,6 +328,18 @@ private:
 	int32 m_bodyCount;
 	int32 m_jointCount;
 
+	// Body ids index the state blocks; ids of destroyed bodies are reused
+	// first. m_bodyStateCount is one past the highest id ever handed out.
+	b2BodyStateBlock** m_bodyStateBlocks;
+	int32 m_bodyStateBlockCount;
+	int32 m_bodyStateBlockCapacity;
+	int32 m_bodyStateCount;
+	b2GrowableStack<int32, b2_bodyStateBlockSize> m_freeBodyStates;
+
+	int32* m_movedBodies;
+	int32 m_movedBodyCount;
+	int32 m_movedBodyCapacity;
+
 	b2Vec2 m_gravity;
 	bool m_allowSleep;
 
@@ -257,6 +354,9 @@ private:
 	bool m_warmStarting;
 	bool m_continuousPhysics;
 	bool m_subStepping;
+	bool m_deterministic;
+	bool m_speculativeBullets;
+	bool m_abandonMemory;
 
 	bool m_stepComplete;
 
@@ -293,6 +393,34 @@ inline const b2Contact* b2World::GetContactList() const
 	return m_contactManager.m_contactList;
 }
 
+inline const int32* b2World::GetMovedBodies() const
+{
+	return m_movedBodies;
+}
+
+inline int32 b2World::GetMovedBodyCount() const
+{
+	return m_movedBodyCount;
+}
+
+inline b2Body* b2World::GetBody(int32 id)
+{
+	b2Assert(0 <= id && id < m_bodyStateCount);
+	return m_bodyStateBlocks[id / b2_bodyStateBlockSize]->bodies[id % b2_bodyStateBlockSize];
+}
+
+inline const b2Transform& b2World::GetBodyTransform(int32 id) const
+{
+	b2Assert(0 <= id && id < m_bodyStateCount);
+	return m_bodyStateBlocks[id / b2_bodyStateBlockSize]->transforms[id % b2_bodyStateBlockSize];
+}
+
+inline void* b2World::GetBodyUserData(int32 id) const
+{
+	b2Assert(0 <= id && id < m_bodyStateCount);
+	return m_bodyStateBlocks[id / b2_bodyStateBlockSize]->userData[id % b2_bodyStateBlockSize];
+}
+
 inline int32 b2World::GetBodyCount() const
 {
 	return m_bodyCount;
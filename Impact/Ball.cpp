@@ -99,14 +99,19 @@ namespace Impact {
   void Ball::onUpdate(float elapsedSeconds)
   {
     UNUSED(elapsedSeconds);
+  }
+
+
+  void Ball::onTransformChanged(const b2Transform &xf)
+  {
     if (gLocalSettings().useShaders()) {
       mShader.setParameter("uV", mBody->GetLinearVelocity().x, mBody->GetLinearVelocity().y);
-      mShader.setParameter("uRot", mBody->GetAngle());
+      mShader.setParameter("uRot", xf.q.GetAngle());
     }
     else {
-      mSprite.setRotation(rad2deg(mBody->GetAngle()));
+      mSprite.setRotation(rad2deg(xf.q.GetAngle()));
     }
-    mSprite.setPosition(Game::Scale * mBody->GetPosition().x, Game::Scale * mBody->GetPosition().y);
+    mSprite.setPosition(Game::Scale * xf.p.x, Game::Scale * xf.p.y);
   }
 
 
@@ -119,11 +124,4 @@ namespace Impact {
   }
 
 
-  void Ball::setPosition(const b2Vec2 &p)
-  {
-    Body::setPosition(p);
-    onUpdate(0);
-  }
-
-
 }
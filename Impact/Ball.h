@@ -34,10 +34,9 @@ namespace Impact {
 
     // Body implementation
     virtual void onUpdate(float elapsedSeconds);
+    virtual void onTransformChanged(const b2Transform &xf);
     virtual void onDraw(sf::RenderTarget &target, sf::RenderStates states) const;
 
-    virtual void setPosition(const b2Vec2 &);
-
     static const float32 DefaultDensity;
     static const float32 DefaultFriction;
     static const float32 DefaultRestitution;
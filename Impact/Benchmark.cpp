@@ -0,0 +1,282 @@
+/*  
+
+    Copyright (c) 2015 Oliver Lau <ola@ct.de>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include "stdafx.h"
+
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/json_parser.hpp>
+
+#include <cmath>
+
+namespace Impact {
+
+  const int Benchmark::DefaultIterations = 20;
+  const int Benchmark::DefaultWarmupIterations = 2;
+  const double Benchmark::DefaultThreshold = 5.0;
+  const double Benchmark::DefaultAlpha = 0.01;
+
+  Benchmark::Benchmark(const std::string &name)
+    : mName(name)
+    , mIterations(DefaultIterations)
+    , mWarmupIterations(DefaultWarmupIterations)
+  { /* ... */ }
+
+
+  void Benchmark::add(const std::string &key, double microseconds)
+  {
+    std::map<std::string, std::vector<double> >::iterator s = mSamples.find(key);
+    if (s == mSamples.end()) {
+      mKeys.push_back(key);
+      mSamples[key].push_back(microseconds);
+    }
+    else {
+      s->second.push_back(microseconds);
+    }
+  }
+
+
+  bool Benchmark::contains(const std::string &key) const
+  {
+    return mSamples.find(key) != mSamples.end();
+  }
+
+
+  const std::vector<double> &Benchmark::samples(const std::string &key) const
+  {
+    static const std::vector<double> NoSamples;
+    std::map<std::string, std::vector<double> >::const_iterator s = mSamples.find(key);
+    return s != mSamples.end() ? s->second : NoSamples;
+  }
+
+
+  BenchmarkStatistics Benchmark::statistics(const std::string &key) const
+  {
+    return evaluate(samples(key));
+  }
+
+
+  void Benchmark::clear(void)
+  {
+    mKeys.clear();
+    mSamples.clear();
+  }
+
+
+  BenchmarkStatistics Benchmark::evaluate(std::vector<double> samples)
+  {
+    BenchmarkStatistics stats;
+    stats.n = samples.size();
+    if (stats.n == 0)
+      return stats;
+    std::sort(samples.begin(), samples.end());
+    stats.min = samples.front();
+    stats.max = samples.back();
+    stats.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / stats.n;
+    stats.median = (stats.n % 2 == 1)
+      ? samples[stats.n / 2]
+      : .5 * (samples[stats.n / 2 - 1] + samples[stats.n / 2]);
+    const std::size_t p95idx = std::size_t(std::ceil(.95 * stats.n)) - 1;
+    stats.p95 = samples[std::min(p95idx, stats.n - 1)];
+    if (stats.n > 1) {
+      double sumSq = 0.0;
+      std::vector<double>::const_iterator s;
+      for (s = samples.begin(); s != samples.end(); ++s)
+        sumSq += (*s - stats.mean) * (*s - stats.mean);
+      stats.stddev = std::sqrt(sumSq / (stats.n - 1));
+    }
+    return stats;
+  }
+
+
+  void Benchmark::print(std::ostream &os) const
+  {
+    const std::streamsize w = 12;
+    os << mName << " (times in microseconds)" << std::endl
+      << std::left << std::setw(40) << "series" << std::right
+      << std::setw(6) << "n"
+      << std::setw(w) << "min"
+      << std::setw(w) << "median"
+      << std::setw(w) << "mean"
+      << std::setw(w) << "stddev"
+      << std::setw(w) << "p95"
+      << std::setw(w) << "max" << std::endl;
+    std::vector<std::string>::const_iterator k;
+    for (k = mKeys.begin(); k != mKeys.end(); ++k) {
+      const BenchmarkStatistics &stats = statistics(*k);
+      os << std::left << std::setw(40) << *k << std::right
+        << std::setw(6) << stats.n
+        << std::fixed << std::setprecision(1)
+        << std::setw(w) << stats.min
+        << std::setw(w) << stats.median
+        << std::setw(w) << stats.mean
+        << std::setw(w) << stats.stddev
+        << std::setw(w) << stats.p95
+        << std::setw(w) << stats.max << std::endl;
+    }
+  }
+
+
+  bool Benchmark::save(const std::string &filename) const
+  {
+    boost::property_tree::ptree pt;
+    pt.put("name", mName);
+    pt.put("unit", "us");
+    boost::property_tree::ptree series;
+    std::vector<std::string>::const_iterator k;
+    for (k = mKeys.begin(); k != mKeys.end(); ++k) {
+      const BenchmarkStatistics &stats = statistics(*k);
+      boost::property_tree::ptree entry;
+      entry.put("name", *k);
+      entry.put("median", stats.median);
+      entry.put("mean", stats.mean);
+      entry.put("stddev", stats.stddev);
+      entry.put("p95", stats.p95);
+      boost::property_tree::ptree samples;
+      const std::vector<double> &s = this->samples(*k);
+      std::vector<double>::const_iterator si;
+      for (si = s.begin(); si != s.end(); ++si) {
+        boost::property_tree::ptree value;
+        value.put("", *si);
+        samples.push_back(std::make_pair(std::string(), value));
+      }
+      entry.add_child("samples", samples);
+      series.push_back(std::make_pair(std::string(), entry));
+    }
+    pt.add_child("series", series);
+    try {
+      boost::property_tree::json_parser::write_json(filename, pt);
+    }
+    catch (const boost::property_tree::json_parser::json_parser_error &ex) {
+      std::cerr << "Cannot write benchmark results to " << filename << ": " << ex.what() << std::endl;
+      return false;
+    }
+    return true;
+  }
+
+
+  bool Benchmark::load(const std::string &filename)
+  {
+    boost::property_tree::ptree pt;
+    try {
+      boost::property_tree::json_parser::read_json(filename, pt);
+      clear();
+      mName = pt.get<std::string>("name", mName);
+      const boost::property_tree::ptree &series = pt.get_child("series");
+      boost::property_tree::ptree::const_iterator si;
+      for (si = series.begin(); si != series.end(); ++si) {
+        const std::string &key = si->second.get<std::string>("name");
+        const boost::property_tree::ptree &samples = si->second.get_child("samples");
+        boost::property_tree::ptree::const_iterator vi;
+        for (vi = samples.begin(); vi != samples.end(); ++vi)
+          add(key, vi->second.get_value<double>());
+      }
+    }
+    catch (const boost::property_tree::ptree_error &ex) {
+      std::cerr << "Cannot read benchmark results from " << filename << ": " << ex.what() << std::endl;
+      return false;
+    }
+    return true;
+  }
+
+
+  int Benchmark::compare(const Benchmark &baseline, double threshold, std::ostream &os, double alpha) const
+  {
+    int regressions = 0;
+    const std::streamsize w = 12;
+    os << mName << " vs. baseline (medians in microseconds, threshold " << threshold << "%, alpha " << alpha << ")" << std::endl
+      << std::left << std::setw(40) << "series" << std::right
+      << std::setw(w) << "baseline"
+      << std::setw(w) << "current"
+      << std::setw(w) << "delta %"
+      << std::setw(w) << "p"
+      << "  verdict" << std::endl;
+    std::vector<std::string>::const_iterator k;
+    for (k = mKeys.begin(); k != mKeys.end(); ++k) {
+      if (!baseline.contains(*k))
+        continue;
+      const BenchmarkStatistics &current = statistics(*k);
+      const BenchmarkStatistics &base = baseline.statistics(*k);
+      const double delta = base.median > 0.0 ? 100.0 * (current.median - base.median) / base.median : 0.0;
+      const double p = mannWhitney(samples(*k), baseline.samples(*k));
+      const char *verdict = "ok";
+      if (p < alpha) {
+        if (delta > threshold) {
+          verdict = "REGRESSION";
+          ++regressions;
+        }
+        else if (delta < -threshold) {
+          verdict = "faster";
+        }
+      }
+      os << std::left << std::setw(40) << *k << std::right
+        << std::fixed << std::setprecision(1)
+        << std::setw(w) << base.median
+        << std::setw(w) << current.median
+        << std::setw(w) << std::showpos << delta << std::noshowpos
+        << std::setprecision(4)
+        << std::setw(w) << p
+        << "  " << verdict << std::endl;
+    }
+    return regressions;
+  }
+
+
+  double Benchmark::mannWhitney(const std::vector<double> &a, const std::vector<double> &b)
+  {
+    const double n1 = double(a.size());
+    const double n2 = double(b.size());
+    if (a.empty() || b.empty())
+      return 1.0;
+    // pool both samples, remembering where each value came from
+    std::vector<std::pair<double, bool> > pooled;
+    pooled.reserve(a.size() + b.size());
+    std::vector<double>::const_iterator s;
+    for (s = a.begin(); s != a.end(); ++s)
+      pooled.push_back(std::make_pair(*s, true));
+    for (s = b.begin(); s != b.end(); ++s)
+      pooled.push_back(std::make_pair(*s, false));
+    std::sort(pooled.begin(), pooled.end());
+    const double n = n1 + n2;
+    double rankSumA = 0.0;
+    double tieSum = 0.0;
+    std::size_t i = 0;
+    while (i < pooled.size()) {
+      std::size_t j = i + 1;
+      while (j < pooled.size() && pooled[j].first == pooled[i].first)
+        ++j;
+      // tied values share the mean of their 1-based ranks
+      const double rank = .5 * double(i + 1 + j);
+      const double t = double(j - i);
+      tieSum += t * t * t - t;
+      for (std::size_t k = i; k < j; ++k)
+        if (pooled[k].second)
+          rankSumA += rank;
+      i = j;
+    }
+    const double u = rankSumA - .5 * n1 * (n1 + 1.0);
+    const double mu = .5 * n1 * n2;
+    const double sigma = std::sqrt(n1 * n2 / 12.0 * ((n + 1.0) - tieSum / (n * (n - 1.0))));
+    if (sigma <= 0.0)
+      return 1.0;
+    // continuity correction towards the mean
+    const double z = std::max(0.0, std::fabs(u - mu) - .5) / sigma;
+    return std::erfc(z / std::sqrt(2.0));
+  }
+}
@@ -0,0 +1,141 @@
+/*  
+
+    Copyright (c) 2015 Oliver Lau <ola@ct.de>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __BENCHMARK_H_
+#define __BENCHMARK_H_
+
+#include <string>
+#include <vector>
+#include <map>
+#include <chrono>
+#include <iostream>
+
+namespace Impact {
+
+  class Stopwatch {
+  public:
+    Stopwatch(void)
+      : mStart(std::chrono::steady_clock::now())
+    { /* ... */ }
+    inline void restart(void)
+    {
+      mStart = std::chrono::steady_clock::now();
+    }
+    /// elapsed time since construction or last restart() in microseconds
+    inline double elapsed(void) const
+    {
+      return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - mStart).count();
+    }
+  private:
+    std::chrono::steady_clock::time_point mStart;
+  };
+
+
+  struct BenchmarkStatistics {
+    BenchmarkStatistics(void)
+      : n(0)
+      , min(0)
+      , max(0)
+      , mean(0)
+      , median(0)
+      , stddev(0)
+      , p95(0)
+    { /* ... */ }
+    std::size_t n;
+    double min;
+    double max;
+    double mean;
+    double median;
+    double stddev;
+    double p95;
+  };
+
+
+  class Benchmark {
+  public:
+    Benchmark(const std::string &name);
+
+    static const int DefaultIterations;
+    static const int DefaultWarmupIterations;
+    static const double DefaultThreshold;
+    static const double DefaultAlpha;
+
+    inline void setIterations(int iterations)
+    {
+      mIterations = iterations;
+    }
+    inline void setWarmupIterations(int iterations)
+    {
+      mWarmupIterations = iterations;
+    }
+    inline const std::string &name(void) const
+    {
+      return mName;
+    }
+    inline const std::vector<std::string> &keys(void) const
+    {
+      return mKeys;
+    }
+
+    /// Runs `f` mWarmupIterations times untimed, then mIterations times
+    /// timed, and records one sample per timed call under `key`.
+    template <typename Func>
+    void run(const std::string &key, Func f)
+    {
+      for (int i = 0; i < mWarmupIterations; ++i)
+        f();
+      for (int i = 0; i < mIterations; ++i) {
+        Stopwatch stopwatch;
+        f();
+        add(key, stopwatch.elapsed());
+      }
+    }
+
+    void add(const std::string &key, double microseconds);
+    bool contains(const std::string &key) const;
+    const std::vector<double> &samples(const std::string &key) const;
+    BenchmarkStatistics statistics(const std::string &key) const;
+    void clear(void);
+
+    void print(std::ostream &os) const;
+    bool save(const std::string &filename) const;
+    bool load(const std::string &filename);
+
+    /// Prints a diff table against `baseline` and returns the number of
+    /// series whose median got slower by more than `threshold` percent
+    /// while the Mann-Whitney test rejects equal distributions at `alpha`.
+    int compare(const Benchmark &baseline, double threshold, std::ostream &os, double alpha = DefaultAlpha) const;
+
+    static BenchmarkStatistics evaluate(std::vector<double> samples);
+
+    /// Two-sided p-value of the Mann-Whitney U test for the samples `a`
+    /// and `b`, using the normal approximation with tie correction.
+    static double mannWhitney(const std::vector<double> &a, const std::vector<double> &b);
+
+  private:
+    std::string mName;
+    int mIterations;
+    int mWarmupIterations;
+    std::vector<std::string> mKeys;
+    std::map<std::string, std::vector<double> > mSamples;
+  };
+
+}
+
+#endif // __BENCHMARK_H_
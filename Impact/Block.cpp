@@ -33,6 +33,7 @@ namespace Impact {
     : Body(Body::BodyType::Block, game, tileParam)
     , mGravityScale(2.f)
     , mMinimumHitImpulse(0)
+    , mBlurred(false)
   {
     mName = Name;
     mMinimumHitImpulse = mTileParam.minimumHitImpulse;
@@ -76,60 +77,42 @@ namespace Impact {
     bd.userData = this;
     mBody = game->world()->CreateBody(&bd);
 
-    b2PolygonShape polygon;
+    b2CapsuleShape capsule;
     const float32 hs = .5f * Game::InvScale;
     const float32 hh = hs * H;
     const float32 xoff = hs * (W - H);
-    polygon.SetAsBox(xoff, hh);
+    capsule.Set(b2Vec2(-xoff, 0.f), b2Vec2(xoff, 0.f), hh);
 
     const float32 density = mTileParam.density.isValid() ? mTileParam.density.get() : DefaultDensity;
     const float32 friction = mTileParam.friction.isValid() ? mTileParam.friction.get() : DefaultFriction;
     const float32 restitution = mTileParam.restitution.isValid() ? mTileParam.restitution.get() : DefaultRestitution;
 
-    b2FixtureDef fdBox;
-    fdBox.shape = &polygon;
-    fdBox.density = density;
-    fdBox.friction = friction;
-    fdBox.restitution = restitution;
-    fdBox.userData = this;
-    mBody->CreateFixture(&fdBox);
-
-    b2CircleShape circleL;
-    circleL.m_p.Set(-xoff, 0.f);
-    circleL.m_radius = hh;
-
-    b2FixtureDef fdCircleL;
-    fdCircleL.shape = &circleL;
-    fdCircleL.density = density;
-    fdCircleL.friction = friction;
-    fdCircleL.restitution = restitution;
-    fdCircleL.userData = this;
-    mBody->CreateFixture(&fdCircleL);
-
-    b2CircleShape circleR;
-    circleR.m_p.Set(xoff, 0.f);
-    circleR.m_radius = hh;
-
-    b2FixtureDef fdCircleR;
-    fdCircleR.shape = &circleR;
-    fdCircleR.density = density;
-    fdCircleR.friction = friction;
-    fdCircleR.restitution = restitution;
-    fdCircleR.userData = this;
-    mBody->CreateFixture(&fdCircleR);
+    b2FixtureDef fd;
+    fd.shape = &capsule;
+    fd.density = density * capsuleDensityScale(xoff, hh);
+    fd.friction = friction;
+    fd.restitution = restitution;
+    fd.userData = this;
+    mBody->CreateFixture(&fd);
   }
 
 
   void Block::onUpdate(float elapsedSeconds)
   {
     UNUSED(elapsedSeconds);
-    mSprite.setPosition(Game::Scale * mBody->GetPosition().x, Game::Scale * mBody->GetPosition().y);
-    mSprite.setRotation(rad2deg(mBody->GetAngle()));
-    if (gLocalSettings().useShaders())
+    // the age only drives the blur, which is off until the block is hit
+    if (mBlurred)
       mShader.setParameter("uAge", age().asSeconds());
   }
 
 
+  void Block::onTransformChanged(const b2Transform &xf)
+  {
+    mSprite.setPosition(Game::Scale * xf.p.x, Game::Scale * xf.p.y);
+    mSprite.setRotation(rad2deg(xf.q.GetAngle()));
+  }
+
+
   void Block::onDraw(sf::RenderTarget &target, sf::RenderStates states) const
   {
     if (gLocalSettings().useShaders())
@@ -148,6 +131,8 @@ namespace Impact {
       if (gLocalSettings().useShaders()) {
         mShader.setParameter("uColor", sf::Color(sf::Color(255U, 255U, 255U, 230U)));
         mShader.setParameter("uBlur", 2.28f);
+        mBlurred = true;
+        startUpdates();
       }
       else {
         mSprite.setColor(sf::Color(255U, 255U, 255U, 160U));
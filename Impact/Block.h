@@ -33,6 +33,7 @@ namespace Impact {
 
     // Body implementation
     virtual void onUpdate(float elapsedSeconds);
+    virtual void onTransformChanged(const b2Transform &xf);
     virtual void onDraw(sf::RenderTarget &target, sf::RenderStates states) const;
 
     virtual bool hit(float impulse);
@@ -53,6 +54,7 @@ namespace Impact {
   private:
     float32 mGravityScale;
     int mMinimumHitImpulse;
+    bool mBlurred;
   };
 
 }
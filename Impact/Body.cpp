@@ -29,6 +29,7 @@ namespace Impact {
     : mBodyType(type)
     , mAlive(true)
     , mVisible(true)
+    , mUpdating(false)
     , mZIndex(0)
     , mBody(nullptr)
     , mSetHalfTextureSizeCalled(false)
@@ -65,6 +66,27 @@ namespace Impact {
   }
 
 
+  void Body::startUpdates(void)
+  {
+    if (!mUpdating && mGame != nullptr) {
+      mUpdating = true;
+      mGame->scheduleUpdates(this);
+    }
+  }
+
+
+  void Body::stopUpdates(void)
+  {
+    mUpdating = false;
+  }
+
+
+  void Body::updateTransform(const b2Transform &xf)
+  {
+    onTransformChanged(xf);
+  }
+
+
   void Body::draw(sf::RenderTarget &target, sf::RenderStates states) const
   {
     onDraw(target, states);
@@ -102,6 +124,7 @@ namespace Impact {
     if (!mSetHalfTextureSizeCalled)
       throw "Body::setHalfTextureSize() must be called before first call to Body::setPosition()";
     mBody->SetTransform(p + b2Vec2(mHalfTextureSize.x, 1 - mHalfTextureSize.y), mBody->GetAngle());
+    onTransformChanged(mBody->GetTransform());
     onUpdate(0);
   }
 
@@ -113,6 +136,14 @@ namespace Impact {
   }
 
 
+  float32 Body::capsuleDensityScale(float32 halfLength, float32 radius)
+  {
+    const float32 boxArea = 4.f * halfLength * radius;
+    const float32 capArea = b2_pi * radius * radius;
+    return (boxArea + 2.f * capArea) / (boxArea + capArea);
+  }
+
+
   void Body::setLifetime(const sf::Time &lifetime)
   {
     mMaxAge = lifetime;
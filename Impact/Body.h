@@ -63,6 +63,8 @@ namespace Impact {
       BottomBoundary
     } BodyType;
 
+    static const int BodyTypeCount = BottomBoundary + 1;
+
     static const int16 DefaultCollisionGroup = 1;
     static const uint16 BlockMask = 1 << 0;
     static const uint16 BallMask = 1 << 1;
@@ -81,6 +83,15 @@ namespace Impact {
     boost::signals2::connection doOnKilled(const KilledSlotType &slot);
 
     void update(float elapsedSeconds);
+    /// brings the drawable state in line with the Box2D transform; called
+    /// only for bodies that moved with the transform read by id, see
+    /// b2World::GetMovedBodies()
+    void updateTransform(const b2Transform &xf);
+    /// true while the body wants update() every frame, see startUpdates()
+    inline bool isUpdating(void) const
+    {
+      return mUpdating;
+    }
     void draw(sf::RenderTarget& target, sf::RenderStates states) const;
 
     virtual void setDensity(float32);
@@ -168,15 +179,27 @@ namespace Impact {
     std::string mName;
 
     virtual void onUpdate(float elapsedSeconds) = 0;
+    virtual void onTransformChanged(const b2Transform &xf) { UNUSED(xf); }
+
+    /// bodies with time-driven effects have Game::update() call onUpdate()
+    /// every frame until they are killed or call stopUpdates(); all others
+    /// only change when they move
+    void startUpdates(void);
+    void stopUpdates(void);
     virtual void onDraw(sf::RenderTarget &target, sf::RenderStates states) const = 0;
 
     TileParam mTileParam;
 
     void setHalfTextureSize(const sf::Texture &texture);
 
+    /// factor by which to scale the density of a b2CapsuleShape so that it weighs as
+    /// much as the box with two overlapping circle caps it replaces
+    static float32 capsuleDensityScale(float32 halfLength, float32 radius);
+
   private:
     bool mAlive;
     bool mVisible;
+    bool mUpdating;
 
     bool mSetHalfTextureSizeCalled;
   };
@@ -64,8 +64,10 @@ namespace Impact {
       const float t = mActivationTimer.getElapsedTime().asSeconds();
       const float scale = forthAndBack(t, 1.f, 1.2f);
       mSprite.setScale(scale, scale);
-      if (t > MaxT)
+      if (t > MaxT) {
         mActivated = false;
+        stopUpdates();
+      }
     }
   }
 
@@ -93,5 +95,6 @@ namespace Impact {
   {
     mActivationTimer.restart();
     mActivated = true;
+    startUpdates();
   }
 }
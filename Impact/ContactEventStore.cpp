@@ -0,0 +1,117 @@
+/*  
+
+    Copyright (c) 2015 Oliver Lau <ola@ct.de>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include "stdafx.h"
+
+namespace Impact {
+
+  namespace {
+
+    inline uint32_t hashPair(const Body *a, const Body *b)
+    {
+      // order independent, so that (a, b) and (b, a) meet in the same slot
+      uint64_t x = uint64_t(reinterpret_cast<uintptr_t>(a));
+      uint64_t y = uint64_t(reinterpret_cast<uintptr_t>(b));
+      if (x > y)
+        std::swap(x, y);
+      uint64_t h = x * 0x9e3779b97f4a7c15ULL ^ y;
+      h ^= h >> 29;
+      h *= 0xbf58476d1ce4e5b9ULL;
+      h ^= h >> 32;
+      return uint32_t(h);
+    }
+
+  }
+
+
+  const int32 ContactEventStore::EmptySlot = -1;
+
+
+  ContactEventStore::ContactEventStore(void)
+    : mSlots(2 * InitialCapacity, EmptySlot)
+  {
+    mEvents.reserve(InitialCapacity);
+    mEventSlots.reserve(InitialCapacity);
+  }
+
+
+  void ContactEventStore::clear(void)
+  {
+    for (std::vector<int32>::const_iterator s = mEventSlots.cbegin(); s != mEventSlots.cend(); ++s)
+      mSlots[*s] = EmptySlot;
+    mEventSlots.clear();
+    mEvents.clear();
+  }
+
+
+  int32 ContactEventStore::findSlot(const Body *a, const Body *b) const
+  {
+    const uint32_t mask = uint32_t(mSlots.size()) - 1;
+    uint32_t slot = hashPair(a, b) & mask;
+    for (;;) {
+      const int32 i = mSlots[slot];
+      if (i == EmptySlot)
+        return int32(slot);
+      const ContactEvent &e = mEvents[i];
+      if ((e.bodyA == a && e.bodyB == b) || (e.bodyA == b && e.bodyB == a))
+        return int32(slot);
+      slot = (slot + 1) & mask;
+    }
+  }
+
+
+  void ContactEventStore::grow(void)
+  {
+    mSlots.assign(2 * mSlots.size(), EmptySlot);
+    for (int32 i = 0; i < int32(mEvents.size()); ++i) {
+      const int32 slot = findSlot(mEvents[i].bodyA, mEvents[i].bodyB);
+      mSlots[slot] = i;
+      mEventSlots[i] = slot;
+    }
+  }
+
+
+  void ContactEventStore::add(Body *a, Body *b, float32 normalImpulse)
+  {
+    // keep the load factor at or below one half
+    if (2 * (mEvents.size() + 1) > mSlots.size())
+      grow();
+    const int32 slot = findSlot(a, b);
+    const int32 i = mSlots[slot];
+    if (i == EmptySlot) {
+      ContactEvent e;
+      e.bodyA = a;
+      e.bodyB = b;
+      e.maxNormalImpulse = normalImpulse;
+      e.normalImpulseSum = normalImpulse;
+      e.reports = 1;
+      mSlots[slot] = int32(mEvents.size());
+      mEventSlots.push_back(slot);
+      mEvents.push_back(e);
+    }
+    else {
+      ContactEvent &e = mEvents[i];
+      e.maxNormalImpulse = std::max(e.maxNormalImpulse, normalImpulse);
+      e.normalImpulseSum += normalImpulse;
+      ++e.reports;
+    }
+  }
+
+}
@@ -0,0 +1,85 @@
+/*  
+
+    Copyright (c) 2015 Oliver Lau <ola@ct.de>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __CONTACTEVENTSTORE_H_
+#define __CONTACTEVENTSTORE_H_
+
+#include <Box2D/Box2D.h>
+
+#include <vector>
+
+namespace Impact {
+
+  class Body;
+
+  /// all PostSolve() reports of one pair of bodies within a step
+  struct ContactEvent {
+    /// the bodies in the order of the first report
+    Body *bodyA;
+    Body *bodyB;
+    /// largest normal impulse of a single manifold point, as blocks take it as damage
+    float32 maxNormalImpulse;
+    /// sum over the reports of their largest point impulse
+    float32 normalImpulseSum;
+    int reports;
+  };
+
+
+  /// Collects the contacts reported during a step, one event per pair of
+  /// bodies, no matter how many fixtures, sub-steps or manifold points
+  /// the pair had.
+  ///
+  /// Events are stored densely in the order of their first report and
+  /// found through an open addressing table with linear probing over the
+  /// pair. clear() only resets the slots in use, so the storage is reused
+  /// from step to step. The table grows as needed; no event is dropped.
+  class ContactEventStore {
+  public:
+    ContactEventStore(void);
+
+    static const int InitialCapacity = 256;
+
+    void clear(void);
+    void add(Body *a, Body *b, float32 normalImpulse);
+
+    inline int count(void) const
+    {
+      return int(mEvents.size());
+    }
+    inline const ContactEvent &event(int i) const
+    {
+      return mEvents[i];
+    }
+
+  private:
+    static const int32 EmptySlot;
+
+    std::vector<ContactEvent> mEvents;
+    // slot of every event, to clear them
+    std::vector<int32> mEventSlots;
+    // event indexes, or EmptySlot; the size is a power of two
+    std::vector<int32> mSlots;
+
+    int32 findSlot(const Body *a, const Body *b) const;
+    void grow(void);
+  };
+
+}
+
+#endif // __CONTACTEVENTSTORE_H_
@@ -25,16 +25,38 @@ namespace Impact {
 
   std::vector<sf::Shader*>::size_type Explosion::sCurrentShaderIndex = 0;
   std::vector<sf::Shader*> Explosion::sShaders;
+  unsigned int Explosion::sDrawCalls = 0;
   Explosion::ShaderPool Explosion::sShaderPool;
 
+  static ParticleSystemDef particleSystemDef(const ExplosionDef &def)
+  {
+    ParticleSystemDef psd;
+    psd.gravityScale = def.gravityScale;
+    psd.linearDamping = def.linearDamping;
+    psd.radius = def.radius * Game::InvScale;
+    psd.density = def.density;
+    psd.friction = def.friction;
+    psd.restitution = def.restitution;
+    psd.filter.categoryBits = Body::ParticleMask;
+    psd.filter.maskBits = 0xffffU ^ Body::ParticleMask ^ Body::RacketMask;
+    if (!def.ballCollisionEnabled)
+      psd.filter.maskBits ^= Body::BallMask;
+    return psd;
+  }
+
+
   Explosion::Explosion(const ExplosionDef &def)
     : Body(Body::BodyType::Particle, def.game)
-    , mParticles(def.count)
+    , mPosition(def.pos)
+    , mParticles(def.game->world(), particleSystemDef(def))
+    , mVertices(sf::Quads)
     , mShader(nullptr)
   {
     mName = std::string("Explosion");
     setLifetime(def.maxLifetime);
     mTexture = def.texture;
+    mTexture.setRepeated(false);
+    mTexture.setSmooth(true);
 
     if (gLocalSettings().useShaders() && gLocalSettings().useShadersForExplosions()) {
       mShader = ShaderPool::getNext();
@@ -42,93 +64,60 @@ namespace Impact {
       mShader->setParameter("uMaxAge", def.maxLifetime.asSeconds());
     }
 
-    static std::uniform_int_distribution<sf::Int32> randomLifetime(def.minLifetime.asMilliseconds(), def.maxLifetime.asMilliseconds());
-    static std::uniform_real_distribution<float32> randomSpeed(def.minSpeed, def.maxSpeed);
-    static std::uniform_real_distribution<float32> randomOffset(-1.f, +1.f);
+    std::uniform_int_distribution<sf::Int32> randomLifetime(def.minLifetime.asMilliseconds(), def.maxLifetime.asMilliseconds());
+    std::uniform_real_distribution<float32> randomSpeed(def.minSpeed, def.maxSpeed);
+    std::uniform_real_distribution<float32> randomOffset(-1.f, +1.f);
 
-    b2World *world = mGame->world();
-    const int N = mParticles.size();
-    for (int i = 0; i < N; ++i) {
-      SimpleParticle &p = mParticles[i];
-      p.dead = false;
-      p.lifeTime = sf::milliseconds(randomLifetime(gRNG()));
-      p.sprite.setTexture(mTexture);
-      mTexture.setRepeated(false);
-      mTexture.setSmooth(true);
-      p.sprite.setOrigin(.5f * mTexture.getSize().x, .5f * mTexture.getSize().y);
-
-      b2BodyDef bd;
-      bd.type = b2_dynamicBody;
-      bd.position = def.pos + Game::InvScale * b2Vec2(randomOffset(gRNG()), randomOffset(gRNG()));
-      bd.fixedRotation = true;
-      bd.bullet = false;
-      bd.allowSleep = true;
-      bd.userData = this;
-      bd.gravityScale = def.gravityScale;
-      bd.linearDamping = def.linearDamping;
-      bd.linearVelocity = randomSpeed(gRNG()) * b2Vec2(randomOffset(gRNG()), randomOffset(gRNG()));
-      p.body = world->CreateBody(&bd);
-
-      b2CircleShape circleShape;
-      circleShape.m_radius = def.radius * Game::InvScale;
-
-      b2FixtureDef fd;
-      fd.density = def.density;
-      fd.restitution = def.restitution;
-      fd.friction = def.friction;
-      fd.filter.categoryBits = Body::ParticleMask;
-      fd.filter.maskBits = 0xffffU ^ Body::ParticleMask ^ Body::RacketMask;
-      if (!def.ballCollisionEnabled)
-        fd.filter.maskBits ^= Body::BallMask;
-      fd.shape = &circleShape;
-      p.body->CreateFixture(&fd);
+    mParticles.reserve(def.count);
+    for (unsigned int i = 0; i < def.count; ++i) {
+      const float32 lifetime = 1e-3f * randomLifetime(gRNG());
+      const b2Vec2 pos = def.pos + Game::InvScale * b2Vec2(randomOffset(gRNG()), randomOffset(gRNG()));
+      const b2Vec2 velocity = randomSpeed(gRNG()) * b2Vec2(randomOffset(gRNG()), randomOffset(gRNG()));
+      mParticles.add(pos, velocity, lifetime);
     }
+    startUpdates();
   }
 
 
-  Explosion::~Explosion()
+  void Explosion::onUpdate(float elapsedSeconds)
   {
-    b2World *world = mGame->world();
-    for (std::vector<SimpleParticle>::const_iterator p = mParticles.cbegin(); p != mParticles.cend(); ++p) {
-      if (!p->dead)
-        world->DestroyBody(p->body);
-    }
-  }
-
-
-  void Explosion::onUpdate(float)
-  {
-    bool allDead = true;
-    const int N = mParticles.size();
+    const float age = this->age().asSeconds();
+    mParticles.step(elapsedSeconds, age);
+
+    const int N = mParticles.count();
+    const float hw = .5f * float(mTexture.getSize().x);
+    const float hh = .5f * float(mTexture.getSize().y);
+    const sf::Vector2f texSize(float(mTexture.getSize().x), float(mTexture.getSize().y));
+    mVertices.resize(4 * N);
     for (int i = 0; i < N; ++i) {
-      SimpleParticle &p = mParticles[i];
-      if (age() > p.lifeTime && !p.dead) {
-        p.dead = true;
-        mGame->world()->DestroyBody(p.body);
-      }
-      else {
-        p.sprite.setPosition(float(Game::Scale) * sf::Vector2f(p.body->GetPosition().x, p.body->GetPosition().y));
-        if (mShader == nullptr) {
-          const float alpha = Easing<float>::quadEaseIn(age().asSeconds(), 0U, 255U, p.lifeTime.asSeconds());
-          p.sprite.setColor(sf::Color(255U, 255U, 255U, 255U - sf::Uint8(alpha)));
-        }
+      const sf::Vector2f center(float(Game::Scale) * mParticles.x(i), float(Game::Scale) * mParticles.y(i));
+      sf::Color color(255U, 255U, 255U, 255U);
+      if (mShader == nullptr) {
+        const float alpha = Easing<float>::quadEaseIn(age, 0U, 255U, mParticles.lifetime(i));
+        color.a = 255U - sf::Uint8(alpha);
       }
-      allDead &= p.dead;
+      sf::Vertex *quad = &mVertices[4 * i];
+      quad[0] = sf::Vertex(center + sf::Vector2f(-hw, -hh), color, sf::Vector2f(0.f, 0.f));
+      quad[1] = sf::Vertex(center + sf::Vector2f(+hw, -hh), color, sf::Vector2f(texSize.x, 0.f));
+      quad[2] = sf::Vertex(center + sf::Vector2f(+hw, +hh), color, texSize);
+      quad[3] = sf::Vertex(center + sf::Vector2f(-hw, +hh), color, sf::Vector2f(0.f, texSize.y));
     }
-    if (allDead || overAge())
+    if (N == 0 || overAge())
       this->kill();
   }
 
 
   void Explosion::onDraw(sf::RenderTarget &target, sf::RenderStates states) const
   {
+    if (mVertices.getVertexCount() == 0)
+      return;
     if (mShader != nullptr) {
       mShader->setParameter("uAge", age().asSeconds());
       states.shader = mShader;
     }
-    for (std::vector<SimpleParticle>::const_iterator p = mParticles.cbegin(); p != mParticles.cend(); ++p)
-      if (!p->dead)
-        target.draw(p->sprite, states);
+    states.texture = &mTexture;
+    target.draw(mVertices, states);
+    ++sDrawCalls;
   }
 
 }
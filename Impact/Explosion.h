@@ -18,8 +18,8 @@
 */
 
 
-#ifndef __PARTICLESYSTEM_H_
-#define __PARTICLESYSTEM_H_
+#ifndef __EXPLOSION_H_
+#define __EXPLOSION_H_
 
 #include <Box2D/Box2D.h>
 
@@ -29,19 +29,11 @@
 #include <vector>
 
 #include "Body.h"
+#include "ParticleSystem.h"
 #include "Impact.h"
 
 namespace Impact {
   
-  struct SimpleParticle 
-  {
-    b2Body *body;
-    sf::Time lifeTime;
-    bool dead;
-    sf::Sprite sprite;
-  };
-
-
   struct ExplosionDef
   {
     ExplosionDef(Game *game, const b2Vec2 &pos)
@@ -82,14 +74,30 @@ namespace Impact {
   {
   public:
     Explosion(const ExplosionDef &);
-    virtual ~Explosion();
 
     // Body implementation
     virtual void onUpdate(float elapsedSeconds);
     virtual void onDraw(sf::RenderTarget &target, sf::RenderStates states) const;
+    virtual inline const b2Vec2 &position(void) const
+    {
+      return mPosition;
+    }
+
+    /// number of draw calls issued by all explosions since the last call of resetDrawCalls()
+    static inline unsigned int drawCalls(void)
+    {
+      return sDrawCalls;
+    }
+    static inline void resetDrawCalls(void)
+    {
+      sDrawCalls = 0;
+    }
 
   private:
-    std::vector<SimpleParticle> mParticles;
+    b2Vec2 mPosition;
+    ParticleSystem mParticles;
+    sf::VertexArray mVertices;
+    static unsigned int sDrawCalls;
 
     sf::Shader *mShader;
 
@@ -133,4 +141,4 @@ namespace Impact {
 
 }
 
-#endif // __PARTICLESYSTEM_H_
+#endif // __EXPLOSION_H_
@@ -84,6 +84,42 @@ namespace Impact {
     virtual void onDraw(sf::RenderTarget &, sf::RenderStates) const {}
   };
 
+  // finds the closest body that stops a laser beam; balls, the racket,
+  // the ground and bodies killed earlier in the step let it pass
+  class LaserRayCast : public b2RayCastCallback
+  {
+  public:
+    LaserRayCast(void)
+      : mBody(nullptr)
+    { /* ... */ }
+
+    float32 ReportFixture(b2Fixture *fixture, const b2Vec2 &point, const b2Vec2 &normal, float32 fraction)
+    {
+      UNUSED(normal);
+      Body *body = reinterpret_cast<Body*>(fixture->GetUserData());
+      if (fixture->IsSensor() || body == nullptr || !body->isAlive())
+        return -1.f;
+      if (body->type() == Body::BodyType::Ball || body->type() == Body::BodyType::Racket || body->type() == Body::BodyType::Ground)
+        return -1.f;
+      mBody = body;
+      mPoint = point;
+      return fraction;
+    }
+
+    inline Body *body(void) const
+    {
+      return mBody;
+    }
+    inline const b2Vec2 &point(void) const
+    {
+      return mPoint;
+    }
+
+  private:
+    Body *mBody;
+    b2Vec2 mPoint;
+  };
+
 
   const float32 Game::InvScale = 1.f / Game::Scale;
   const b2Vec2 Game::DefaultCenter = b2Vec2(.5f * Game::DefaultTilesHorizontally, .5f * Game::DefaultTilesVertically);
@@ -96,6 +132,8 @@ namespace Impact {
   const int64_t Game::NewLifeAfterSoManyPointsDefault = 100000LL; //MOD Extraball
   const int Game::DefaultForceNewBallPenalty = 500;
   const sf::Time Game::DefaultPenaltyInterval = sf::milliseconds(100); //MOD Strafe
+  const sf::Time Game::DefaultLaserInterval = sf::milliseconds(150);
+  const float Game::DefaultLaserImpulse = 30.f;
 
   const sf::Time Game::DefaultFadeEffectDuration = sf::milliseconds(150);
   const sf::Time Game::DefaultAberrationEffectDuration = sf::milliseconds(250);
@@ -120,13 +158,14 @@ namespace Impact {
   };
 #endif
 
-  Game::Game(void)
-    : mWorld(nullptr)
+  Game::Game(RunMode runMode)
+    : mRunMode(runMode)
+    , mWorld(nullptr)
     , mDisplayCount(0)
+    , mSessionRecorder(nullptr)
     , mBallHasBeenLost(false)
     , mRacket(nullptr)
     , mGround(nullptr)
-    , mContactPointCount(0)
     , mLevelScore(0)
     , mNewHighscore(false)
     , mLives(DefaultLives)
@@ -137,6 +176,7 @@ namespace Impact {
     , mLastState(State::NoState)
     , mPlaymode(Playmode::Campaign)
     , mKeyMapping(Action::LastAction)
+    , mBodiesKilled(false)
     , mBlockCount(0)
     , mFadeEffectsActive(0)
     , mFadeEffectsDarken(false)
@@ -145,6 +185,7 @@ namespace Impact {
     , mEarthquakeDuration(DefaultEarthquakeDuration)
     , mScaleGravityEnabled(false)
     , mScaleBallDensityEnabled(false)
+    , mLaserEnabled(false)
     , mAberrationIntensity(0.f)
     , mBlurPlayground(false)
     , mKeyholeEffect(false)
@@ -215,6 +256,13 @@ namespace Impact {
 
     resize();
 
+    if (mRunMode == Headless) {
+      // settings are not saved in headless mode, so muting here is not permanent
+      mWindow.setVisible(false);
+      gLocalSettings().setMusicVolume(0.f);
+      gLocalSettings().setSoundFXVolume(0.f);
+    }
+
     initSounds();
 
     sf::Image icon;
@@ -355,7 +403,13 @@ namespace Impact {
     mKeyMapping[RecoverBallAction] = sf::Keyboard::N; //MOD Tasten
 
     initShaderDependants();
+    initCollisionHandlers();
 
+    mStepScheduler.setEnabled(gLocalSettings().adaptiveStepping());
+    if (gLocalSettings().logStepSchedule())
+      mStepScheduler.setLog(&std::clog);
+
+    b2SetAllocator(&mWorldArena);
     restart();
 
     mRecorderClock.restart();
@@ -377,7 +431,8 @@ namespace Impact {
 #endif
 #endif
 
-    enumerateAllLevels();
+    if (mRunMode == Interactive)
+      enumerateAllLevels();
   }
 
 
@@ -394,8 +449,12 @@ namespace Impact {
       delete mRec;
     }
 #endif
-    gLocalSettings().save();
-    clearWorld();
+    if (mSessionRecorder != nullptr)
+      delete mSessionRecorder;
+    if (mRunMode == Interactive)
+      gLocalSettings().save();
+    safeDelete(mWorld);
+    b2SetAllocator(nullptr);
   }
 
 
@@ -737,20 +796,13 @@ namespace Impact {
   {
     clearWorld();
 
-    safeRenew(mWorld, new b2World(b2Vec2(0.f, DefaultGravity)));
-    mWorld->SetAllowSleeping(true);
-    mWorld->SetWarmStarting(true);
-    mWorld->SetContinuousPhysics(false);
-    mWorld->SetContactListener(this);
-    mWorld->SetSubStepping(true);
-
     mExtraLifeIndex = 0;
     mLives = DefaultLives;
     mLevelScore = 0;
     mBallHasBeenLost = false;
     mLevel.set(0, false);
 
-    mContactPointCount = 0;
+    mContactEvents.clear();
 
     if (gLocalSettings().useShaders()) {
       mMixShader.setParameter("uColorMix", sf::Color(255U, 255U, 255U, 255U));
@@ -764,18 +816,43 @@ namespace Impact {
   }
 
 
+  void Game::createWorld(void)
+  {
+    mWorld = new b2World(b2Vec2(0.f, DefaultGravity));
+    mWorld->SetAllowSleeping(true);
+    mWorld->SetWarmStarting(true);
+    mWorld->SetContinuousPhysics(false);
+    mWorld->SetContactListener(this);
+    mWorld->SetSubStepping(true);
+    // balls are bullets; stop them at blocks and walls without TOI sub-steps
+    mWorld->SetSpeculativeBullets(true);
+    const int physicsThreads = gLocalSettings().physicsThreads();
+    mWorld->SetThreadCount(physicsThreads > 0 ? physicsThreads : int(std::thread::hardware_concurrency()));
+    // recorded sessions must replay the same on every machine
+    mWorld->SetDeterministic(true);
+  }
+
+
   void Game::clearWorld(void)
   {
     mBalls.clear();
-    if (mWorld != nullptr) {
-      b2Body *node = mWorld->GetBodyList();
-      while (node) {
-        b2Body *body = node;
-        node = node->GetNext();
-        mWorld->DestroyBody(body);
-      }
-    }
     mBodies.clear();
+    mUpdatedBodies.clear();
+    mBodiesKilled = false;
+    // Box2D allocates everything in mWorldArena, so instead of destroying
+    // bodies, fixtures, contacts and joints one by one the world is dropped
+    // and its memory released at once
+#ifndef NDEBUG
+    if (mWorld != nullptr && mWorld->GetBodyCount() > 0)
+      std::cout << "stack allocators: high-water mark " << (mWorld->GetStackMaxAllocation() >> 10) << " KB, " << mWorld->GetStackOverflowCount() << " overflows" << std::endl;
+#endif
+    if (mWorld != nullptr)
+      mWorld->SetAbandonMemory(true);
+    safeDelete(mWorld);
+    mWorldArena.Reset();
+    createWorld();
+    mLaserShots.clear();
+    mLaserBeams.clear();
   }
 
 
@@ -810,6 +887,12 @@ namespace Impact {
   }
 
 
+  void Game::recordSession(const std::string &filename)
+  {
+    safeRenew(mSessionRecorder, new SessionRecorder(filename));
+  }
+
+
 
   void Game::clearEventQueue(void)
   {
@@ -954,6 +1037,8 @@ namespace Impact {
 
   void Game::loadLevelFromZip(const std::string &zipFilename)
   {
+    if (mSessionRecorder != nullptr)
+      mSessionRecorder->setLevelZip(zipFilename);
     mLevel.loadZip(zipFilename);
     if (mLevel.isAvailable())
       gotoCurrentLevel();
@@ -1374,6 +1459,9 @@ namespace Impact {
     }
     mScaleGravityEnabled = false;
     mScaleBallDensityEnabled = false;
+    mLaserEnabled = false;
+    mStepScheduler.setGravityScale(1.f);
+    mStepScheduler.setDensityScale(1.f);
     mKeyholeEffect = false;
     if (mLevel.isAvailable()) {
       if (mPlaymode == Campaign)
@@ -1403,6 +1491,8 @@ namespace Impact {
       mPenaltyClock.restart();
       mLevelScore = 0;
       mWindow.setFramerateLimit(gLocalSettings().framerateLimit());
+      if (mSessionRecorder != nullptr)
+        mSessionRecorder->levelStarted(mLevel.num());
     }
     else {
       gotoPlayerWon();
@@ -1421,6 +1511,7 @@ namespace Impact {
 
   void Game::onPlaying(void)
   {
+    bool newBallRequested = false;
     sf::Event event;
     while (mWindow.pollEvent(event)) {
       switch (event.type)
@@ -1441,8 +1532,10 @@ namespace Impact {
         }
         break;
       case sf::Event::MouseButtonPressed:
-        if (mBalls.empty())
+        if (mBalls.empty()) {
           newBall();
+          newBallRequested = true;
+        }
         break;
       case sf::Event::KeyPressed:
         if (event.key.code == mKeyMapping[PauseAction]) {
@@ -1458,6 +1551,7 @@ namespace Impact {
         else if (event.key.code == mKeyMapping[RecoverBallAction] || event.key.code == sf::Keyboard::Space) {
           if (mBalls.empty()) {
             newBall();
+            newBallRequested = true;
           }
           else {
             const b2Vec2 &padPos = mRacket->position();
@@ -1472,34 +1566,23 @@ namespace Impact {
       }
     }
 
-    if (!mBalls.empty()) { // check if ball has been kicked out of the screen
-      for (std::vector<Ball*>::iterator b = mBalls.begin(); b != mBalls.end(); ++b) {
-        Ball *ball = *b;
-        if (ball != nullptr) {
-          const float ballX = ball->position().x;
-          const float ballY = ball->position().y;
-          if (0 > ballX || ballX > float(mLevel.width()) || 0 > ballY) {
-            ball->kill();
-          }
-          else if (ballY > mLevel.height()) {
-            ball->lethalHit();
-            ball->kill();
-          }
-        }
-      }
-    }
-
     if (mRacket != nullptr) {
+      int kick = 0;
       if (sf::Mouse::isButtonPressed(sf::Mouse::Left)) {
         mRacket->kickLeft();
+        kick = -1;
       }
       else if (sf::Mouse::isButtonPressed(sf::Mouse::Right)) {
         mRacket->kickRight();
+        kick = 1;
       }
       else {
         mRacket->stopKick();
       }
 
+      if (mLaserEnabled && (sf::Mouse::isButtonPressed(sf::Mouse::Middle) || sf::Keyboard::isKeyPressed(sf::Keyboard::F)))
+        fireLaser();
+
       sf::Vector2i mousePos = sf::Mouse::getPosition(mWindow);
 
       if (mFPS < 200) {
@@ -1526,11 +1609,40 @@ namespace Impact {
       }
 
       mRacket->moveTo(InvScale * b2Vec2(float32(mousePos.x), float32(mousePos.y)));
+
+      if (mSessionRecorder != nullptr)
+        mSessionRecorder->tick(InvScale * mousePos.x, kick, newBallRequested);
+    }
+
+    updatePlayground();
+    update();
+    drawPlayground();
+  }
+
+
+  void Game::updatePlayground(void)
+  {
+    if (!mBalls.empty()) { // check if ball has been kicked out of the screen
+      for (std::vector<Ball*>::iterator b = mBalls.begin(); b != mBalls.end(); ++b) {
+        Ball *ball = *b;
+        if (ball != nullptr) {
+          const float ballX = ball->position().x;
+          const float ballY = ball->position().y;
+          if (0 > ballX || ballX > float(mLevel.width()) || 0 > ballY) {
+            ball->kill();
+          }
+          else if (ballY > mLevel.height()) {
+            ball->lethalHit();
+            ball->kill();
+          }
+        }
+      }
     }
 
     if (mScaleGravityEnabled && mScaleGravityClock.getElapsedTime() > mScaleGravityDuration) {
       mWorld->SetGravity(b2Vec2(0.f, mLevel.gravity()));
       mScaleGravityEnabled = false;
+      mStepScheduler.setGravityScale(1.f);
     }
 
     if (mScaleBallDensityEnabled && mScaleBallDensityClock.getElapsedTime() > mScaleBallDensityDuration) {
@@ -1541,10 +1653,12 @@ namespace Impact {
         }
       }
       mScaleBallDensityEnabled = false;
+      mStepScheduler.setDensityScale(1.f);
     }
 
-    update();
-    drawPlayground();
+    if (mLaserEnabled && mLaserClock.getElapsedTime() > mLaserDuration) {
+      mLaserEnabled = false;
+    }
   }
 
 
@@ -2071,7 +2185,7 @@ namespace Impact {
   }
 
 
-  inline void Game::executeVignette(sf::RenderTexture &out, sf::RenderTexture &in, bool copyBack)
+  void Game::executeVignette(sf::RenderTexture &out, sf::RenderTexture &in, bool copyBack)
   {
     if (gLocalSettings().useShaders()) {
       if (mRacket != nullptr && !mBalls.empty()) {
@@ -2087,7 +2201,7 @@ namespace Impact {
   }
 
 
-  inline void Game::executeKeyhole(sf::RenderTexture &out, sf::RenderTexture &in, const b2Vec2 &center, bool copyBack)
+  void Game::executeKeyhole(sf::RenderTexture &out, sf::RenderTexture &in, const b2Vec2 &center, bool copyBack)
   {
     if (gLocalSettings().useShaders()) {
       sf::RenderStates states;
@@ -2102,7 +2216,7 @@ namespace Impact {
   }
 
 
-  inline void Game::executeAberration(sf::RenderTexture &out, sf::RenderTexture &in, bool copyBack)
+  void Game::executeAberration(sf::RenderTexture &out, sf::RenderTexture &in, bool copyBack)
   {
     if (gLocalSettings().useShaders()) {
       sf::RenderStates states;
@@ -2134,7 +2248,7 @@ namespace Impact {
   }
 
 
-  inline void Game::executeBlur(sf::RenderTexture &out, sf::RenderTexture &in, bool copyBack)
+  void Game::executeBlur(sf::RenderTexture &out, sf::RenderTexture &in, bool copyBack)
   {
     UNUSED(copyBack);
     if (gLocalSettings().useShaders()) {
@@ -2171,7 +2285,7 @@ namespace Impact {
   }
 
 
-  inline void Game::executeEarthquake(sf::RenderTexture &out, sf::RenderTexture &in, bool copyBack)
+  void Game::executeEarthquake(sf::RenderTexture &out, sf::RenderTexture &in, bool copyBack)
   {
     if (gLocalSettings().useShaders()) {
       sf::Sprite sprite(in.getTexture());
@@ -2251,7 +2365,7 @@ namespace Impact {
 
 
 
-  inline void Game::executeCopy(sf::RenderTexture &out, sf::RenderTexture &in)
+  void Game::executeCopy(sf::RenderTexture &out, sf::RenderTexture &in)
   {
     sf::Sprite sprite(in.getTexture());
     out.draw(sprite);
@@ -2264,14 +2378,7 @@ namespace Impact {
     clearWindow();
 
     if (gLocalSettings().useShaders()) {
-      mRenderTexture0.clear(mLevel.backgroundColor());
-      mRenderTexture0.draw(mLevel.backgroundSprite());
-
-      for (BodyList::const_iterator b = mBodies.cbegin(); b != mBodies.cend(); ++b) {
-        const Body *body = *b;
-        if (body->isAlive())
-          mRenderTexture0.draw(*body);
-      }
+      drawScene(mRenderTexture0);
 
       if (mKeyholeEffect && mBalls.size() > 0 && gLocalSettings().useShaders()) {
         std::vector<Ball*>::const_iterator ball;
@@ -2330,13 +2437,7 @@ namespace Impact {
       mWindow.draw(sprite, states);
     }
     else { // !gLocalSettings().useShaders
-      mWindow.clear(mLevel.backgroundColor());
-      mWindow.draw(mLevel.backgroundSprite());
-      for (BodyList::const_iterator b = mBodies.cbegin(); b != mBodies.cend(); ++b) {
-        const Body *body = *b;
-        if (body->isAlive())
-          mWindow.draw(*body);
-      }
+      drawScene(mWindow);
     }
 
     if (mOverlayDuration > sf::Time::Zero) {
@@ -2401,6 +2502,19 @@ namespace Impact {
   }
 
 
+  void Game::drawScene(sf::RenderTarget &target)
+  {
+    target.clear(mLevel.backgroundColor());
+    target.draw(mLevel.backgroundSprite());
+    for (BodyList::const_iterator b = mBodies.cbegin(); b != mBodies.cend(); ++b) {
+      const Body *body = *b;
+      if (body->isAlive())
+        target.draw(*body);
+    }
+    target.draw(mLaserBeams);
+  }
+
+
   void Game::updateStats(void)
   {
     if (mStatsClock.getElapsedTime() > sf::milliseconds(33)) {
@@ -2439,129 +2553,232 @@ namespace Impact {
   }
 
 
-  void Game::evaluateCollisions(void)
+  void Game::initCollisionHandlers(void)
   {
-    std::list<Body*> killedBodies;
+    for (int i = 0; i < Body::BodyTypeCount; ++i)
+      for (int j = 0; j < Body::BodyTypeCount; ++j)
+        mCollisionHandlers[i][j] = nullptr;
+    // a bumper kicks away whatever hits it
+    for (int j = Body::BodyType::Bumper; j < Body::BodyTypeCount; ++j)
+      mCollisionHandlers[Body::BodyType::Bumper][j] = &Game::onBumperHit;
+    mCollisionHandlers[Body::BodyType::Block][Body::BodyType::Ball] = &Game::onBlockHitByBall;
+    mCollisionHandlers[Body::BodyType::Block][Body::BodyType::Racket] = &Game::onBlockHitRacket;
+    mCollisionHandlers[Body::BodyType::Block][Body::BodyType::Ground] = &Game::onBlockHitGround;
+    mCollisionHandlers[Body::BodyType::Ball][Body::BodyType::Racket] = &Game::onBallHitRacket;
+    mCollisionHandlers[Body::BodyType::Ball][Body::BodyType::Ground] = &Game::onBallHitGround;
+  }
 
-    auto isAlive = [&killedBodies](Body *body) {
-      return std::find(killedBodies.cbegin(), killedBodies.cend(), body) == killedBodies.cend();
-    }; // You find this a somewhat obscure syntax? Google "c++ lambda functions closures" ;-)
 
-    for (int i = 0; i < mContactPointCount; ++i) {
-      ContactPoint &cp = mPoints[i];
-      Body *a = reinterpret_cast<Body *>(cp.fixtureA->GetUserData());
-      Body *b = reinterpret_cast<Body *>(cp.fixtureB->GetUserData());
-      if (a == nullptr || b == nullptr)
+  void Game::evaluateCollisions(void)
+  {
+    for (int i = 0; i < mContactEvents.count(); ++i) {
+      const ContactEvent &e = mContactEvents.event(i);
+      Body *a = e.bodyA;
+      Body *b = e.bodyB;
+      // bodies killed by an earlier event of this step are removed at the end of update()
+      if (!a->isAlive() || !b->isAlive())
         continue;
-      if (a->type() == Body::BodyType::Block || b->type() == Body::BodyType::Block) {
-        if (a->type() == Body::BodyType::Ball || b->type() == Body::BodyType::Ball) {
-          Block *block = reinterpret_cast<Block*>(a->type() == Body::BodyType::Block ? a : b);
-          if (isAlive(block)) {
-            bool destroyed = block->hit(cp.normalImpulse);
-            if (destroyed) {
-              block->kill();
-              showScore(block->getScore(), block->position());
-              killedBodies.push_back(block);
-            }
-            else if (cp.normalImpulse > 20)
-              playSound(mBlockHitSound, block->position());
-          }
-        }
-        else if (a->type() == Body::BodyType::Ground || b->type() == Body::BodyType::Ground) {
-          Block *block = reinterpret_cast<Block*>(a->type() == Body::BodyType::Block ? a : b);
-          if (isAlive(block)) {
-            block->kill();
-            killedBodies.push_back(block);
-          }
-        }
-        else if (a->type() == Body::BodyType::Racket || b->type() == Body::BodyType::Racket) {
-          Block *block = reinterpret_cast<Block*>(a->type() == Body::BodyType::Block ? a : b);
-          if (block->body()->GetGravityScale() > 0.f) {
-            if (isAlive(block)) {
-              showScore(block->getScore(), block->position(), 2);
-              block->kill();
-              playSound(mRacketHitBlockSound, block->position());
-              killedBodies.push_back(block);
-            }
-          }
-          else {
-            if (mPenaltyClock.getElapsedTime() > DefaultPenaltyInterval) {
-              showScore(-block->getScore(), block->position());
-              playSound(mPenaltySound, block->position());
-              startFadeEffect();
-              mPenaltyClock.restart();
-            }
-          }
-        }
+      if (b->type() < a->type())
+        std::swap(a, b);
+      const CollisionHandler handler = mCollisionHandlers[a->type()][b->type()];
+      if (handler != nullptr)
+        (this->*handler)(a, b, e);
+    }
+  }
+
+
+  void Game::onBlockHitByBall(Body *body, Body *, const ContactEvent &e)
+  {
+    Block *block = reinterpret_cast<Block*>(body);
+    bool destroyed = block->hit(e.maxNormalImpulse);
+    if (destroyed) {
+      block->kill();
+      showScore(block->getScore(), block->position());
+    }
+    else if (e.maxNormalImpulse > 20)
+      playSound(mBlockHitSound, block->position());
+  }
+
+
+  void Game::onBlockHitRacket(Body *body, Body *, const ContactEvent &)
+  {
+    Block *block = reinterpret_cast<Block*>(body);
+    if (block->body()->GetGravityScale() > 0.f) {
+      showScore(block->getScore(), block->position(), 2);
+      block->kill();
+      playSound(mRacketHitBlockSound, block->position());
+    }
+    else {
+      if (mPenaltyClock.getElapsedTime() > DefaultPenaltyInterval) {
+        showScore(-block->getScore(), block->position());
+        playSound(mPenaltySound, block->position());
+        startFadeEffect();
+        mPenaltyClock.restart();
       }
-      else if (a->type() == Body::BodyType::Ball || b->type() == Body::BodyType::Ball) {
-        Ball *ball = reinterpret_cast<Ball*>(a->type() == Body::BodyType::Ball ? a : b);
-        if (a->type() == Body::BodyType::Ground || b->type() == Body::BodyType::Ground) {
-          if (isAlive(ball)) {
-            ball->lethalHit();
-            ball->kill();
-            killedBodies.push_back(ball);
-            startFadeEffect(true, sf::milliseconds(350));
-          }
+    }
+  }
+
+
+  void Game::onBlockHitGround(Body *block, Body *, const ContactEvent &)
+  {
+    block->kill();
+  }
+
+
+  void Game::onBallHitRacket(Body *ball, Body *, const ContactEvent &e)
+  {
+    if (e.maxNormalImpulse > 20)
+      playSound(mRacketHitSound, ball->position());
+  }
+
+
+  void Game::onBallHitGround(Body *ball, Body *, const ContactEvent &)
+  {
+    ball->lethalHit();
+    ball->kill();
+    startFadeEffect(true, sf::milliseconds(350));
+  }
+
+
+  void Game::onBumperHit(Body *body, Body *other, const ContactEvent &)
+  {
+    Bumper *bumper = reinterpret_cast<Bumper*>(body);
+    playSound(mBumperSound, bumper->position());
+    if (other->type() == Body::BodyType::Ball)
+      addToScore(bumper->getScore());
+    bumper->activate();
+    b2Vec2 impulse = other->position() - bumper->position();
+    impulse.Normalize();
+    other->body()->ApplyLinearImpulse(bumper->tileParam().bumperImpulse * impulse, other->body()->GetPosition(), true);
+  }
+
+
+  void Game::fireLaser(void)
+  {
+    if (mLaserFireClock.getElapsedTime() < DefaultLaserInterval)
+      return;
+    mLaserFireClock.restart();
+    // one beam from either end of the racket, straight against gravity
+    const b2Vec2 &pos = mRacket->position();
+    const b2AABB &aabb = mRacket->aabb();
+    const float32 up = mLevel.gravity() < 0.f ? 1.f : -1.f;
+    const float32 y = pos.y + (up < 0.f ? aabb.lowerBound.y : aabb.upperBound.y);
+    const float32 inset = .2f * (aabb.upperBound.x - aabb.lowerBound.x);
+    LaserShot shot;
+    shot.from.Set(pos.x + aabb.lowerBound.x + inset, y);
+    shot.to.Set(shot.from.x, y + up * float32(mLevel.height()));
+    mLaserShots.push_back(shot);
+    shot.from.x = pos.x + aabb.upperBound.x - inset;
+    shot.to.x = shot.from.x;
+    mLaserShots.push_back(shot);
+  }
+
+
+  void Game::evaluateLaserShots(void)
+  {
+    // hitscan: all shots of the tick are cast against the world after the step,
+    // so firing never adds bodies, proxies or continuous collision work
+    for (std::vector<LaserShot>::const_iterator shot = mLaserShots.cbegin(); shot != mLaserShots.cend(); ++shot) {
+      LaserRayCast ray;
+      mWorld->RayCast(&ray, shot->from, shot->to);
+      Body *body = ray.body();
+      if (body != nullptr && body->type() == Body::BodyType::Block) {
+        Block *block = reinterpret_cast<Block*>(body);
+        bool destroyed = block->hit(DefaultLaserImpulse);
+        if (destroyed) {
+          block->kill();
+          showScore(block->getScore(), block->position());
         }
-        else if (a->type() == Body::BodyType::Racket || b->type() == Body::BodyType::Racket) {
-          if (cp.normalImpulse > 20)
-            playSound(mRacketHitSound, ball->position());
+        else {
+          playSound(mBlockHitSound, block->position());
         }
       }
-      if (a->type() == Body::BodyType::Bumper || b->type() == Body::BodyType::Bumper) {
-        Bumper *bumper = reinterpret_cast<Bumper*>(a->type() == Body::BodyType::Bumper ? a : b);
-        Body *other = a->type() != Body::BodyType::Bumper ? a : b;
-        playSound(mBumperSound, bumper->position());
-        if (other->type() == Body::BodyType::Ball)
-          addToScore(bumper->getScore());
-        bumper->activate();
-        b2Vec2 impulse = other->position() - bumper->position();
-        impulse.Normalize();
-        other->body()->ApplyLinearImpulse(bumper->tileParam().bumperImpulse * impulse, other->body()->GetPosition(), true);
-      }
+      mLaserBeams.add(shot->from, body != nullptr ? ray.point() : shot->to);
     }
+    mLaserShots.clear();
   }
 
 
-  inline void Game::update(void)
+  void Game::update(void)
   {
     if (mElapsed == sf::Time::Zero)
       return;
 
     const float elapsedSeconds = 1e-6f * mElapsed.asMicroseconds();
 
-    mContactPointCount = 0;
-    mWorld->Step(elapsedSeconds, gLocalSettings().velocityIterations(), gLocalSettings().positionIterations());
+    mContactEvents.clear();
+    Stopwatch stopwatch;
+    mStepScheduler.setMaxIterations(gLocalSettings().velocityIterations(), gLocalSettings().positionIterations());
+    const StepSchedule &schedule = mStepScheduler.schedule(mWorld, elapsedSeconds);
+    const float32 subStepSeconds = elapsedSeconds / schedule.subSteps;
+    mPhaseTimes.broadphase = 0;
+    for (int i = 0; i < schedule.subSteps; ++i) {
+      mWorld->Step(subStepSeconds, schedule.velocityIterations, schedule.positionIterations);
+      mPhaseTimes.broadphase += 1e3 * mWorld->GetProfile().broadphase;
+    }
+    mPhaseTimes.step = stopwatch.elapsed();
     /* Note from the Box2D manual: You should always process the
     * contact points [collected in PostSolve()] immediately after
     * the time step; otherwise some other client code might
     * alter the physics world, invalidating the contact buffer.
     */
+    stopwatch.restart();
     if (mState == State::Playing)
       evaluateCollisions();
+    if (mState == State::Playing)
+      evaluateLaserShots();
     mWorld->ClearForces();
-
-    BodyList remainingBodies;
-    for (BodyList::iterator b = mBodies.begin(); b != mBodies.end(); ++b) {
+    mPhaseTimes.collisions = stopwatch.elapsed();
+
+    stopwatch.restart();
+    // sleeping bodies do not move, so only the moved ones need new sprite
+    // transforms; these are read from the world's state arrays by body id
+    const int32 *movedBodies = mWorld->GetMovedBodies();
+    for (int i = 0; i < mWorld->GetMovedBodyCount(); ++i) {
+      const int32 id = movedBodies[i];
+      Body *body = reinterpret_cast<Body*>(mWorld->GetBodyUserData(id));
+      if (body != nullptr)
+        body->updateTransform(mWorld->GetBodyTransform(id));
+    }
+    mWorld->ClearMovedBodies();
+    mLaserBeams.update(elapsedSeconds);
+    // only bodies with time-driven effects are visited; bodies scheduled
+    // while the list is worked off are kept for the next frame
+    BodyList updatedBodies;
+    updatedBodies.swap(mUpdatedBodies);
+    for (BodyList::iterator b = updatedBodies.begin(); b != updatedBodies.end(); ++b) {
       Body *body = *b;
-      if (body != nullptr) {
-        if (body->isAlive()) {
-          body->update(elapsedSeconds);
-          remainingBodies.push_back(body);
-        }
-        else {
-          if (body->type() == Body::BodyType::Ball) {
-            const Ball *const ball = reinterpret_cast<Ball*>(body);
-            std::vector<Ball*>::iterator ball2remove = std::find(mBalls.begin(), mBalls.end(), ball);
-            mBalls.erase(ball2remove);
+      if (body->isAlive() && body->isUpdating())
+        body->update(elapsedSeconds);
+      if (body->isAlive() && body->isUpdating())
+        mUpdatedBodies.push_back(body);
+    }
+    if (mBodiesKilled) {
+      mUpdatedBodies.erase(std::remove_if(mUpdatedBodies.begin(), mUpdatedBodies.end(), [](const Body *body) {
+        return !body->isAlive();
+      }), mUpdatedBodies.end());
+      BodyList remainingBodies;
+      remainingBodies.reserve(mBodies.size());
+      for (BodyList::iterator b = mBodies.begin(); b != mBodies.end(); ++b) {
+        Body *body = *b;
+        if (body != nullptr) {
+          if (body->isAlive()) {
+            remainingBodies.push_back(body);
+          }
+          else {
+            if (body->type() == Body::BodyType::Ball) {
+              const Ball *const ball = reinterpret_cast<Ball*>(body);
+              std::vector<Ball*>::iterator ball2remove = std::find(mBalls.begin(), mBalls.end(), ball);
+              mBalls.erase(ball2remove);
+            }
+            delete body;
           }
-          delete body;
         }
       }
+      mBodies.swap(remainingBodies);
+      mBodiesKilled = false;
     }
-    mBodies = remainingBodies;
-
+    mPhaseTimes.bodies = stopwatch.elapsed();
 
     mFPSArray[mFPSIndex++] = int(1.f / mElapsed.asSeconds());
     if (mFPSIndex >= mFPSArray.size())
@@ -2597,19 +2814,13 @@ namespace Impact {
 
   void Game::PostSolve(b2Contact *contact, const b2ContactImpulse *impulse)
   {
-    if (mContactPointCount < MaxContactPoints) {
-      ContactPoint &cp = mPoints[mContactPointCount];
-      cp.fixtureA = contact->GetFixtureA();
-      cp.fixtureB = contact->GetFixtureB();
-      Body *bodyA = reinterpret_cast<Body*>(cp.fixtureA->GetUserData());
-      Body *bodyB = reinterpret_cast<Body*>(cp.fixtureB->GetUserData());
-      if (bodyA != nullptr && bodyB != nullptr) {
-        b2Manifold *manifold = contact->GetManifold();
-        cp.point = manifold->localPoint;
-        cp.normal = manifold->localNormal;
-        cp.normalImpulse = impulse->normalImpulses[0];
-        ++mContactPointCount;
-      }
+    Body *bodyA = reinterpret_cast<Body*>(contact->GetFixtureA()->GetUserData());
+    Body *bodyB = reinterpret_cast<Body*>(contact->GetFixtureB()->GetUserData());
+    if (bodyA != nullptr && bodyB != nullptr) {
+      float32 normalImpulse = 0.f;
+      for (int32 i = 0; i < impulse->count; ++i)
+        normalImpulse = std::max(normalImpulse, impulse->normalImpulses[i]);
+      mContactEvents.add(bodyA, bodyB, normalImpulse);
     }
   }
 
@@ -2693,6 +2904,7 @@ namespace Impact {
 
     // create level elements
     mBlockCount = 0;
+    std::vector<Wall*> walls(mLevel.width() * mLevel.height(), nullptr);
     for (int y = 0; y < mLevel.height(); ++y) {
       const uint32_t *mapRow = mLevel.mapDataScanLine(y);
       for (int x = 0; x < mLevel.width(); ++x) {
@@ -2720,6 +2932,7 @@ namespace Impact {
             Wall *wall = new Wall(tileId, this, tileParam);
             wall->setPosition(pos);
             addBody(wall);
+            walls[y * mLevel.width() + x] = wall;
           }
           else {
             Block *block = new Block(tileId, this, tileParam);
@@ -2730,6 +2943,16 @@ namespace Impact {
         }
       }
     }
+    buildWalls(walls);
+
+    // all proxies of the level exist now, so build their tree in one go
+#ifndef NDEBUG
+    std::cout << "broadphase tree: height " << mWorld->GetTreeHeight() << ", area ratio " << mWorld->GetTreeQuality();
+#endif
+    mWorld->RebuildTree();
+#ifndef NDEBUG
+    std::cout << " -> height " << mWorld->GetTreeHeight() << ", area ratio " << mWorld->GetTreeQuality() << " (" << mWorld->GetProxyCount() << " proxies)" << std::endl;
+#endif
 
     mLevelNameText.setString(">> " + mLevel.name() + " <<");
     mLevelNameText.setPosition(4, 52);
@@ -2740,6 +2963,34 @@ namespace Impact {
   }
 
 
+  void Game::buildWalls(const std::vector<Wall*> &walls)
+  {
+    // Walls only draw their tiles. Their collision shapes all live on
+    // one static body, with runs of equal tiles merged into single boxes,
+    // so that the number of static proxies depends on the level's layout
+    // rather than on its number of wall tiles.
+    b2BodyDef bd;
+    bd.type = b2_staticBody;
+    b2Body *body = mWorld->CreateBody(&bd);
+    const int W = mLevel.width();
+    std::vector<TileRect> rects;
+    mLevel.mergeTiles([&walls, W](int x, int y) {
+      const Wall *wall = walls[y * W + x];
+      return wall != nullptr && wall->isTileSized();
+    }, rects);
+    std::vector<TileRect>::const_iterator rect;
+    for (rect = rects.begin(); rect != rects.end(); ++rect) {
+      Wall *wall = walls[rect->y * W + rect->x];
+      wall->createFixture(body, b2Vec2(float32(rect->x), float32(rect->y)), b2Vec2(float32(rect->x + rect->width), float32(rect->y + rect->height)));
+    }
+    // walls with larger textures overlap their neighbours and keep a box of their own
+    std::vector<Wall*>::const_iterator w;
+    for (w = walls.begin(); w != walls.end(); ++w)
+      if (*w != nullptr && !(*w)->isTileSized())
+        (*w)->createFixture(body);
+  }
+
+
   void Game::displayHighscoreMessage(void)
   {
     mNewHighscoreMsg.setColor(sf::Color(255U, 255U, 255U, 160U + sf::Uint8(95 * std::sin(23 * mWallClock.getElapsedTime().asSeconds()))));
@@ -2868,12 +3119,18 @@ namespace Impact {
   }
 
 
-  inline void Game::addBody(Body *body)
+  void Game::addBody(Body *body)
   {
     mBodies.push_back(body);
   }
 
 
+  void Game::scheduleUpdates(Body *body)
+  {
+    mUpdatedBodies.push_back(body);
+  }
+
+
   void Game::resetKillingSpree(void)
   {
     for (std::vector<sf::Time>::iterator t = mLastKillings.begin(); t != mLastKillings.end(); ++t)
@@ -2945,6 +3202,8 @@ namespace Impact {
 
   void Game::onBodyKilled(Body *killedBody)
   {
+    // dead bodies are deleted at the end of update()
+    mBodiesKilled = true;
     if (killedBody->type() == Body::BodyType::Block) {
       playSound(mExplosionSound, killedBody->position());
       ExplosionDef pd(this, killedBody->position());
@@ -2975,6 +3234,8 @@ namespace Impact {
       if (tileParam.scaleGravityDuration > sf::Time::Zero) {
         mWorld->SetGravity(tileParam.scaleGravityBy * mWorld->GetGravity());
         mScaleGravityEnabled = true;
+        if (mLevel.gravity() != 0.f)
+          mStepScheduler.setGravityScale(mWorld->GetGravity().y / mLevel.gravity());
         mScaleGravityClock.restart();
         mScaleGravityDuration = tileParam.scaleGravityDuration;
         startAberrationEffect(tileParam.scaleGravityBy, tileParam.scaleGravityDuration);
@@ -2990,9 +3251,20 @@ namespace Impact {
           ball->setDensity(tileParam.scaleBallDensityBy * ball->tileParam().density.get());
         }
         mScaleBallDensityEnabled = true;
+        mStepScheduler.setDensityScale(tileParam.scaleBallDensityBy);
         mScaleBallDensityClock.restart();
         mScaleBallDensityDuration = tileParam.scaleBallDensityDuration;
       }
+      if (tileParam.laserDuration > sf::Time::Zero) {
+        mLaserEnabled = true;
+        mLaserClock.restart();
+        mLaserDuration = tileParam.laserDuration;
+        OverlayDef od;
+        od.line1 = "Laser";
+        od.line2 = std::string("for ") + std::to_string(tileParam.laserDuration.asMilliseconds() / 1000) + "s";
+        startOverlay(od);
+        addSpecialEffect(SpecialEffect(mLaserDuration, &mLaserClock, killedBody->texture()));
+      }
       if (tileParam.multiball) {
         newBall(killedBody->position());
         playSound(mMultiballSound);
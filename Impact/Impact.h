@@ -33,6 +33,10 @@
 #include "Racket.h"
 #include "Ground.h"
 #include "ScrollArea.h"
+#include "Session.h"
+#include "StepScheduler.h"
+#include "ContactEventStore.h"
+#include "LaserBeams.h"
 
 #ifndef NO_RECORDER
 #include "Recorder.h"
@@ -45,6 +49,7 @@
 namespace Impact {
 
   class Game;
+  class Wall;
 
   struct SpecialEffect {
     SpecialEffect(void)
@@ -71,12 +76,27 @@ namespace Impact {
     sf::Clock *clock;
   };
 
-  struct ContactPoint {
-    b2Fixture *fixtureA;
-    b2Fixture *fixtureB;
-    b2Vec2 normal;
-    float32 normalImpulse;
-    b2Vec2 point;
+
+  /// durations of the phases of the last Game::update() in microseconds
+  struct PhaseTimes {
+    PhaseTimes(void)
+      : step(0)
+      , broadphase(0)
+      , collisions(0)
+      , bodies(0)
+    { /* ... */ }
+    double step;
+    // part of step spent finding new contacts, as profiled by Box2D
+    double broadphase;
+    double collisions;
+    double bodies;
+  };
+
+
+  /// a ray of the racket's laser, cast in the next Game::update()
+  struct LaserShot {
+    b2Vec2 from;
+    b2Vec2 to;
   };
 
 
@@ -104,6 +124,8 @@ namespace Impact {
 
   class Game : public b2ContactListener {
 
+    friend class PerfHarness;
+
     typedef enum _Playmode {
       Campaign,
       SingleLevel,
@@ -149,8 +171,15 @@ namespace Impact {
     static const char* StateNames[State::LastState];
 #endif
 
+    typedef void (Game::*CollisionHandler)(Body *a, Body *b, const ContactEvent &);
+
 
   public:
+    typedef enum _RunMode {
+      Interactive,
+      Headless
+    } RunMode;
+
     static const int Scale = 16;
     static const float32 InvScale;
     static const unsigned int DefaultTilesHorizontally = 40U;
@@ -169,22 +198,25 @@ namespace Impact {
     static const int64_t NewLifeAfterSoManyPoints[];
     static const int MaxSoundFX = 16;
     static const int DefaultForceNewBallPenalty;
-    static const int32 MaxContactPoints = 512;
     static const sf::Time DefaultFadeEffectDuration;
     static const sf::Time DefaultAberrationEffectDuration;
     static const sf::Time DefaultEarthquakeDuration;
     static const sf::Time DefaultOverlayDuration;
     static const sf::Time DefaultPenaltyInterval;
+    static const sf::Time DefaultLaserInterval;
+    static const float DefaultLaserImpulse;
     static const unsigned int DefaultKillingsPerKillingSpree;
     static const unsigned int DefaultKillingSpreeBonus;
     static const sf::Time DefaultKillingSpreeInterval;
     static const float DefaultWallRestitution;
 
-    Game(void);
+    Game(RunMode runMode = Interactive);
     ~Game();
     void setLevelZip(const char *zipFilename);
+    void recordSession(const std::string &filename);
     void loop(void);
     void addBody(Body *body);
+    void scheduleUpdates(Body *body);
     void initSounds(void);
     void initShaderDependants(void);
     void clearEventQueue(void);
@@ -212,6 +244,7 @@ namespace Impact {
     void onBodyKilled(Body *body);
 
   private:
+    RunMode mRunMode;
     unsigned int mNumProcessors;
 #if defined(WIN32)
     HANDLE mMyProcessHandle;
@@ -325,6 +358,12 @@ namespace Impact {
     sf::Clock mScaleBallDensityClock;
     sf::Time mScaleBallDensityDuration;
     bool mScaleBallDensityEnabled;
+    sf::Clock mLaserClock;
+    sf::Time mLaserDuration;
+    bool mLaserEnabled;
+    sf::Clock mLaserFireClock;
+    std::vector<LaserShot> mLaserShots;
+    LaserBeams mLaserBeams;
     bool mNewHighscore;
     sf::Text mNewHighscoreMsg;
     sf::Text mLevelCompletedMsg;
@@ -360,10 +399,15 @@ namespace Impact {
     int mFPS;
 
     // Box2D
+    // holds all memory of the current world, see clearWorld()
+    b2ArenaAllocator mWorldArena;
     b2World *mWorld;
     Ground *mGround;
-    ContactPoint mPoints[MaxContactPoints];
-    int32 mContactPointCount;
+    ContactEventStore mContactEvents;
+    // indexed by the types of both bodies, lower type first
+    CollisionHandler mCollisionHandlers[Body::BodyTypeCount][Body::BodyTypeCount];
+    PhaseTimes mPhaseTimes;
+    StepScheduler mStepScheduler;
 
     // b2ContactListener interface
     virtual void PreSolve(b2Contact* contact, const b2Manifold* oldManifold);
@@ -379,6 +423,9 @@ namespace Impact {
     int64_t mTotalScore;
     unsigned int mLives;
     BodyList mBodies;
+    // bodies whose onUpdate() runs every frame, see Body::startUpdates()
+    BodyList mUpdatedBodies;
+    bool mBodiesKilled;
     int mBlockCount;
     int mWelcomeLevel;
     int mExtraLifeIndex;
@@ -397,6 +444,7 @@ namespace Impact {
 
     std::string mLevelZipFilename;
     int mDisplayCount;
+    SessionRecorder *mSessionRecorder;
 
     std::vector<Level> mLevels;
     std::mutex mEnumerateMutex;
@@ -425,11 +473,13 @@ namespace Impact {
     void setCursorOnRacket(void);
     void extraBall(void);
     void setState(State state);
+    void createWorld(void);
     void clearWorld(void);
     void clearWindow(void);
     void updateStats(void);
     void drawWorld(const sf::View &view);
     void drawStartMessage(void);
+    void drawScene(sf::RenderTarget &target);
     void drawPlayground(void);
     void resumeAllMusic(void);
     void stopAllMusic(void);
@@ -439,8 +489,19 @@ namespace Impact {
     void pause(void);
     void resume(void);
     void buildLevel(void);
+    void buildWalls(const std::vector<Wall*> &walls);
     void update(void);
+    void updatePlayground(void);
+    void initCollisionHandlers(void);
     void evaluateCollisions(void);
+    void onBlockHitByBall(Body *block, Body *ball, const ContactEvent &);
+    void onBlockHitRacket(Body *block, Body *racket, const ContactEvent &);
+    void onBlockHitGround(Body *block, Body *ground, const ContactEvent &);
+    void onBallHitRacket(Body *ball, Body *racket, const ContactEvent &);
+    void onBallHitGround(Body *ball, Body *ground, const ContactEvent &);
+    void onBumperHit(Body *bumper, Body *other, const ContactEvent &);
+    void fireLaser(void);
+    void evaluateLaserShots(void);
     void showCursor(void);
     void hideCursor(void);
     void drawCursor(void);
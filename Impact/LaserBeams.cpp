@@ -0,0 +1,98 @@
+/*  
+
+    Copyright (c) 2015 Oliver Lau <ola@ct.de>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include "stdafx.h"
+
+
+namespace Impact {
+
+  const float32 LaserBeams::Lifetime = .12f;
+  const float LaserBeams::Width = 2.f;
+
+
+  LaserBeams::LaserBeams(void)
+    : mBeams(Capacity)
+    , mCount(0)
+    , mVertices(sf::Quads)
+  { /* ... */ }
+
+
+  void LaserBeams::clear(void)
+  {
+    mCount = 0;
+    mVertices.clear();
+  }
+
+
+  void LaserBeams::add(const b2Vec2 &from, const b2Vec2 &to)
+  {
+    int i = mCount;
+    if (mCount < Capacity) {
+      ++mCount;
+    }
+    else {
+      i = 0;
+      for (int j = 1; j < mCount; ++j)
+        if (mBeams[j].age > mBeams[i].age)
+          i = j;
+    }
+    mBeams[i].from = from;
+    mBeams[i].to = to;
+    mBeams[i].age = 0.f;
+  }
+
+
+  void LaserBeams::update(float elapsedSeconds)
+  {
+    int i = 0;
+    while (i < mCount) {
+      mBeams[i].age += elapsedSeconds;
+      if (mBeams[i].age > Lifetime)
+        mBeams[i] = mBeams[--mCount];
+      else
+        ++i;
+    }
+
+    mVertices.resize(4 * mCount);
+    for (i = 0; i < mCount; ++i) {
+      const LaserBeam &beam = mBeams[i];
+      b2Vec2 n(beam.from.y - beam.to.y, beam.to.x - beam.from.x);
+      n.Normalize();
+      n *= .5f * Width;
+      const sf::Vector2f from(Game::Scale * beam.from.x, Game::Scale * beam.from.y);
+      const sf::Vector2f to(Game::Scale * beam.to.x, Game::Scale * beam.to.y);
+      const sf::Vector2f offset(n.x, n.y);
+      const sf::Color color(255U, 60U, 40U, sf::Uint8(255.f * (1.f - beam.age / Lifetime)));
+      sf::Vertex *quad = &mVertices[4 * i];
+      quad[0] = sf::Vertex(from - offset, color);
+      quad[1] = sf::Vertex(from + offset, color);
+      quad[2] = sf::Vertex(to + offset, color);
+      quad[3] = sf::Vertex(to - offset, color);
+    }
+  }
+
+
+  void LaserBeams::draw(sf::RenderTarget &target, sf::RenderStates states) const
+  {
+    if (mCount > 0)
+      target.draw(mVertices, states);
+  }
+
+}
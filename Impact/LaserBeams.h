@@ -0,0 +1,72 @@
+/*  
+
+    Copyright (c) 2015 Oliver Lau <ola@ct.de>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#ifndef __LASERBEAMS_H_
+#define __LASERBEAMS_H_
+
+#include <Box2D/Box2D.h>
+#include <SFML/Graphics.hpp>
+
+#include <vector>
+
+namespace Impact {
+
+  struct LaserBeam {
+    b2Vec2 from;
+    b2Vec2 to;
+    float32 age;
+  };
+
+
+  /// The fading beams left by the racket's laser.
+  ///
+  /// Beams are kept in a pool that is allocated once with room for
+  /// Capacity beams, so that rapid fire allocates nothing; when the pool
+  /// is full, the oldest beam makes room for the new one. All beams are
+  /// drawn as quads of a single vertex array.
+  class LaserBeams : public sf::Drawable {
+  public:
+    LaserBeams(void);
+
+    static const int Capacity = 64;
+    static const float32 Lifetime;
+    static const float Width;
+
+    void clear(void);
+    void add(const b2Vec2 &from, const b2Vec2 &to);
+    /// ages the beams by `elapsedSeconds`, removes the expired ones and rebuilds the vertices
+    void update(float elapsedSeconds);
+
+    inline int count(void) const
+    {
+      return mCount;
+    }
+
+  private:
+    std::vector<LaserBeam> mBeams;
+    int mCount;
+    sf::VertexArray mVertices;
+
+    virtual void draw(sf::RenderTarget &target, sf::RenderStates states) const;
+  };
+
+}
+
+#endif // __LASERBEAMS_H_
@@ -158,28 +158,13 @@ namespace Impact {
   }
 
 
-#pragma warning(disable : 4503)
-  void Level::loadZip(const std::string &zipFilename)
+  bool Level::extractZip(const std::string &zipFilename, const std::string &levelPath, std::string &tmxFilename, std::string &musicFilename)
   {
-    mSuccessfullyLoaded = false;
-    bool ok = true;
-
-    std::string levelPath;
-    std::string levelFilename;
-
-    safeDelete(mMusic);
-
-    boost::filesystem::path p(zipFilename);
-    mName = p.filename().replace_extension().generic_string();
-
-#ifndef NDEBUG
-    std::cout << "LEVEL NAME: " << mName << std::endl;
-#endif
-
+    tmxFilename.clear();
+    musicFilename.clear();
 #if defined(WIN32)
     HZIP hz = OpenZip(zipFilename.c_str(), nullptr);
     if (hz) {
-      levelPath = gLocalSettings().levelsDir() + "/" + mName;
       SetUnzipBaseDir(hz, levelPath.c_str());
       ZIPENTRY ze;
       GetZipItem(hz, -1, &ze);
@@ -189,17 +174,10 @@ namespace Impact {
         UnzipItem(hz, i, ze.name);
         std::string currentItemName = ze.name;
         if (boost::algorithm::ends_with(currentItemName, ".tmx")) {
-          levelFilename = levelPath + "/" + currentItemName;
+          tmxFilename = levelPath + "/" + currentItemName;
         }
         else if (boost::algorithm::ends_with(currentItemName, ".ogg")) {
-          mMusic = new sf::Music;
-          if (mMusic != nullptr) {
-            bool musicLoaded = mMusic->openFromFile(levelPath + "/" + currentItemName);
-            if (musicLoaded) {
-              mMusic->setLoop(true);
-              mMusic->setVolume(gLocalSettings().musicVolume());
-            }
-          }
+          musicFilename = levelPath + "/" + currentItemName;
         }
       }
       CloseZip(hz);
@@ -208,13 +186,14 @@ namespace Impact {
     unzFile hz = unzOpen(zipFilename.c_str());
     if (hz) {
       int rc;
-      levelPath = gLocalSettings().levelsDir() + "/" + mName;
       char curwd[PATH_MAX];
       const char *path = getcwd(curwd, PATH_MAX);
       mkdir(levelPath.c_str(), 0775);
       rc = chdir(levelPath.c_str());
-      if (rc != 0)
-        return;
+      if (rc != 0) {
+        unzClose(hz);
+        return false;
+      }
       unz_global_info gInfo;
       unzGetGlobalInfo(hz, &gInfo);
       int nItems = gInfo.number_entry;
@@ -227,17 +206,10 @@ namespace Impact {
         do_extract_currentfile(hz, &extractWithoutPath, &extractOverwrite, NULL);
         std::string currentItemName = zeName;
         if (boost::algorithm::ends_with(currentItemName, ".tmx")) {
-          levelFilename = levelPath + "/" + currentItemName;
+          tmxFilename = levelPath + "/" + currentItemName;
         }
         else if (boost::algorithm::ends_with(currentItemName, ".ogg")) {
-          mMusic = new sf::Music;
-          if (mMusic != nullptr) {
-            bool musicLoaded = mMusic->openFromFile(levelPath + "/" + currentItemName);
-            if (musicLoaded) {
-              mMusic->setLoop(true);
-              mMusic->setVolume(gLocalSettings().musicVolume());
-            }
-          }
+          musicFilename = levelPath + "/" + currentItemName;
         }
         if ((i+1)<nItems) {
           unzGoToNextFile(hz);
@@ -247,6 +219,72 @@ namespace Impact {
       unzClose(hz);
     }
 #endif
+    return !tmxFilename.empty();
+  }
+
+
+  bool Level::decodeMapData(const std::string &mapDataB64, std::size_t numTiles, std::vector<uint32_t> &mapData)
+  {
+    mapData.clear();
+    uint8_t *compressed = nullptr;
+    uLong compressedSize = 0UL;
+    base64_decode(mapDataB64, compressed, compressedSize);
+    if (compressed == nullptr || compressedSize == 0) {
+      std::cerr << "Decoding map data failed." << std::endl;
+      return false;
+    }
+    mapData.resize(numTiles);
+    uLongf mapDataSize = uLongf(numTiles * sizeof(uint32_t));
+    int rc = uncompress(reinterpret_cast<Bytef*>(mapData.data()), &mapDataSize, reinterpret_cast<Bytef*>(compressed), compressedSize);
+    delete[] compressed;
+    if (rc == Z_OK) {
+      mapData.resize(mapDataSize / sizeof(uint32_t));
+      return true;
+    }
+    if (rc == Z_DATA_ERROR)
+      std::cerr << "Inflating map data failed: Z_DATA_ERROR" << std::endl;
+    else if (rc == Z_MEM_ERROR)
+      std::cerr << "Inflating map data failed: Z_MEM_ERROR" << std::endl;
+    else if (rc == Z_BUF_ERROR)
+      std::cerr << "Inflating map data failed: Z_BUF_ERROR " << std::endl;
+    else
+      std::cerr << "Inflating map data failed with error code " << rc << std::endl;
+    mapData.clear();
+    return false;
+  }
+
+
+#pragma warning(disable : 4503)
+  void Level::loadZip(const std::string &zipFilename)
+  {
+    mSuccessfullyLoaded = false;
+    bool ok = true;
+
+    std::string levelPath;
+    std::string levelFilename;
+
+    safeDelete(mMusic);
+
+    boost::filesystem::path p(zipFilename);
+    mName = p.filename().replace_extension().generic_string();
+
+#ifndef NDEBUG
+    std::cout << "LEVEL NAME: " << mName << std::endl;
+#endif
+
+    levelPath = gLocalSettings().levelsDir() + "/" + mName;
+    std::string musicFilename;
+    extractZip(zipFilename, levelPath, levelFilename, musicFilename);
+    if (!musicFilename.empty()) {
+      mMusic = new sf::Music;
+      if (mMusic != nullptr) {
+        bool musicLoaded = mMusic->openFromFile(musicFilename);
+        if (musicLoaded) {
+          mMusic->setLoop(true);
+          mMusic->setVolume(gLocalSettings().musicVolume());
+        }
+      }
+    }
     calcSHA1(zipFilename);
 
     ok = fileExists(levelFilename);
@@ -339,35 +377,7 @@ namespace Impact {
         }
       } catch (boost::property_tree::ptree_error &e) { UNUSED(e); }
 
-      uint8_t *compressed = nullptr;
-      uLong compressedSize = 0UL;
-      base64_decode(mapDataB64, compressed, compressedSize);
-      if (compressed != nullptr && compressedSize > 0) {
-        static const size_t CHUNKSIZE = 128 * 1024; // sizeof(uint32_t) * Game::DefaultPlaygroundWidth * Game::DefaultPlaygroundHeight;
-        uint32_t *mapData = new uint32_t[CHUNKSIZE / sizeof(uint32_t)];
-        if (mapData != nullptr) {
-          uLongf mapDataSize = CHUNKSIZE;
-          int rc = uncompress(reinterpret_cast<Bytef*>(mapData), &mapDataSize, reinterpret_cast<Bytef*>(compressed), compressedSize);
-          if (rc == Z_OK) {
-            for (uLongf i = 0; i < mapDataSize; ++i) {
-              mMapData.push_back(*(mapData + i));
-            }
-            delete [] mapData;
-          }
-          else {
-            ok = false;
-            if (rc == Z_DATA_ERROR)
-              std::cerr << "Inflating map data failed: Z_DATA_ERROR" << std::endl;
-            else if (rc == Z_MEM_ERROR)
-              std::cerr << "Inflating map data failed: Z_MEM_ERROR" << std::endl;
-            else if (rc == Z_BUF_ERROR)
-              std::cerr << "Inflating map data failed: Z_BUF_ERROR " << std::endl;
-            else
-              std::cerr << "Inflating map data failed with error code " << rc << std::endl;
-          }
-        }
-        delete[] compressed;
-      }
+      ok = decodeMapData(mapDataB64, std::size_t(mNumTilesX * mNumTilesY), mMapData);
 
       if (!ok)
         return;
@@ -456,6 +466,9 @@ namespace Impact {
                 else if (propName == "scaleballdensityseconds") {
                   tileParam.scaleBallDensityDuration = sf::seconds(property.get<float32>("<xmlattr>.value", 0.f));
                 }
+                else if (propName == "laserseconds") {
+                  tileParam.laserDuration = sf::seconds(property.get<float32>("<xmlattr>.value", 0.f));
+                }
                 else if (propName == "minimumhitimpulse") {
                   tileParam.minimumHitImpulse = property.get<int>("<xmlattr>.value", 5);
                 }
@@ -552,4 +565,39 @@ namespace Impact {
     return mTiles.at(index);
   }
 
+
+  void Level::mergeTiles(const std::function<bool(int, int)> &mergeable, std::vector<TileRect> &rects) const
+  {
+    rects.clear();
+    std::vector<bool> covered(mMapData.size(), false);
+    for (int y = 0; y < mNumTilesY; ++y) {
+      for (int x = 0; x < mNumTilesX; ++x) {
+        const int i = y * mNumTilesX + x;
+        const uint32_t tileId = mMapData[i];
+        if (covered[i] || tileId == 0 || !mergeable(x, y))
+          continue;
+        // grow to the right as far as possible, then downwards
+        // as long as the whole row below matches
+        TileRect rect;
+        rect.x = x;
+        rect.y = y;
+        rect.tileId = tileId;
+        rect.width = 1;
+        while (x + rect.width < mNumTilesX && mMapData[i + rect.width] == tileId && !covered[i + rect.width] && mergeable(x + rect.width, y))
+          ++rect.width;
+        rect.height = 1;
+        for (bool rowMatches = true; rowMatches && y + rect.height < mNumTilesY; ) {
+          const int below = i + rect.height * mNumTilesX;
+          for (int dx = 0; dx < rect.width && rowMatches; ++dx)
+            rowMatches = mMapData[below + dx] == tileId && !covered[below + dx] && mergeable(x + dx, y + rect.height);
+          if (rowMatches)
+            ++rect.height;
+        }
+        for (int dy = 0; dy < rect.height; ++dy)
+          std::fill_n(covered.begin() + i + dy * mNumTilesX, rect.width, true);
+        rects.push_back(rect);
+      }
+    }
+  }
+
 }
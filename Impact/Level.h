@@ -23,6 +23,7 @@
 #include <SFML/System.hpp>
 #include <vector>
 #include <string>
+#include <functional>
 #include "Body.h"
 #include "globals.h"
 #include "TileParam.h"
@@ -55,6 +56,23 @@ namespace Impact {
     bool valid;
   };
 
+  /// a rectangle of tiles with equal ids, in tiles
+  struct TileRect {
+    TileRect(void)
+      : x(0)
+      , y(0)
+      , width(0)
+      , height(0)
+      , tileId(0)
+    { /* ... */ }
+    int x;
+    int y;
+    int width;
+    int height;
+    uint32_t tileId;
+  };
+
+
   class Level {
   public:
     Level(void);
@@ -74,6 +92,9 @@ namespace Impact {
     int bodyIndexByTextureName(const std::string &name) const;
     uint32_t *const mapDataScanLine(int y);
     const TileParam &tileParam(int index) const;
+    /// covers the tiles at which `mergeable(x, y)` holds with rectangles of equal tile ids,
+    /// each grown greedily to the right and then downwards
+    void mergeTiles(const std::function<bool(int, int)> &mergeable, std::vector<TileRect> &rects) const;
     inline bool isAvailable(void) const
     {
       return mSuccessfullyLoaded;
@@ -188,6 +209,11 @@ namespace Impact {
     void load(void);
     void loadZip(const std::string &zipFilename);
 
+    // the stages of loadZip(), also used to benchmark them in isolation
+    static bool extractZip(const std::string &zipFilename, const std::string &levelPath, std::string &tmxFilename, std::string &musicFilename);
+    static bool decodeMapData(const std::string &mapDataB64, std::size_t numTiles, std::vector<uint32_t> &mapData);
+    bool calcSHA1(const std::string &filename);
+
   private:
     bool mSuccessfullyLoaded;
     std::string mSHA1;
@@ -219,8 +245,6 @@ namespace Impact {
     sf::Music *mMusic;
 
     std::vector<TileParam> mTiles;
-
-    bool calcSHA1(const std::string &filename);
   };
 
 }
@@ -0,0 +1,410 @@
+/*  
+
+    Copyright (c) 2015 Oliver Lau <ola@ct.de>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include "stdafx.h"
+
+#include <boost/filesystem/path.hpp>
+
+#include <zlib.h>
+
+namespace Impact {
+
+  namespace {
+
+    struct GeneratedTile {
+      const char *filename;
+      int width;
+      int height;
+      uint32_t color;
+      bool round;
+      const char *properties[2][2];
+    };
+
+    // tile ids of the generated tileset; gid = FirstGID + id
+    enum GeneratedTileId {
+      BlueBlockTile = 0,
+      GreenBlockTile,
+      RedBlockTile,
+      MultiballBlockTile,
+      WallTile,
+      BumperTile,
+      RacketTile,
+      BallTile,
+      TileCount
+    };
+
+    static const uint32_t FirstGID = 1;
+    static const int TileSize = 16;
+
+    // names must match Wall::Name, Bumper::Name, Racket::Name and Ball::Name
+    static const GeneratedTile Tiles[TileCount] = {
+      { "blue-block.png", 32, 16, 0x3a6fd8ffU, false, { { "Points", "10" }, { nullptr, nullptr } } },
+      { "green-block.png", 32, 16, 0x3ac85affU, false, { { "Points", "20" }, { nullptr, nullptr } } },
+      { "red-block.png", 32, 16, 0xd83a3affU, false, { { "Points", "50" }, { nullptr, nullptr } } },
+      { "multiball-block.png", 32, 16, 0xd83ad8ffU, false, { { "Points", "100" }, { "Multiball", "true" } } },
+      { "wall.png", 16, 16, 0x808080ffU, false, { { "Name", "Wall" }, { nullptr, nullptr } } },
+      { "bumper.png", 32, 32, 0xe8c020ffU, true, { { "Name", "Bumper" }, { nullptr, nullptr } } },
+      { "pad.png", 64, 16, 0xe0e0e0ffU, false, { { "Name", "Racket" }, { nullptr, nullptr } } },
+      { "ball.png", 16, 16, 0xffffffffU, true, { { "Name", "Ball" }, { "Smooth", "1" } } }
+    };
+
+
+    inline void put16(std::string &buf, uint32_t v)
+    {
+      buf.push_back(char(v & 0xffU));
+      buf.push_back(char((v >> 8) & 0xffU));
+    }
+
+
+    inline void put32(std::string &buf, uint32_t v)
+    {
+      put16(buf, v & 0xffffU);
+      put16(buf, v >> 16);
+    }
+
+
+    inline void put32BE(std::string &buf, uint32_t v)
+    {
+      buf.push_back(char((v >> 24) & 0xffU));
+      buf.push_back(char((v >> 16) & 0xffU));
+      buf.push_back(char((v >> 8) & 0xffU));
+      buf.push_back(char(v & 0xffU));
+    }
+
+
+    void appendPNGChunk(std::string &png, const char *type, const std::string &data)
+    {
+      put32BE(png, uint32_t(data.size()));
+      const std::string &chunk = std::string(type, 4) + data;
+      png += chunk;
+      put32BE(png, uint32_t(crc32(0L, reinterpret_cast<const Bytef*>(chunk.data()), uInt(chunk.size()))));
+    }
+
+
+    // renders a flat colored tile image with a darker rim into an RGBA PNG
+    std::string tileImage(const GeneratedTile &tile)
+    {
+      const int w = tile.width;
+      const int h = tile.height;
+      const uint8_t r = uint8_t(tile.color >> 24), g = uint8_t(tile.color >> 16), b = uint8_t(tile.color >> 8);
+      std::string raw;
+      raw.reserve(h * (1 + 4 * w));
+      for (int y = 0; y < h; ++y) {
+        raw.push_back(0); // filter type: none
+        for (int x = 0; x < w; ++x) {
+          bool inside = true;
+          bool rim = x == 0 || y == 0 || x == w - 1 || y == h - 1;
+          if (tile.round) {
+            const float dx = x + .5f - .5f * w;
+            const float dy = y + .5f - .5f * h;
+            const float d = std::sqrt(dx * dx + dy * dy);
+            const float radius = .5f * std::min(w, h);
+            inside = d <= radius;
+            rim = d > radius - 1.5f;
+          }
+          const uint8_t shade = rim ? 2 : 1;
+          raw.push_back(char(inside ? r / shade : 0));
+          raw.push_back(char(inside ? g / shade : 0));
+          raw.push_back(char(inside ? b / shade : 0));
+          raw.push_back(char(inside ? 0xffU : 0));
+        }
+      }
+      uLongf compressedSize = compressBound(uLong(raw.size()));
+      std::string compressed(compressedSize, '\0');
+      compress2(reinterpret_cast<Bytef*>(&compressed[0]), &compressedSize, reinterpret_cast<const Bytef*>(raw.data()), uLong(raw.size()), Z_BEST_COMPRESSION);
+      compressed.resize(compressedSize);
+
+      std::string ihdr;
+      put32BE(ihdr, uint32_t(w));
+      put32BE(ihdr, uint32_t(h));
+      ihdr.push_back(8); // bit depth
+      ihdr.push_back(6); // color type: RGBA
+      ihdr.push_back(0); // compression
+      ihdr.push_back(0); // filter
+      ihdr.push_back(0); // no interlacing
+
+      std::string png("\x89PNG\r\n\x1a\n", 8);
+      appendPNGChunk(png, "IHDR", ihdr);
+      appendPNGChunk(png, "IDAT", compressed);
+      appendPNGChunk(png, "IEND", std::string());
+      return png;
+    }
+
+
+    // minimal writer for deflated zip archives, as minizip on Linux only unpacks
+    class ZipWriter {
+    public:
+      ZipWriter(void)
+        : mEntryCount(0)
+      { /* ... */ }
+
+      void add(const std::string &name, const std::string &data)
+      {
+        z_stream zs;
+        std::memset(&zs, 0, sizeof(zs));
+        deflateInit2(&zs, Z_BEST_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+        std::string deflated(deflateBound(&zs, uLong(data.size())), '\0');
+        zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+        zs.avail_in = uInt(data.size());
+        zs.next_out = reinterpret_cast<Bytef*>(&deflated[0]);
+        zs.avail_out = uInt(deflated.size());
+        deflate(&zs, Z_FINISH);
+        deflated.resize(zs.total_out);
+        deflateEnd(&zs);
+
+        const uint32_t crc = uint32_t(crc32(0L, reinterpret_cast<const Bytef*>(data.data()), uInt(data.size())));
+        const uint32_t offset = uint32_t(mArchive.size());
+        put32(mArchive, 0x04034b50U);
+        putEntryHeader(mArchive, name, crc, uint32_t(deflated.size()), uint32_t(data.size()));
+        mArchive += name;
+        mArchive += deflated;
+
+        put32(mDirectory, 0x02014b50U);
+        put16(mDirectory, 20); // version made by
+        putEntryHeader(mDirectory, name, crc, uint32_t(deflated.size()), uint32_t(data.size()));
+        put16(mDirectory, 0); // file comment length
+        put16(mDirectory, 0); // disk number
+        put16(mDirectory, 0); // internal attributes
+        put32(mDirectory, 0); // external attributes
+        put32(mDirectory, offset);
+        mDirectory += name;
+        ++mEntryCount;
+      }
+
+      bool write(const std::string &zipFilename)
+      {
+        std::string end;
+        put32(end, 0x06054b50U);
+        put16(end, 0);
+        put16(end, 0);
+        put16(end, mEntryCount);
+        put16(end, mEntryCount);
+        put32(end, uint32_t(mDirectory.size()));
+        put32(end, uint32_t(mArchive.size()));
+        put16(end, 0);
+        std::ofstream os(zipFilename, std::ios::binary);
+        if (!os.is_open())
+          return false;
+        os << mArchive << mDirectory << end;
+        return os.good();
+      }
+
+    private:
+      std::string mArchive;
+      std::string mDirectory;
+      uint32_t mEntryCount;
+
+      static void putEntryHeader(std::string &buf, const std::string &name, uint32_t crc, uint32_t compressedSize, uint32_t size)
+      {
+        put16(buf, 20); // version needed to extract
+        put16(buf, 0); // flags
+        put16(buf, Z_DEFLATED);
+        put16(buf, 0); // DOS time
+        put16(buf, (35 << 9) | (1 << 5) | 1); // DOS date: 2015-01-01
+        put32(buf, crc);
+        put32(buf, compressedSize);
+        put32(buf, size);
+        put16(buf, uint32_t(name.size()));
+        put16(buf, 0); // extra field length
+      }
+    };
+
+
+    std::string xmlEscape(const std::string &s)
+    {
+      std::string escaped;
+      std::string::const_iterator c;
+      for (c = s.begin(); c != s.end(); ++c) {
+        switch (*c) {
+        case '&': escaped += "&amp;"; break;
+        case '<': escaped += "&lt;"; break;
+        case '>': escaped += "&gt;"; break;
+        case '"': escaped += "&quot;"; break;
+        default: escaped.push_back(*c); break;
+        }
+      }
+      return escaped;
+    }
+
+  }
+
+
+  LevelGenerator::LevelGenerator(const LevelGeneratorDef &def)
+    : mDef(def)
+    , mRNG(def.seed)
+    , mPlacedBlocks(0)
+    , mPlacedWalls(0)
+    , mPlacedBumpers(0)
+    , mPlacedMultiballBlocks(0)
+    , mPlacedBalls(0)
+  {
+    mDef.width = std::max(mDef.width, 8);
+    mDef.height = std::max(mDef.height, 8);
+    if (mDef.name.empty()) {
+      std::ostringstream name;
+      name << "Stress " << mDef.width << "x" << mDef.height
+        << " blocks=" << mDef.blocks
+        << " walls=" << mDef.walls
+        << " bumpers=" << mDef.bumpers
+        << " multiball=" << mDef.multiballBlocks
+        << " balls=" << mDef.balls;
+      mDef.name = name.str();
+    }
+    generate();
+  }
+
+
+  bool LevelGenerator::fits(int x, int y, int w, int h) const
+  {
+    if (x < 0 || x + w > mDef.width || y - h + 1 < 0 || y >= mDef.height)
+      return false;
+    for (int j = y - h + 1; j <= y; ++j)
+      for (int i = x; i < x + w; ++i)
+        if (mOccupied[j * mDef.width + i])
+          return false;
+    return true;
+  }
+
+
+  int LevelGenerator::place(const std::vector<uint32_t> &gids, int count, int w, int h, int top, int bottom)
+  {
+    // tiles are anchored at their bottom left corner, like Tiled does it
+    std::vector<std::pair<int, int> > candidates;
+    for (int y = std::max(top + h - 1, 0); y <= std::min(bottom, mDef.height - 1); ++y)
+      for (int x = 0; x + w <= mDef.width; ++x)
+        candidates.push_back(std::make_pair(x, y));
+    std::shuffle(candidates.begin(), candidates.end(), mRNG);
+    std::uniform_int_distribution<std::size_t> gidDist(0, gids.size() - 1);
+    int placed = 0;
+    std::vector<std::pair<int, int> >::const_iterator c;
+    for (c = candidates.begin(); c != candidates.end() && placed < count; ++c) {
+      const int x = c->first;
+      const int y = c->second;
+      if (!fits(x, y, w, h))
+        continue;
+      for (int j = y - h + 1; j <= y; ++j)
+        for (int i = x; i < x + w; ++i)
+          mOccupied[j * mDef.width + i] = true;
+      mMapData[y * mDef.width + x] = gids[gidDist(mRNG)];
+      ++placed;
+    }
+    return placed;
+  }
+
+
+  void LevelGenerator::generate(void)
+  {
+    const int W = mDef.width;
+    const int H = mDef.height;
+    mMapData.assign(W * H, 0);
+    mOccupied.assign(W * H, false);
+
+    const int racketW = Tiles[RacketTile].width / TileSize;
+    const int bumperW = Tiles[BumperTile].width / TileSize;
+    const int bumperH = Tiles[BumperTile].height / TileSize;
+    const int blockW = Tiles[BlueBlockTile].width / TileSize;
+    const int blockH = Tiles[BlueBlockTile].height / TileSize;
+    const int blockBottom = 2 * H / 3;
+    const int ballTop = H - 6;
+
+    // racket centered in the second to last row, balls right above it
+    const int racketX = W / 2 - racketW / 2;
+    const int racketY = H - 2;
+    for (int i = racketX; i < racketX + racketW; ++i)
+      mOccupied[racketY * W + i] = true;
+    mMapData[racketY * W + racketX] = FirstGID + RacketTile;
+
+    mPlacedBalls = place(std::vector<uint32_t>(1, FirstGID + BallTile), mDef.balls, 1, 1, ballTop, H - 4);
+    mPlacedWalls = place(std::vector<uint32_t>(1, FirstGID + WallTile), mDef.walls, 1, 1, 0, ballTop - 1);
+    mPlacedBumpers = place(std::vector<uint32_t>(1, FirstGID + BumperTile), mDef.bumpers, bumperW, bumperH, 2, ballTop - 1);
+    mPlacedMultiballBlocks = place(std::vector<uint32_t>(1, FirstGID + MultiballBlockTile), mDef.multiballBlocks, blockW, blockH, 0, blockBottom);
+    std::vector<uint32_t> blockGids;
+    blockGids.push_back(FirstGID + BlueBlockTile);
+    blockGids.push_back(FirstGID + GreenBlockTile);
+    blockGids.push_back(FirstGID + RedBlockTile);
+    mPlacedBlocks = place(blockGids, mDef.blocks, blockW, blockH, 0, blockBottom);
+
+    if (mPlacedBalls < mDef.balls || mPlacedWalls < mDef.walls || mPlacedBumpers < mDef.bumpers
+      || mPlacedMultiballBlocks < mDef.multiballBlocks || mPlacedBlocks < mDef.blocks) {
+      std::cerr << "Map too crowded, placed only "
+        << mPlacedBlocks << " blocks, "
+        << mPlacedWalls << " walls, "
+        << mPlacedBumpers << " bumpers, "
+        << mPlacedMultiballBlocks << " multiball blocks and "
+        << mPlacedBalls << " balls." << std::endl;
+    }
+  }
+
+
+  std::string LevelGenerator::tmx(void) const
+  {
+    const uLong mapDataSize = uLong(mMapData.size() * sizeof(uint32_t));
+    uLongf compressedSize = compressBound(mapDataSize);
+    std::vector<Bytef> compressed(compressedSize);
+    compress2(compressed.data(), &compressedSize, reinterpret_cast<const Bytef*>(mMapData.data()), mapDataSize, Z_BEST_COMPRESSION);
+
+    std::ostringstream os;
+    os << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+      << "<map version=\"1.0\" orientation=\"orthogonal\" renderorder=\"right-down\""
+      << " width=\"" << mDef.width << "\" height=\"" << mDef.height << "\""
+      << " tilewidth=\"" << TileSize << "\" tileheight=\"" << TileSize << "\" backgroundcolor=\"#203040\">\n"
+      << " <properties>\n"
+      << "  <property name=\"Author\" value=\"levelgen\"/>\n"
+      << "  <property name=\"ExplosionParticlesCollideWithBall\" value=\"" << (mDef.explosionParticlesCollideWithBall ? "true" : "false") << "\"/>\n"
+      << "  <property name=\"Gravity\" value=\"" << mDef.gravity << "\"/>\n"
+      << "  <property name=\"Name\" value=\"" << xmlEscape(mDef.name) << "\"/>\n"
+      << " </properties>\n"
+      << " <tileset firstgid=\"" << FirstGID << "\" name=\"Generated\" tilewidth=\"64\" tileheight=\"32\">\n";
+    for (int id = 0; id < TileCount; ++id) {
+      const GeneratedTile &tile = Tiles[id];
+      os << "  <tile id=\"" << id << "\">\n"
+        << "   <properties>\n";
+      for (int i = 0; i < 2; ++i)
+        if (tile.properties[i][0] != nullptr)
+          os << "    <property name=\"" << tile.properties[i][0] << "\" value=\"" << tile.properties[i][1] << "\"/>\n";
+      os << "   </properties>\n"
+        << "   <image width=\"" << tile.width << "\" height=\"" << tile.height << "\" source=\"" << tile.filename << "\"/>\n"
+        << "  </tile>\n";
+    }
+    os << " </tileset>\n"
+      << " <layer name=\"Tile Layer\" width=\"" << mDef.width << "\" height=\"" << mDef.height << "\">\n"
+      << "  <data encoding=\"base64\" compression=\"zlib\">\n"
+      << "   " << base64_encode(compressed.data(), compressedSize) << "\n"
+      << "  </data>\n"
+      << " </layer>\n"
+      << "</map>\n";
+    return os.str();
+  }
+
+
+  bool LevelGenerator::writeZip(const std::string &zipFilename)
+  {
+    const std::string &levelName = boost::filesystem::path(zipFilename).stem().generic_string();
+    ZipWriter zip;
+    zip.add(levelName + ".tmx", tmx());
+    for (int id = 0; id < TileCount; ++id)
+      zip.add(Tiles[id].filename, tileImage(Tiles[id]));
+    const bool ok = zip.write(zipFilename);
+    if (!ok)
+      std::cerr << "Cannot write " << zipFilename << std::endl;
+    return ok;
+  }
+
+}
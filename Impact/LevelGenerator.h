@@ -0,0 +1,109 @@
+/*  
+
+    Copyright (c) 2015 Oliver Lau <ola@ct.de>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __LEVELGENERATOR_H_
+#define __LEVELGENERATOR_H_
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <random>
+
+namespace Impact {
+
+  class LevelGeneratorDef {
+  public:
+    LevelGeneratorDef(void)
+      : width(40)
+      , height(25)
+      , blocks(60)
+      , walls(0)
+      , bumpers(0)
+      , multiballBlocks(0)
+      , balls(1)
+      , gravity(9.81f)
+      , explosionParticlesCollideWithBall(false)
+      , seed(0)
+    { /* ... */ }
+    /// map size in tiles
+    int width;
+    int height;
+    /// number of level elements to place
+    int blocks;
+    int walls;
+    int bumpers;
+    int multiballBlocks;
+    int balls;
+    float gravity;
+    bool explosionParticlesCollideWithBall;
+    uint32_t seed;
+    std::string name;
+  };
+
+
+  /// Writes procedurally generated levels in the same TMX-in-zip format
+  /// the game loads, using only tile properties Level::loadZip() knows.
+  class LevelGenerator {
+  public:
+    LevelGenerator(const LevelGeneratorDef &def);
+
+    bool writeZip(const std::string &zipFilename);
+    std::string tmx(void) const;
+
+    /// number of elements actually placed; may be lower than requested if the map is too crowded
+    inline int placedBlocks(void) const
+    {
+      return mPlacedBlocks;
+    }
+    inline int placedWalls(void) const
+    {
+      return mPlacedWalls;
+    }
+    inline int placedBumpers(void) const
+    {
+      return mPlacedBumpers;
+    }
+    inline int placedMultiballBlocks(void) const
+    {
+      return mPlacedMultiballBlocks;
+    }
+    inline int placedBalls(void) const
+    {
+      return mPlacedBalls;
+    }
+
+  private:
+    LevelGeneratorDef mDef;
+    std::vector<uint32_t> mMapData;
+    std::vector<bool> mOccupied;
+    std::mt19937 mRNG;
+    int mPlacedBlocks;
+    int mPlacedWalls;
+    int mPlacedBumpers;
+    int mPlacedMultiballBlocks;
+    int mPlacedBalls;
+
+    void generate(void);
+    bool fits(int x, int y, int w, int h) const;
+    int place(const std::vector<uint32_t> &gids, int count, int w, int h, int top, int bottom);
+  };
+
+}
+
+#endif // __LEVELGENERATOR_H_
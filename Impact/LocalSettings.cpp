@@ -49,6 +49,9 @@ namespace Impact {
       , framerateLimit(0)
       , velocityIterations(32)
       , positionIterations(64)
+      , physicsThreads(0)
+      , adaptiveStepping(true)
+      , logStepSchedule(false)
     { /* ... */ }
     bool useShaders;
     bool useShadersForExplosions;
@@ -61,6 +64,9 @@ namespace Impact {
     unsigned int framerateLimit;
     int velocityIterations;
     int positionIterations;
+    int physicsThreads;
+    bool adaptiveStepping;
+    bool logStepSchedule;
 
     std::string appData;
     std::string settingsFile;
@@ -144,6 +150,9 @@ namespace Impact {
       d->particlesPerExplosion = pt.get<unsigned int>("impact.explosion-particle-count", 50U);
       d->velocityIterations = pt.get<unsigned int>("impact.velocity-iterations", 16);
       d->positionIterations = pt.get<unsigned int>("impact.position-iterations", 64);
+      d->physicsThreads = pt.get<int>("impact.physics-threads", 0);
+      d->adaptiveStepping = pt.get<bool>("impact.adaptive-stepping", true);
+      d->logStepSchedule = pt.get<bool>("impact.log-step-schedule", false);
       d->framerateLimit = pt.get<unsigned int>("impact.frame-rate-limit", 0U);
       d->lastOpenDir = pt.get<std::string>("impact.last-open-dir", d->levelsDir);
       d->lastCampaignLevel = pt.get<int>("impact.campaign-last-level", 1);
@@ -198,6 +207,9 @@ namespace Impact {
     ar & boost::serialization::make_nvp("frame-rate-limit", d->framerateLimit);
     ar & boost::serialization::make_nvp("velocity-iterations", d->velocityIterations);
     ar & boost::serialization::make_nvp("position-iterations", d->positionIterations);
+    ar & boost::serialization::make_nvp("physics-threads", d->physicsThreads);
+    ar & boost::serialization::make_nvp("adaptive-stepping", d->adaptiveStepping);
+    ar & boost::serialization::make_nvp("log-step-schedule", d->logStepSchedule);
     ar & boost::serialization::make_nvp("last-open-dir", d->lastOpenDir);
     ar & boost::serialization::make_nvp("campaign-last-level", d->lastCampaignLevel);
     ar & boost::serialization::make_nvp("campaign-highscore", d->campaignHighscore);
@@ -242,6 +254,12 @@ namespace Impact {
   }
 
 
+  void LocalSettings::setLevelsDir(const std::string &levelsDir)
+  {
+    d->levelsDir = levelsDir;
+  }
+
+
   const std::string &LocalSettings::levelsDir(void) const
   {
     return d->levelsDir;
@@ -344,6 +362,42 @@ namespace Impact {
   }
 
 
+  void LocalSettings::setPhysicsThreads(int n)
+  {
+    d->physicsThreads = n;
+  }
+
+
+  int LocalSettings::physicsThreads(void) const
+  {
+    return d->physicsThreads;
+  }
+
+
+  void LocalSettings::setAdaptiveStepping(bool enabled)
+  {
+    d->adaptiveStepping = enabled;
+  }
+
+
+  bool LocalSettings::adaptiveStepping(void) const
+  {
+    return d->adaptiveStepping;
+  }
+
+
+  void LocalSettings::setLogStepSchedule(bool enabled)
+  {
+    d->logStepSchedule = enabled;
+  }
+
+
+  bool LocalSettings::logStepSchedule(void) const
+  {
+    return d->logStepSchedule;
+  }
+
+
   void LocalSettings::setHighscore(int level, int64_t score)
   {
     d->highscores[level] = score;
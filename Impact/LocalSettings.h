@@ -42,6 +42,7 @@ namespace Impact {
     bool useShadersForExplosions(void) const;
     void setLastOpenDir(std::string);
     const std::string &lastOpenDir(void) const;
+    void setLevelsDir(const std::string &);
     const std::string &levelsDir(void) const;
     const std::string &musicDir(void) const;
     const std::string &soundFXDir(void) const;
@@ -59,6 +60,12 @@ namespace Impact {
     int positionIterations(void) const;
     void setVelocityIterations(int);
     int velocityIterations(void) const;
+    void setPhysicsThreads(int);
+    int physicsThreads(void) const;
+    void setAdaptiveStepping(bool);
+    bool adaptiveStepping(void) const;
+    void setLogStepSchedule(bool);
+    bool logStepSchedule(void) const;
 
     void setHighscore(int level, int64_t score);
     int64_t highscore(int level) const;
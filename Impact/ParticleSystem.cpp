@@ -0,0 +1,230 @@
+/*  
+
+    Copyright (c) 2015 Oliver Lau <ola@ct.de>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include "stdafx.h"
+
+
+namespace Impact {
+
+  namespace {
+
+    class ColliderQuery : public b2QueryCallback
+    {
+    public:
+      ColliderQuery(const b2Filter &filter, const b2AABB &bounds, std::vector<ParticleCollider> &colliders)
+        : mFilter(filter)
+        , mBounds(bounds)
+        , mColliders(colliders)
+      { /* ... */ }
+
+      bool ReportFixture(b2Fixture *fixture)
+      {
+        if (fixture->IsSensor())
+          return true;
+        const b2Filter &filter = fixture->GetFilterData();
+        if ((mFilter.maskBits & filter.categoryBits) == 0 || (filter.maskBits & mFilter.categoryBits) == 0)
+          return true;
+        // QueryAABB() reports a fixture once per overlapping child, so
+        // children are collected here and duplicates dropped afterwards
+        const int32 childCount = fixture->GetShape()->GetChildCount();
+        for (int32 childIndex = 0; childIndex < childCount; ++childIndex) {
+          const b2AABB &aabb = fixture->GetAABB(childIndex);
+          if (b2TestOverlap(aabb, mBounds)) {
+            ParticleCollider collider;
+            collider.fixture = fixture;
+            collider.childIndex = childIndex;
+            collider.aabb = aabb;
+            mColliders.push_back(collider);
+          }
+        }
+        return true;
+      }
+
+    private:
+      const b2Filter &mFilter;
+      const b2AABB &mBounds;
+      std::vector<ParticleCollider> &mColliders;
+    };
+
+  }
+
+
+  ParticleSystem::ParticleSystem(b2World *world, const ParticleSystemDef &def)
+    : mWorld(world)
+    , mDef(def)
+    , mMass(def.density * b2_pi * def.radius * def.radius)
+  { /* ... */ }
+
+
+  void ParticleSystem::reserve(int n)
+  {
+    mX.reserve(n);
+    mY.reserve(n);
+    mVX.reserve(n);
+    mVY.reserve(n);
+    mLifetime.reserve(n);
+    mNextX.reserve(n);
+    mNextY.reserve(n);
+  }
+
+
+  void ParticleSystem::add(const b2Vec2 &pos, const b2Vec2 &velocity, float32 lifetime)
+  {
+    mX.push_back(pos.x);
+    mY.push_back(pos.y);
+    mVX.push_back(velocity.x);
+    mVY.push_back(velocity.y);
+    mLifetime.push_back(lifetime);
+  }
+
+
+  void ParticleSystem::retire(float32 age)
+  {
+    int n = count();
+    int i = 0;
+    while (i < n) {
+      if (mLifetime[i] < age) {
+        --n;
+        mX[i] = mX[n];
+        mY[i] = mY[n];
+        mVX[i] = mVX[n];
+        mVY[i] = mVY[n];
+        mLifetime[i] = mLifetime[n];
+      }
+      else {
+        ++i;
+      }
+    }
+    mX.resize(n);
+    mY.resize(n);
+    mVX.resize(n);
+    mVY.resize(n);
+    mLifetime.resize(n);
+  }
+
+
+  void ParticleSystem::step(float32 dt, float32 age)
+  {
+    retire(age);
+    const int n = count();
+    if (n == 0 || dt <= 0.f)
+      return;
+
+    mNextX.resize(n);
+    mNextY.resize(n);
+    float32 *const x = mX.data();
+    float32 *const y = mY.data();
+    float32 *const vx = mVX.data();
+    float32 *const vy = mVY.data();
+    float32 *const nextX = mNextX.data();
+    float32 *const nextY = mNextY.data();
+
+    // same integration as b2Island::Solve(), with the translation
+    // limited per component instead of by length
+    const b2Vec2 g = mDef.gravityScale * mWorld->GetGravity();
+    const float32 damping = 1.f / (1.f + dt * mDef.linearDamping);
+    const float32 maxSpeed = b2_maxTranslation / dt;
+    for (int i = 0; i < n; ++i) {
+      const float32 u = damping * (vx[i] + dt * g.x);
+      const float32 v = damping * (vy[i] + dt * g.y);
+      vx[i] = std::min(std::max(u, -maxSpeed), maxSpeed);
+      vy[i] = std::min(std::max(v, -maxSpeed), maxSpeed);
+      nextX[i] = x[i] + dt * vx[i];
+      nextY[i] = y[i] + dt * vy[i];
+    }
+
+    b2AABB bounds;
+    bounds.lowerBound.Set(std::min(x[0], nextX[0]), std::min(y[0], nextY[0]));
+    bounds.upperBound.Set(std::max(x[0], nextX[0]), std::max(y[0], nextY[0]));
+    for (int i = 1; i < n; ++i) {
+      bounds.lowerBound.x = std::min(bounds.lowerBound.x, std::min(x[i], nextX[i]));
+      bounds.lowerBound.y = std::min(bounds.lowerBound.y, std::min(y[i], nextY[i]));
+      bounds.upperBound.x = std::max(bounds.upperBound.x, std::max(x[i], nextX[i]));
+      bounds.upperBound.y = std::max(bounds.upperBound.y, std::max(y[i], nextY[i]));
+    }
+    collide(bounds);
+
+    mX.swap(mNextX);
+    mY.swap(mNextY);
+  }
+
+
+  void ParticleSystem::collide(const b2AABB &bounds)
+  {
+    mColliders.clear();
+    ColliderQuery query(mDef.filter, bounds, mColliders);
+    mWorld->QueryAABB(&query, bounds);
+    if (mColliders.empty())
+      return;
+    std::sort(mColliders.begin(), mColliders.end(), [](const ParticleCollider &a, const ParticleCollider &b) {
+      return a.fixture < b.fixture || (a.fixture == b.fixture && a.childIndex < b.childIndex);
+    });
+    mColliders.erase(std::unique(mColliders.begin(), mColliders.end(), [](const ParticleCollider &a, const ParticleCollider &b) {
+      return a.fixture == b.fixture && a.childIndex == b.childIndex;
+    }), mColliders.end());
+
+    const int n = count();
+    for (int i = 0; i < n; ++i) {
+      b2RayCastInput input;
+      input.p1.Set(mX[i], mY[i]);
+      input.p2.Set(mNextX[i], mNextY[i]);
+      input.maxFraction = 1.f;
+      b2AABB move;
+      move.lowerBound = b2Min(input.p1, input.p2);
+      move.upperBound = b2Max(input.p1, input.p2);
+
+      const ParticleCollider *hit = nullptr;
+      b2RayCastOutput first;
+      for (std::vector<ParticleCollider>::const_iterator c = mColliders.cbegin(); c != mColliders.cend(); ++c) {
+        if (!b2TestOverlap(move, c->aabb))
+          continue;
+        b2RayCastOutput output;
+        if (c->fixture->RayCast(&output, input, c->childIndex)) {
+          hit = &(*c);
+          first = output;
+          input.maxFraction = output.fraction;
+        }
+      }
+      if (hit == nullptr)
+        continue;
+
+      const b2Vec2 point = input.p1 + first.fraction * (input.p2 - input.p1);
+      const b2Vec2 velocity(mVX[i], mVY[i]);
+      const float32 vn = b2Dot(velocity, first.normal);
+      if (vn < 0.f) {
+        const float32 restitution = -vn > b2_velocityThreshold ? mDef.restitution : 0.f;
+        b2Vec2 vt = velocity - vn * first.normal;
+        const float32 vtLength = vt.Length();
+        if (vtLength > b2_epsilon)
+          vt *= b2Max(0.f, 1.f - mDef.friction * -vn / vtLength);
+        const b2Vec2 bounced = vt - restitution * vn * first.normal;
+        b2Body *body = hit->fixture->GetBody();
+        if (body->GetType() == b2_dynamicBody)
+          body->ApplyLinearImpulse(mMass * (velocity - bounced), point, false);
+        mVX[i] = bounced.x;
+        mVY[i] = bounced.y;
+      }
+      const b2Vec2 pos = point + b2_linearSlop * first.normal;
+      mNextX[i] = pos.x;
+      mNextY[i] = pos.y;
+    }
+  }
+
+}
@@ -0,0 +1,116 @@
+/*  
+
+    Copyright (c) 2015 Oliver Lau <ola@ct.de>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#ifndef __PARTICLESYSTEM_H_
+#define __PARTICLESYSTEM_H_
+
+#include <Box2D/Box2D.h>
+
+#include <vector>
+
+namespace Impact {
+
+  struct ParticleSystemDef
+  {
+    ParticleSystemDef(void)
+      : gravityScale(1.f)
+      , linearDamping(0.f)
+      , radius(0.f)
+      , density(1.f)
+      , friction(0.f)
+      , restitution(0.f)
+    { /* ... */ }
+    float32 gravityScale;
+    float32 linearDamping;
+    float32 radius;
+    float32 density;
+    float32 friction;
+    float32 restitution;
+    b2Filter filter;
+  };
+
+
+  struct ParticleCollider
+  {
+    b2Fixture *fixture;
+    int32 childIndex;
+    b2AABB aabb;
+  };
+
+
+  /// Point particles that live outside of the Box2D world.
+  ///
+  /// Positions, velocities and lifetimes are kept in separate arrays so
+  /// that integration runs as plain loops over floats. Collisions are
+  /// resolved against the fixtures found by a single b2World::QueryAABB()
+  /// over the bounds of all particle moves per step: each move is ray cast
+  /// against those fixtures and the first hit bounces the particle.
+  /// Particles never enter the broadphase, so they cause neither proxies
+  /// nor contacts; dynamic bodies hit by a particle receive its impulse.
+  class ParticleSystem {
+  public:
+    ParticleSystem(b2World *world, const ParticleSystemDef &def);
+
+    void reserve(int n);
+    void add(const b2Vec2 &pos, const b2Vec2 &velocity, float32 lifetime);
+    /// removes all particles whose lifetime is less than `age` and advances the others by `dt` seconds
+    void step(float32 dt, float32 age);
+
+    inline int count(void) const
+    {
+      return int(mX.size());
+    }
+    inline float32 x(int i) const
+    {
+      return mX[i];
+    }
+    inline float32 y(int i) const
+    {
+      return mY[i];
+    }
+    inline float32 lifetime(int i) const
+    {
+      return mLifetime[i];
+    }
+
+  private:
+    b2World *mWorld;
+    ParticleSystemDef mDef;
+    float32 mMass;
+
+    std::vector<float32> mX;
+    std::vector<float32> mY;
+    std::vector<float32> mVX;
+    std::vector<float32> mVY;
+    std::vector<float32> mLifetime;
+
+    // positions at the end of the current step
+    std::vector<float32> mNextX;
+    std::vector<float32> mNextY;
+
+    std::vector<ParticleCollider> mColliders;
+
+    void retire(float32 age);
+    void collide(const b2AABB &bounds);
+  };
+
+}
+
+#endif // __PARTICLESYSTEM_H_
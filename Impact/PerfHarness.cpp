@@ -0,0 +1,788 @@
+/*  
+
+    Copyright (c) 2015 Oliver Lau <ola@ct.de>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include "stdafx.h"
+
+#include <boost/algorithm/string.hpp>
+#include <boost/filesystem.hpp>
+
+#if defined(WIN32)
+#include <Windows.h>
+#include <Psapi.h>
+#elif defined(LINUX_AMD64)
+#include <unistd.h>
+#endif
+
+namespace Impact {
+
+  namespace {
+
+    // Blocks until the GL has executed all pending commands, so that a
+    // measurement covers the rendering itself, not only its submission.
+    void finish(sf::RenderTexture &target)
+    {
+      target.setActive(true);
+      glFinish();
+    }
+
+
+    // current resident set size of the process in bytes
+    std::size_t residentSetSize(void)
+    {
+#if defined(WIN32)
+      PROCESS_MEMORY_COUNTERS pmc;
+      if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+        return std::size_t(pmc.WorkingSetSize);
+#elif defined(LINUX_AMD64)
+      std::ifstream statm("/proc/self/statm");
+      std::size_t size = 0;
+      std::size_t resident = 0;
+      if (statm >> size >> resident)
+        return resident * std::size_t(sysconf(_SC_PAGESIZE));
+#endif
+      return 0;
+    }
+
+
+    class CountingQuery : public b2QueryCallback, public b2RayCastCallback
+    {
+    public:
+      CountingQuery(void)
+        : hits(0)
+      { /* ... */ }
+
+      bool ReportFixture(b2Fixture*)
+      {
+        ++hits;
+        return true;
+      }
+
+      // clips the ray to every hit, as a search for the closest fixture does
+      float32 ReportFixture(b2Fixture*, const b2Vec2&, const b2Vec2&, float32 fraction)
+      {
+        ++hits;
+        return fraction;
+      }
+
+      int hits;
+    };
+
+
+    void parseList(const char *arg, std::vector<int> &values)
+    {
+      std::vector<std::string> items;
+      boost::algorithm::split(items, arg, boost::algorithm::is_any_of(","));
+      values.clear();
+      for (std::vector<std::string>::const_iterator i = items.begin(); i != items.end(); ++i)
+        values.push_back(std::max(1, std::atoi(i->c_str())));
+    }
+
+  }
+
+
+  PerfHarness::PerfHarness(Game *game)
+    : mGame(game)
+  { /* ... */ }
+
+
+  bool PerfHarness::isRequested(int argc, char *argv[])
+  {
+    for (int i = 1; i < argc; ++i)
+      if (std::string(argv[i]) == "--perf")
+        return true;
+    return false;
+  }
+
+
+  void PerfHarness::usage(void) const
+  {
+    const PerfHarnessOptions defaults;
+    std::cout << "Usage: impact --perf SCENARIO [options]" << std::endl
+      << std::endl
+      << "Scenarios:" << std::endl
+      << "  sessions               replay input sessions and time the phases of every tick" << std::endl
+      << "  render                 render every level offscreen and time each post-process effect" << std::endl
+      << "                         (runs on Mesa software GL, e.g. with LIBGL_ALWAYS_SOFTWARE=1)" << std::endl
+      << "  catalog                enumerate a directory of generated levels on the level selection screen" << std::endl
+      << "  explosions             sweep particles per explosion against simultaneous explosions" << std::endl
+      << "  trees                  compare 4-ary with binary broadphase trees in steps, rebuilds, queries and ray casts" << std::endl
+      << std::endl
+      << "Options:" << std::endl
+      << "  --sessions F[,F...]    session files (default: " << ResourcesDir << "/sessions/*.session)" << std::endl
+      << "  --runs N               timed runs per session (default: " << defaults.runs << ")" << std::endl
+      << "  --warmup N             untimed runs per session (default: " << defaults.warmupRuns << ")" << std::endl
+      << "  --levels N[,N...]      levels to render (default: all), the first one is used for explosions" << std::endl
+      << "                         (default for trees: 1)" << std::endl
+      << "  --frames N             timed frames per level or grid cell (default: " << defaults.frames << ")" << std::endl
+      << "  --particles N[,N...]   particles per explosion (default: 50,100,200,400,800)" << std::endl
+      << "  --explosions N[,N...]  simultaneous explosions (default: 1,2,4,8,16)" << std::endl
+      << "  --count N              number of generated levels in the catalog (default: " << defaults.count << ")" << std::endl
+      << "                         or queries and ray casts per tick in the trees scenario" << std::endl
+      << "  --catalog-dir DIR      keep the generated catalog in DIR and reuse it (default: a temporary directory)" << std::endl
+      << "  --json FILE            write results to FILE" << std::endl
+      << "  --baseline FILE        compare results against FILE and exit with 1 on regressions" << std::endl
+      << "  --update-baseline      write results to the baseline file instead of comparing" << std::endl
+      << "  --threshold PCT        tolerated slowdown of the median in percent (default: " << defaults.threshold << ")" << std::endl
+      << "  --alpha P              significance level of the Mann-Whitney test (default: " << defaults.alpha << ")" << std::endl;
+  }
+
+
+  bool PerfHarness::parseArguments(int argc, char *argv[])
+  {
+    for (int i = 1; i < argc; ++i) {
+      const std::string arg = argv[i];
+      const bool hasValue = i + 1 < argc;
+      if (arg == "--perf" && hasValue) {
+        mOptions.scenario = argv[++i];
+      }
+      else if (arg == "--sessions" && hasValue) {
+        boost::algorithm::split(mOptions.sessionFilenames, argv[++i], boost::algorithm::is_any_of(","));
+      }
+      else if (arg == "--runs" && hasValue) {
+        mOptions.runs = std::max(1, std::atoi(argv[++i]));
+      }
+      else if (arg == "--warmup" && hasValue) {
+        mOptions.warmupRuns = std::max(0, std::atoi(argv[++i]));
+      }
+      else if (arg == "--levels" && hasValue) {
+        parseList(argv[++i], mOptions.levels);
+      }
+      else if (arg == "--particles" && hasValue) {
+        parseList(argv[++i], mOptions.particleCounts);
+      }
+      else if (arg == "--explosions" && hasValue) {
+        parseList(argv[++i], mOptions.explosionCounts);
+      }
+      else if (arg == "--frames" && hasValue) {
+        mOptions.frames = std::max(1, std::atoi(argv[++i]));
+      }
+      else if (arg == "--count" && hasValue) {
+        mOptions.count = std::max(1, std::atoi(argv[++i]));
+      }
+      else if (arg == "--catalog-dir" && hasValue) {
+        mOptions.catalogDir = argv[++i];
+      }
+      else if (arg == "--json" && hasValue) {
+        mOptions.jsonFilename = argv[++i];
+      }
+      else if (arg == "--baseline" && hasValue) {
+        mOptions.baselineFilename = argv[++i];
+      }
+      else if (arg == "--update-baseline") {
+        mOptions.updateBaseline = true;
+      }
+      else if (arg == "--threshold" && hasValue) {
+        mOptions.threshold = std::atof(argv[++i]);
+      }
+      else if (arg == "--alpha" && hasValue) {
+        mOptions.alpha = std::atof(argv[++i]);
+      }
+      else {
+        std::cerr << "Unknown option: " << arg << std::endl;
+        return false;
+      }
+    }
+    if (mOptions.updateBaseline && mOptions.baselineFilename.empty()) {
+      std::cerr << "--update-baseline requires --baseline FILE" << std::endl;
+      return false;
+    }
+    return true;
+  }
+
+
+  int PerfHarness::exec(int argc, char *argv[])
+  {
+    if (!parseArguments(argc, argv)) {
+      usage();
+      return EXIT_FAILURE;
+    }
+    if (mOptions.scenario == "sessions")
+      return runSessions();
+    if (mOptions.scenario == "render")
+      return runRender();
+    if (mOptions.scenario == "catalog")
+      return runCatalog();
+    if (mOptions.scenario == "explosions")
+      return runExplosions();
+    if (mOptions.scenario == "trees")
+      return runTrees();
+    usage();
+    return EXIT_FAILURE;
+  }
+
+
+  int PerfHarness::report(const Benchmark &bench) const
+  {
+    bench.print(std::cout);
+    if (!mOptions.jsonFilename.empty())
+      bench.save(mOptions.jsonFilename);
+    if (mOptions.updateBaseline)
+      return bench.save(mOptions.baselineFilename) ? EXIT_SUCCESS : EXIT_FAILURE;
+    if (!mOptions.baselineFilename.empty()) {
+      Benchmark baseline("baseline");
+      if (!baseline.load(mOptions.baselineFilename))
+        return EXIT_FAILURE;
+      std::cout << std::endl;
+      if (bench.compare(baseline, mOptions.threshold, std::cout, mOptions.alpha) > 0)
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+  }
+
+
+  int PerfHarness::runSessions(void)
+  {
+    if (mOptions.sessionFilenames.empty()) {
+      const boost::filesystem::path sessionsDir(ResourcesDir + "/sessions");
+      boost::system::error_code ec;
+      boost::filesystem::directory_iterator di(sessionsDir, ec);
+      for (; di != boost::filesystem::directory_iterator(); ++di)
+        if (di->path().extension() == ".session")
+          mOptions.sessionFilenames.push_back(di->path().generic_string());
+      std::sort(mOptions.sessionFilenames.begin(), mOptions.sessionFilenames.end());
+    }
+    if (mOptions.sessionFilenames.empty()) {
+      std::cerr << "No sessions found." << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    Benchmark bench("sessions");
+    std::vector<std::string>::const_iterator fi;
+    for (fi = mOptions.sessionFilenames.begin(); fi != mOptions.sessionFilenames.end(); ++fi) {
+      Session session;
+      if (!session.load(*fi))
+        return EXIT_FAILURE;
+      for (int run = 0; run < mOptions.warmupRuns; ++run)
+        if (!playSession(session, nullptr))
+          return EXIT_FAILURE;
+      for (int run = 0; run < mOptions.runs; ++run)
+        if (!playSession(session, &bench))
+          return EXIT_FAILURE;
+    }
+    return report(bench);
+  }
+
+
+  bool PerfHarness::playSession(const Session &session, Benchmark *bench)
+  {
+    Game &game = *mGame;
+    gRNG().seed(session.seed());
+    game.mPlaymode = Game::SingleLevel;
+    if (session.levelNum() > 0)
+      game.mLevel.set(session.levelNum(), true);
+    else
+      game.mLevel.loadZip(session.levelZip());
+    if (!game.mLevel.isAvailable()) {
+      std::cerr << session.name() << ": level not available." << std::endl;
+      return false;
+    }
+    game.mLives = Game::DefaultLives;
+    game.mTotalScore = 0;
+    game.gotoCurrentLevel();
+    game.mWindow.setFramerateLimit(0);
+
+    const sf::Time dt = sf::microseconds(1000000 / Session::TicksPerSecond);
+    const std::vector<SessionEvent> &events = session.events();
+    std::vector<SessionEvent>::const_iterator e = events.begin();
+    const SessionEvent *sweep = nullptr;
+    float racketX = game.mRacket != nullptr ? game.mRacket->position().x : 0.f;
+    int kick = 0;
+    for (int tick = 0; tick < session.ticks() && game.mState == Game::State::Playing; ++tick) {
+      for (; e != events.end() && e->tick <= tick; ++e) {
+        switch (e->type) {
+        case SessionEvent::RacketMove:
+          sweep = nullptr;
+          racketX = e->x0;
+          break;
+        case SessionEvent::RacketSweep:
+          sweep = &(*e);
+          break;
+        case SessionEvent::Kick:
+          kick = e->kick;
+          break;
+        case SessionEvent::NewBall:
+          if (game.mBalls.empty())
+            game.newBall();
+          break;
+        default:
+          break;
+        }
+      }
+      if (game.mRacket != nullptr) {
+        if (sweep != nullptr) {
+          // triangle wave between the turning points
+          const float phase = float((tick - sweep->tick) % sweep->period) / float(sweep->period);
+          racketX = sweep->x0 + (sweep->x1 - sweep->x0) * (phase < .5f ? 2.f * phase : 2.f - 2.f * phase);
+        }
+        if (kick < 0)
+          game.mRacket->kickLeft();
+        else if (kick > 0)
+          game.mRacket->kickRight();
+        else
+          game.mRacket->stopKick();
+        game.mRacket->moveTo(b2Vec2(racketX, game.mRacket->position().y));
+      }
+
+      Stopwatch frameStopwatch;
+      game.updatePlayground();
+      game.mElapsed = dt;
+      game.update();
+      Stopwatch drawStopwatch;
+      game.drawPlayground();
+      game.mWindow.display();
+      const double drawTime = drawStopwatch.elapsed();
+      const double frameTime = frameStopwatch.elapsed();
+      game.clearEventQueue();
+
+      if (bench != nullptr) {
+        bench->add(session.name() + "/step", game.mPhaseTimes.step);
+        bench->add(session.name() + "/broadphase", game.mPhaseTimes.broadphase);
+        bench->add(session.name() + "/collisions", game.mPhaseTimes.collisions);
+        bench->add(session.name() + "/bodies", game.mPhaseTimes.bodies);
+        bench->add(session.name() + "/draw", drawTime);
+        bench->add(session.name() + "/frame", frameTime);
+      }
+    }
+    game.stopAllMusic();
+    return true;
+  }
+
+
+  int PerfHarness::runRender(void)
+  {
+    Game &game = *mGame;
+    if (!game.mShadersAvailable) {
+      std::cerr << "Shaders are not available. Without a GPU try LIBGL_ALWAYS_SOFTWARE=1." << std::endl;
+      return EXIT_FAILURE;
+    }
+    if (!gLocalSettings().useShaders()) {
+      gLocalSettings().setUseShaders(true);
+      game.initShaderDependants();
+    }
+
+    sf::RenderTexture frame;
+    frame.create(Game::DefaultWindowWidth, Game::DefaultWindowHeight);
+    Benchmark bench("render");
+    if (mOptions.levels.empty()) {
+      for (int num = 1; renderLevel(num, frame, bench); ++num)
+        /**/;
+    }
+    else {
+      std::vector<int>::const_iterator l;
+      for (l = mOptions.levels.begin(); l != mOptions.levels.end(); ++l) {
+        if (!renderLevel(*l, frame, bench)) {
+          std::cerr << "Level " << *l << " not available." << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+    }
+    return report(bench);
+  }
+
+
+  bool PerfHarness::renderLevel(int num, sf::RenderTexture &frame, Benchmark &bench)
+  {
+    Game &game = *mGame;
+    game.mPlaymode = Game::SingleLevel;
+    if (!game.mLevel.set(num, true))
+      return false;
+    gRNG().seed(uint32_t(num));
+    game.gotoCurrentLevel();
+
+    // let the level come to life so that the scene looks like one during play
+    const sf::Time dt = sf::microseconds(1000000 / Session::TicksPerSecond);
+    game.newBall();
+    for (int tick = 0; tick < Session::TicksPerSecond && game.mState == Game::State::Playing; ++tick) {
+      game.mElapsed = dt;
+      game.update();
+    }
+    if (game.mBalls.empty())
+      game.newBall();
+    const b2Vec2 &center = game.mBalls.front()->position();
+
+    // all effects stay active for the whole measurement
+    game.startBlurEffect();
+    game.startAberrationEffect(2.f, sf::seconds(3600.f));
+    game.startEarthquake(1.f, sf::seconds(3600.f));
+
+    std::ostringstream nameBuf;
+    nameBuf << std::setw(4) << std::setfill('0') << num;
+    const std::string &name = nameBuf.str();
+    frame.setView(game.mPlaygroundView);
+    const int warmupFrames = std::max(1, mOptions.frames / 10);
+    for (int f = -warmupFrames; f < mOptions.frames; ++f) {
+      double t[6];
+      Stopwatch frameStopwatch;
+      Stopwatch stopwatch;
+      game.drawScene(game.mRenderTexture0);
+      finish(game.mRenderTexture0);
+      t[0] = stopwatch.elapsed();
+      stopwatch.restart();
+      game.executeKeyhole(game.mRenderTexture1, game.mRenderTexture0, center, true);
+      finish(game.mRenderTexture0);
+      t[1] = stopwatch.elapsed();
+      stopwatch.restart();
+      game.executeVignette(game.mRenderTexture1, game.mRenderTexture0, true);
+      finish(game.mRenderTexture0);
+      t[2] = stopwatch.elapsed();
+      stopwatch.restart();
+      game.executeBlur(game.mRenderTexture1, game.mRenderTexture0, true);
+      finish(game.mRenderTexture0);
+      t[3] = stopwatch.elapsed();
+      stopwatch.restart();
+      game.executeAberration(game.mRenderTexture1, game.mRenderTexture0, true);
+      finish(game.mRenderTexture0);
+      t[4] = stopwatch.elapsed();
+      stopwatch.restart();
+      game.executeEarthquake(game.mRenderTexture1, game.mRenderTexture0, true);
+      finish(game.mRenderTexture0);
+      t[5] = stopwatch.elapsed();
+      stopwatch.restart();
+      frame.clear(game.mLevel.backgroundColor());
+      sf::Sprite sprite(game.mRenderTexture0.getTexture());
+      sf::RenderStates states;
+      states.shader = &game.mMixShader;
+      frame.draw(sprite, states);
+      frame.display();
+      finish(frame);
+      const double mixTime = stopwatch.elapsed();
+      const double frameTime = frameStopwatch.elapsed();
+      if (f >= 0) {
+        static const char *Phases[6] = { "scene", "keyhole", "vignette", "blur", "aberration", "earthquake" };
+        for (int i = 0; i < 6; ++i)
+          bench.add(name + "/" + Phases[i], t[i]);
+        bench.add(name + "/mix", mixTime);
+        bench.add(name + "/frame", frameTime);
+      }
+    }
+    game.stopAllMusic();
+    return true;
+  }
+
+
+  int PerfHarness::runCatalog(void)
+  {
+    const bool keepCatalog = !mOptions.catalogDir.empty();
+    const std::string &catalogDir = keepCatalog
+      ? mOptions.catalogDir
+      : (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("impact-catalog-%%%%-%%%%-%%%%")).generic_string();
+    boost::filesystem::create_directories(catalogDir);
+    Stopwatch generateStopwatch;
+    int generated = 0;
+    bool ok = true;
+    for (int num = 1; num <= mOptions.count && ok; ++num) {
+      std::ostringstream zipFilename;
+      zipFilename << catalogDir << "/" << std::setw(4) << std::setfill('0') << num << ".zip";
+      if (keepCatalog && fileExists(zipFilename.str()))
+        continue;
+      LevelGeneratorDef def;
+      def.seed = uint32_t(num);
+      def.name = "Synthetic " + std::to_string(num);
+      LevelGenerator generator(def);
+      ok = generator.writeZip(zipFilename.str());
+      if (ok)
+        ++generated;
+    }
+
+    Benchmark bench("catalog");
+    if (ok) {
+      std::cout << "Generated " << generated << " levels in " << catalogDir
+        << " (" << std::setprecision(1) << std::fixed << 1e-6 * generateStopwatch.elapsed() << " s)." << std::endl;
+      gLocalSettings().setLevelsDir(catalogDir);
+      for (int run = 0; run < mOptions.runs && ok; ++run)
+        ok = enumerateCatalog(bench);
+    }
+
+    if (!keepCatalog) {
+      boost::system::error_code ec;
+      boost::filesystem::remove_all(catalogDir, ec);
+    }
+    if (!ok)
+      return EXIT_FAILURE;
+    return report(bench);
+  }
+
+
+  bool PerfHarness::enumerateCatalog(Benchmark &bench)
+  {
+    Game &game = *mGame;
+    game.mLevels.clear();
+    game.mQuitEnumeration = false;
+    game.gotoSelectLevelScreen();
+    game.mWindow.setFramerateLimit(0);
+
+    const sf::Time dt = sf::microseconds(1000000 / Session::TicksPerSecond);
+    bool firstEntryVisible = false;
+    // the growth of the resident set while the screen is up, so that
+    // catalog generation and earlier runs do not count
+    const std::size_t baseResidentSize = residentSetSize();
+    std::size_t maxResidentSize = baseResidentSize;
+    Stopwatch stopwatch;
+    game.enumerateAllLevels();
+    for (;;) {
+      game.mEnumerateMutex.lock();
+      const bool hasEntries = !game.mLevels.empty();
+      game.mEnumerateMutex.unlock();
+      const bool complete = game.mEnumerateFuture.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+
+      Stopwatch frameStopwatch;
+      game.mElapsed = dt;
+      game.onSelectLevelScreen();
+      game.mWindow.display();
+      bench.add("catalog/frame", frameStopwatch.elapsed());
+      game.clearEventQueue();
+      maxResidentSize = std::max(maxResidentSize, residentSetSize());
+
+      if (hasEntries && !firstEntryVisible) {
+        bench.add("catalog/first_entry", stopwatch.elapsed());
+        firstEntryVisible = true;
+      }
+      if (complete) {
+        bench.add("catalog/complete", stopwatch.elapsed());
+        break;
+      }
+    }
+    // not a time; the key carries the unit
+    bench.add("catalog/rss_growth_kib", double(maxResidentSize - baseResidentSize) / 1024.0);
+    if (int(game.mLevels.size()) < mOptions.count) {
+      std::cerr << "Only " << game.mLevels.size() << " of " << mOptions.count << " levels were enumerated." << std::endl;
+      return false;
+    }
+    return true;
+  }
+
+
+  int PerfHarness::runExplosions(void)
+  {
+    if (mOptions.particleCounts.empty()) {
+      static const int DefaultParticleCounts[] = { 50, 100, 200, 400, 800 };
+      mOptions.particleCounts.assign(DefaultParticleCounts, DefaultParticleCounts + 5);
+    }
+    if (mOptions.explosionCounts.empty()) {
+      static const int DefaultExplosionCounts[] = { 1, 2, 4, 8, 16 };
+      mOptions.explosionCounts.assign(DefaultExplosionCounts, DefaultExplosionCounts + 5);
+    }
+    const int level = mOptions.levels.empty() ? 1 : mOptions.levels.front();
+
+    Benchmark bench("explosions");
+    std::vector<ExplosionGridCell> grid;
+    std::vector<int>::const_iterator p;
+    std::vector<int>::const_iterator e;
+    for (p = mOptions.particleCounts.begin(); p != mOptions.particleCounts.end(); ++p) {
+      for (e = mOptions.explosionCounts.begin(); e != mOptions.explosionCounts.end(); ++e) {
+        ExplosionGridCell cell;
+        cell.particles = *p;
+        cell.explosions = *e;
+        if (!explode(level, cell, bench))
+          return EXIT_FAILURE;
+        grid.push_back(cell);
+      }
+    }
+
+    // one table per measure, particles per explosion down, simultaneous explosions across
+    static const char *Measures[4] = { "median step time (us)", "mean broadphase proxies", "mean draw calls", "median frame time (us)" };
+    for (int m = 0; m < 4; ++m) {
+      std::cout << Measures[m] << std::endl << std::setw(10) << "p \\ e";
+      for (e = mOptions.explosionCounts.begin(); e != mOptions.explosionCounts.end(); ++e)
+        std::cout << std::setw(12) << *e;
+      std::cout << std::endl;
+      std::vector<ExplosionGridCell>::const_iterator cell = grid.begin();
+      for (p = mOptions.particleCounts.begin(); p != mOptions.particleCounts.end(); ++p) {
+        std::cout << std::setw(10) << *p << std::fixed << std::setprecision(1);
+        for (e = mOptions.explosionCounts.begin(); e != mOptions.explosionCounts.end(); ++e, ++cell) {
+          const double values[4] = { cell->step, cell->proxies, cell->drawCalls, cell->frame };
+          std::cout << std::setw(12) << values[m];
+        }
+        std::cout << std::endl;
+      }
+      std::cout << std::endl;
+    }
+    return report(bench);
+  }
+
+
+  bool PerfHarness::explode(int level, ExplosionGridCell &cell, Benchmark &bench)
+  {
+    Game &game = *mGame;
+    game.mPlaymode = Game::SingleLevel;
+    if (!game.mLevel.set(level, true)) {
+      std::cerr << "Level " << level << " not available." << std::endl;
+      return false;
+    }
+    gRNG().seed(uint32_t(cell.particles * 1000 + cell.explosions));
+    game.gotoCurrentLevel();
+    game.mWindow.setFramerateLimit(0);
+
+    // spread the explosions evenly over the upper part of the playground;
+    // they outlive the measurement so that every tick sees all particles
+    std::vector<Explosion*> explosions;
+    for (int i = 0; i < cell.explosions; ++i) {
+      const b2Vec2 pos(float32(game.mLevel.width()) * float32(i + 1) / float32(cell.explosions + 1), .3f * float32(game.mLevel.height()));
+      ExplosionDef pd(&game, pos);
+      pd.ballCollisionEnabled = game.mLevel.explosionParticlesCollideWithBall();
+      pd.count = cell.particles;
+      pd.texture = game.mParticleTexture;
+      pd.minLifetime = sf::seconds(3600.f);
+      pd.maxLifetime = sf::seconds(3600.f);
+      Explosion *explosion = new Explosion(pd);
+      game.addBody(explosion);
+      explosions.push_back(explosion);
+    }
+
+    std::ostringstream keyBuf;
+    keyBuf << "p" << cell.particles << "xe" << cell.explosions;
+    const std::string &key = keyBuf.str();
+    const sf::Time dt = sf::microseconds(1000000 / Session::TicksPerSecond);
+    std::vector<double> stepTimes;
+    std::vector<double> frameTimes;
+    // particles live outside the world, so the proxy count shows
+    // whether they stay out of the broadphase
+    double proxies = 0.0;
+    double drawCalls = 0.0;
+    for (int tick = 0; tick < mOptions.frames; ++tick) {
+      Stopwatch frameStopwatch;
+      game.mElapsed = dt;
+      game.update();
+      proxies += game.mWorld->GetProxyCount();
+      Explosion::resetDrawCalls();
+      game.drawPlayground();
+      game.mWindow.display();
+      drawCalls += Explosion::drawCalls();
+      const double frameTime = frameStopwatch.elapsed();
+      game.clearEventQueue();
+      stepTimes.push_back(game.mPhaseTimes.step);
+      frameTimes.push_back(frameTime);
+      bench.add(key + "/step", game.mPhaseTimes.step);
+      bench.add(key + "/frame", frameTime);
+    }
+    cell.step = Benchmark::evaluate(stepTimes).median;
+    cell.frame = Benchmark::evaluate(frameTimes).median;
+    cell.proxies = proxies / mOptions.frames;
+    cell.drawCalls = drawCalls / mOptions.frames;
+
+    // let update() delete the explosions
+    std::vector<Explosion*>::const_iterator x;
+    for (x = explosions.begin(); x != explosions.end(); ++x)
+      (*x)->kill();
+    game.mElapsed = dt;
+    game.update();
+    game.stopAllMusic();
+    return true;
+  }
+
+
+  int PerfHarness::runTrees(void)
+  {
+    if (mOptions.levels.empty())
+      mOptions.levels.push_back(1);
+    Benchmark bench("trees");
+    std::vector<int>::const_iterator l;
+    for (l = mOptions.levels.begin(); l != mOptions.levels.end(); ++l)
+      if (!queryTrees(*l, bench))
+        return EXIT_FAILURE;
+    return report(bench);
+  }
+
+
+  bool PerfHarness::queryTrees(int level, Benchmark &bench)
+  {
+    Game &game = *mGame;
+    game.mPlaymode = Game::SingleLevel;
+    if (!game.mLevel.set(level, true)) {
+      std::cerr << "Level " << level << " not available." << std::endl;
+      return false;
+    }
+    gRNG().seed(uint32_t(level));
+    game.gotoCurrentLevel();
+    game.mWindow.setFramerateLimit(0);
+    game.newBall();
+
+    std::ostringstream nameBuf;
+    nameBuf << std::setw(4) << std::setfill('0') << level;
+    const std::string &name = nameBuf.str();
+    const float32 width = float32(game.mLevel.width());
+    const float32 height = float32(game.mLevel.height());
+    std::uniform_real_distribution<float32> randomX(0.f, width);
+    std::uniform_real_distribution<float32> randomY(0.f, height);
+    std::uniform_real_distribution<float32> randomExtent(.5f, 4.f);
+    const sf::Time dt = sf::microseconds(1000000 / Session::TicksPerSecond);
+    const int warmupTicks = std::max(1, mOptions.frames / 10);
+    for (int tick = -warmupTicks; tick < mOptions.frames && game.mState == Game::State::Playing; ++tick) {
+      // both kinds of tree see the same mix of ticks
+      const bool wide = (tick & 1) == 0;
+      const std::string &kind = wide ? "-wide" : "-binary";
+      game.mWorld->SetWideTrees(wide);
+      game.mElapsed = dt;
+      game.update();
+      if (game.mBalls.empty())
+        game.newBall();
+      game.clearEventQueue();
+
+      // the same queries go to both kinds of tree
+      std::vector<b2AABB> boxes(mOptions.count);
+      std::vector<b2Vec2> rays(2 * mOptions.count);
+      for (int i = 0; i < mOptions.count; ++i) {
+        boxes[i].lowerBound.Set(randomX(gRNG()), randomY(gRNG()));
+        boxes[i].upperBound = boxes[i].lowerBound + b2Vec2(randomExtent(gRNG()), randomExtent(gRNG()));
+        rays[2 * i].Set(randomX(gRNG()), randomY(gRNG()));
+        rays[2 * i + 1].Set(randomX(gRNG()), randomY(gRNG()));
+      }
+      int hits[2] = { 0, 0 };
+      for (int t = 0; t < 2; ++t) {
+        game.mWorld->SetWideTrees(t == 0);
+        const std::string &suffix = t == 0 ? "-wide" : "-binary";
+        // the step leaves the dynamic 4-ary tree stale, so it is
+        // rebuilt for the queries and the rebuild timed on its own
+        Stopwatch stopwatch;
+        game.mWorld->BuildWideTrees();
+        const double rebuildTime = stopwatch.elapsed();
+        CountingQuery query;
+        stopwatch.restart();
+        for (int i = 0; i < mOptions.count; ++i)
+          game.mWorld->QueryAABB(&query, boxes[i]);
+        const double queryTime = stopwatch.elapsed();
+        stopwatch.restart();
+        for (int i = 0; i < mOptions.count; ++i)
+          if ((rays[2 * i + 1] - rays[2 * i]).LengthSquared() > 0.f)
+            game.mWorld->RayCast(&query, rays[2 * i], rays[2 * i + 1]);
+        const double rayCastTime = stopwatch.elapsed();
+        hits[t] = query.hits;
+        if (tick >= 0) {
+          if (t == 0)
+            bench.add(name + "/rebuild" + suffix, rebuildTime);
+          bench.add(name + "/query" + suffix, queryTime);
+          bench.add(name + "/raycast" + suffix, rayCastTime);
+        }
+      }
+      if (hits[0] != hits[1]) {
+        std::cerr << name << ": 4-ary and binary trees disagree (" << hits[0] << " vs. " << hits[1] << " hits)." << std::endl;
+        return false;
+      }
+      if (tick >= 0) {
+        bench.add(name + "/step" + kind, game.mPhaseTimes.step);
+        bench.add(name + "/broadphase" + kind, game.mPhaseTimes.broadphase);
+      }
+    }
+    game.mWorld->SetWideTrees(true);
+    game.stopAllMusic();
+    return true;
+  }
+
+}
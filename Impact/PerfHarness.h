@@ -0,0 +1,128 @@
+/*  
+
+    Copyright (c) 2015 Oliver Lau <ola@ct.de>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __PERFHARNESS_H_
+#define __PERFHARNESS_H_
+
+#include <string>
+#include <vector>
+
+#include "Benchmark.h"
+#include "Session.h"
+
+namespace Impact {
+
+  class Game;
+
+  struct PerfHarnessOptions {
+    PerfHarnessOptions(void)
+      : runs(5)
+      , warmupRuns(1)
+      , frames(100)
+      , count(1000)
+      , threshold(Benchmark::DefaultThreshold)
+      , alpha(Benchmark::DefaultAlpha)
+      , updateBaseline(false)
+    { /* ... */ }
+    std::string scenario;
+    std::vector<std::string> sessionFilenames;
+    std::vector<int> levels;
+    std::vector<int> particleCounts;
+    std::vector<int> explosionCounts;
+    int runs;
+    int warmupRuns;
+    int frames;
+    int count;
+    std::string catalogDir;
+    double threshold;
+    double alpha;
+    bool updateBaseline;
+    std::string baselineFilename;
+    std::string jsonFilename;
+  };
+
+
+  /// Runs the game headlessly through benchmark scenarios and judges
+  /// the results against a stored baseline.
+  ///
+  /// Usage: impact --perf sessions|render|catalog|explosions|trees [options]
+  ///
+  /// Every tick of every session run contributes one sample per phase
+  /// (step, broadphase, collisions, bodies, draw, frame) so that the distributions,
+  /// not only their means, can be compared with the Mann-Whitney test.
+  ///
+  /// The render scenario draws the playground of each level offscreen
+  /// and times the scene, every post-process effect and the final mix
+  /// separately. It needs no GPU; Mesa's llvmpipe driver is sufficient.
+  ///
+  /// The catalog scenario fills a levels directory with generated zips
+  /// and measures how the level selection screen copes while
+  /// Game::enumerateAllLevels() works through them.
+  ///
+  /// The explosions scenario sweeps the number of particles per
+  /// explosion against the number of simultaneous explosions and prints
+  /// a grid of step time, broadphase proxies, draw calls and frame time.
+  ///
+  /// The trees scenario compares the 4-ary broadphase trees with the
+  /// binary ones on a running level: ticks alternate between the two,
+  /// and every tick is followed by batches of random AABB queries and
+  /// ray casts against the world with either kind of tree. The rebuild
+  /// of the dynamic 4-ary tree before the queries is reported on its own.
+  class PerfHarness {
+  public:
+    PerfHarness(Game *game);
+
+    static bool isRequested(int argc, char *argv[]);
+    int exec(int argc, char *argv[]);
+
+  private:
+    Game *mGame;
+    PerfHarnessOptions mOptions;
+
+    bool parseArguments(int argc, char *argv[]);
+    void usage(void) const;
+    int report(const Benchmark &bench) const;
+
+    int runSessions(void);
+    bool playSession(const Session &session, Benchmark *bench);
+
+    int runRender(void);
+    bool renderLevel(int num, sf::RenderTexture &frame, Benchmark &bench);
+
+    int runCatalog(void);
+    bool enumerateCatalog(Benchmark &bench);
+
+    struct ExplosionGridCell {
+      int particles;
+      int explosions;
+      double step;
+      double proxies;
+      double drawCalls;
+      double frame;
+    };
+    int runExplosions(void);
+    bool explode(int level, ExplosionGridCell &cell, Benchmark &bench);
+
+    int runTrees(void);
+    bool queryTrees(int level, Benchmark &bench);
+  };
+
+}
+
+#endif // __PERFHARNESS_H_
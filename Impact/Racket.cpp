@@ -37,53 +37,31 @@ namespace Impact {
     mSprite.setOrigin(sf::Vector2f(.5f * mTexture.getSize().x, .5f * mTexture.getSize().y));
 
     setHalfTextureSize(mTexture);
+    // the sprite follows the tilting body, which is not tied to this Body
+    startUpdates();
 
     b2BodyDef bd;
     bd.type = b2_dynamicBody;
     bd.gravityScale = 0.f;
     mTiltingBody = mGame->world()->CreateBody(&bd);
 
-    b2PolygonShape polygon;
+    b2CapsuleShape capsule;
     const float32 hs = .5f * Game::InvScale;
     const float32 hh = hs * mTexture.getSize().y;
     const float32 xoff = hs * (mTexture.getSize().x - mTexture.getSize().y);
-    polygon.SetAsBox(xoff, hh);
+    capsule.Set(b2Vec2(-xoff, 0.f), b2Vec2(xoff, 0.f), hh);
 
     const float32 density = tileParam.density.isValid() ? tileParam.density.get() : DefaultDensity;
     const float32 friction = tileParam.friction.isValid() ? tileParam.friction.get() : DefaultFriction;
     const float32 restitution = tileParam.restitution.isValid() ? tileParam.restitution.get() : DefaultRestitution;
 
-    b2FixtureDef fdBox;
-    fdBox.shape = &polygon;
-    fdBox.density = density;
-    fdBox.friction = friction;
-    fdBox.restitution = restitution;
-    fdBox.userData = this;
-    mTiltingBody->CreateFixture(&fdBox);
-
-    b2CircleShape circleL;
-    circleL.m_p.x = -xoff;
-    circleL.m_radius = hh;
-
-    b2FixtureDef fdCircleL;
-    fdCircleL.shape = &circleL;
-    fdCircleL.density = density;
-    fdCircleL.friction = friction;
-    fdCircleL.restitution = restitution;
-    fdCircleL.userData = this;
-    mTiltingBody->CreateFixture(&fdCircleL);
-
-    b2CircleShape circleR;
-    circleR.m_p.x = xoff;
-    circleR.m_radius = hh;
-
-    b2FixtureDef fdCircleR;
-    fdCircleR.shape = &circleR;
-    fdCircleR.density = density;
-    fdCircleR.friction = friction;
-    fdCircleR.restitution = restitution;
-    fdCircleR.userData = this;
-    mTiltingBody->CreateFixture(&fdCircleR);
+    b2FixtureDef fd;
+    fd.shape = &capsule;
+    fd.density = density * capsuleDensityScale(xoff, hh);
+    fd.friction = friction;
+    fd.restitution = restitution;
+    fd.userData = this;
+    mTiltingBody->CreateFixture(&fd);
 
     b2BodyDef bdHinge;
     bdHinge.type = b2_dynamicBody;
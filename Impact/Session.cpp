@@ -0,0 +1,290 @@
+/*  
+
+    Copyright (c) 2015 Oliver Lau <ola@ct.de>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include "stdafx.h"
+
+#include <boost/algorithm/string.hpp>
+#include <boost/filesystem.hpp>
+
+#include <cmath>
+
+namespace Impact {
+
+  const int Session::DefaultTicks = 30 * Session::TicksPerSecond;
+
+  Session::Session(void)
+    : mLevelNum(0)
+    , mTicks(DefaultTicks)
+    , mSeed(0)
+  { /* ... */ }
+
+
+  void Session::setName(const std::string &name)
+  {
+    mName = name;
+  }
+
+
+  void Session::setLevel(int num)
+  {
+    mLevelNum = num;
+    mLevelZip.clear();
+  }
+
+
+  void Session::setLevelZip(const std::string &zipFilename)
+  {
+    mLevelNum = 0;
+    mLevelZip = zipFilename;
+  }
+
+
+  void Session::setTicks(int ticks)
+  {
+    mTicks = ticks;
+  }
+
+
+  void Session::setSeed(uint32_t seed)
+  {
+    mSeed = seed;
+  }
+
+
+  void Session::add(const SessionEvent &event)
+  {
+    mEvents.push_back(event);
+  }
+
+
+  bool Session::load(const std::string &filename)
+  {
+    std::ifstream is(filename);
+    if (!is.is_open()) {
+      std::cerr << "Cannot open session " << filename << std::endl;
+      return false;
+    }
+    mName = boost::filesystem::path(filename).stem().generic_string();
+    mLevelNum = 0;
+    mLevelZip.clear();
+    mTicks = DefaultTicks;
+    mSeed = 0;
+    mEvents.clear();
+    std::string line;
+    int lineNo = 0;
+    while (std::getline(is, line)) {
+      ++lineNo;
+      const std::string::size_type hash = line.find('#');
+      if (hash != std::string::npos)
+        line.erase(hash);
+      boost::algorithm::trim(line);
+      if (line.empty())
+        continue;
+      std::istringstream ls(line);
+      std::string keyword;
+      ls >> keyword;
+      bool ok = true;
+      if (keyword == "name") {
+        ls >> mName;
+      }
+      else if (keyword == "level") {
+        std::string level;
+        ls >> level;
+        if (!level.empty() && std::all_of(level.begin(), level.end(), ::isdigit))
+          setLevel(std::atoi(level.c_str()));
+        else
+          setLevelZip(level);
+      }
+      else if (keyword == "ticks") {
+        ok = !(ls >> mTicks).fail() && mTicks > 0;
+      }
+      else if (keyword == "seed") {
+        ok = !(ls >> mSeed).fail();
+      }
+      else if (!keyword.empty() && std::all_of(keyword.begin(), keyword.end(), ::isdigit)) {
+        SessionEvent event;
+        event.tick = std::atoi(keyword.c_str());
+        std::string command;
+        ls >> command;
+        if (command == "racket") {
+          event.type = SessionEvent::RacketMove;
+          ok = !(ls >> event.x0).fail();
+        }
+        else if (command == "sweep") {
+          event.type = SessionEvent::RacketSweep;
+          ok = !(ls >> event.x0 >> event.x1 >> event.period).fail() && event.period > 0;
+        }
+        else if (command == "kick") {
+          std::string direction;
+          ls >> direction;
+          event.type = SessionEvent::Kick;
+          if (direction == "left")
+            event.kick = -1;
+          else if (direction == "right")
+            event.kick = 1;
+          else if (direction == "stop")
+            event.kick = 0;
+          else
+            ok = false;
+        }
+        else if (command == "newball") {
+          event.type = SessionEvent::NewBall;
+        }
+        else {
+          ok = false;
+        }
+        if (ok)
+          mEvents.push_back(event);
+      }
+      else {
+        ok = false;
+      }
+      if (!ok) {
+        std::cerr << filename << ":" << lineNo << ": cannot parse '" << line << "'" << std::endl;
+        return false;
+      }
+    }
+    if (!hasLevel()) {
+      std::cerr << filename << ": no level given." << std::endl;
+      return false;
+    }
+    std::stable_sort(mEvents.begin(), mEvents.end(), [](const SessionEvent &a, const SessionEvent &b) {
+      return a.tick < b.tick;
+    });
+    return true;
+  }
+
+
+  bool Session::save(const std::string &filename) const
+  {
+    std::ofstream os(filename);
+    if (!os.is_open()) {
+      std::cerr << "Cannot write session " << filename << std::endl;
+      return false;
+    }
+    if (!mName.empty())
+      os << "name " << mName << std::endl;
+    if (mLevelNum > 0)
+      os << "level " << mLevelNum << std::endl;
+    else
+      os << "level " << mLevelZip << std::endl;
+    os << "ticks " << mTicks << std::endl
+      << "seed " << mSeed << std::endl;
+    std::vector<SessionEvent>::const_iterator e;
+    for (e = mEvents.begin(); e != mEvents.end(); ++e) {
+      os << e->tick << " ";
+      switch (e->type) {
+      case SessionEvent::RacketMove:
+        os << "racket " << e->x0;
+        break;
+      case SessionEvent::RacketSweep:
+        os << "sweep " << e->x0 << " " << e->x1 << " " << e->period;
+        break;
+      case SessionEvent::Kick:
+        os << "kick " << (e->kick < 0 ? "left" : (e->kick > 0 ? "right" : "stop"));
+        break;
+      case SessionEvent::NewBall:
+        os << "newball";
+        break;
+      default:
+        break;
+      }
+      os << std::endl;
+    }
+    return true;
+  }
+
+
+
+  SessionRecorder::SessionRecorder(const std::string &filename)
+    : mFilename(filename)
+    , mRecording(false)
+    , mTick(0)
+    , mRacketX(-1.f)
+    , mKick(0)
+  { /* ... */ }
+
+
+  SessionRecorder::~SessionRecorder()
+  {
+    end();
+  }
+
+
+  void SessionRecorder::setLevelZip(const std::string &zipFilename)
+  {
+    mLevelZip = zipFilename;
+  }
+
+
+  void SessionRecorder::levelStarted(int levelNum)
+  {
+    if (mSession.hasLevel()) {
+      end();
+      return;
+    }
+    if (mLevelZip.empty())
+      mSession.setLevel(levelNum);
+    else
+      mSession.setLevelZip(mLevelZip);
+    mSession.setName(boost::filesystem::path(mFilename).stem().generic_string());
+    mRecording = true;
+    mTick = 0;
+    mRacketX = -1.f;
+    mKick = 0;
+  }
+
+
+  void SessionRecorder::end(void)
+  {
+    if (!mRecording)
+      return;
+    mRecording = false;
+    mSession.setTicks(mTick);
+    mSession.save(mFilename);
+  }
+
+
+  void SessionRecorder::tick(float racketX, int kick, bool newBall)
+  {
+    if (!mRecording)
+      return;
+    SessionEvent event;
+    event.tick = mTick;
+    if (newBall) {
+      event.type = SessionEvent::NewBall;
+      mSession.add(event);
+    }
+    if (std::abs(racketX - mRacketX) * Game::Scale >= 1.f) {
+      event.type = SessionEvent::RacketMove;
+      event.x0 = racketX;
+      mSession.add(event);
+      mRacketX = racketX;
+    }
+    if (kick != mKick) {
+      event.type = SessionEvent::Kick;
+      event.kick = kick;
+      mSession.add(event);
+      mKick = kick;
+    }
+    ++mTick;
+  }
+
+}
@@ -0,0 +1,162 @@
+/*  
+
+    Copyright (c) 2015 Oliver Lau <ola@ct.de>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __SESSION_H_
+#define __SESSION_H_
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace Impact {
+
+  struct SessionEvent {
+    typedef enum _Type {
+      RacketMove,
+      RacketSweep,
+      Kick,
+      NewBall,
+      LastType
+    } Type;
+
+    SessionEvent(void)
+      : tick(0)
+      , type(NewBall)
+      , x0(0)
+      , x1(0)
+      , period(0)
+      , kick(0)
+    { /* ... */ }
+    int tick;
+    Type type;
+    /// target x of RacketMove, left and right turning point of RacketSweep (in tiles)
+    float x0;
+    float x1;
+    /// ticks of a full sweep from x0 to x1 and back
+    int period;
+    /// -1 kicks left, 1 kicks right, 0 stops kicking
+    int kick;
+  };
+
+
+  /// A deterministic sequence of player input for one level.
+  ///
+  /// Sessions are stored as text, one statement per line:
+  ///
+  ///     name level1-sweep
+  ///     level 1                 (or the path of a level zip)
+  ///     ticks 1800
+  ///     seed 1
+  ///     0 newball
+  ///     0 sweep 4 36 240
+  ///     600 kick left
+  ///     610 kick stop
+  ///     900 racket 20
+  ///
+  /// Event lines start with the tick at which they take effect; ticks
+  /// are frames of 1/60 s. `#` starts a comment.
+  class Session {
+  public:
+    Session(void);
+
+    static const int DefaultTicks;
+    static const int TicksPerSecond = 60;
+
+    bool load(const std::string &filename);
+    bool save(const std::string &filename) const;
+
+    void setName(const std::string &name);
+    void setLevel(int num);
+    void setLevelZip(const std::string &zipFilename);
+    void setTicks(int ticks);
+    void setSeed(uint32_t seed);
+    void add(const SessionEvent &event);
+
+    inline const std::string &name(void) const
+    {
+      return mName;
+    }
+    inline int levelNum(void) const
+    {
+      return mLevelNum;
+    }
+    inline const std::string &levelZip(void) const
+    {
+      return mLevelZip;
+    }
+    inline bool hasLevel(void) const
+    {
+      return mLevelNum > 0 || !mLevelZip.empty();
+    }
+    inline int ticks(void) const
+    {
+      return mTicks;
+    }
+    inline uint32_t seed(void) const
+    {
+      return mSeed;
+    }
+    inline const std::vector<SessionEvent> &events(void) const
+    {
+      return mEvents;
+    }
+
+  private:
+    std::string mName;
+    int mLevelNum;
+    std::string mLevelZip;
+    int mTicks;
+    uint32_t mSeed;
+    std::vector<SessionEvent> mEvents;
+  };
+
+
+  /// Records the input of an interactive game as a Session, so that it
+  /// can be replayed by the performance harness. Only the first level
+  /// played is recorded; the session is written on destruction.
+  class SessionRecorder {
+  public:
+    SessionRecorder(const std::string &filename);
+    ~SessionRecorder();
+
+    /// must be called before levelStarted() if the level comes from a zip file
+    void setLevelZip(const std::string &zipFilename);
+    /// starts recording on the first call, stops it on the next
+    void levelStarted(int levelNum);
+    void end(void);
+    void tick(float racketX, int kick, bool newBall);
+
+    inline bool isRecording(void) const
+    {
+      return mRecording;
+    }
+
+  private:
+    std::string mFilename;
+    std::string mLevelZip;
+    Session mSession;
+    bool mRecording;
+    int mTick;
+    float mRacketX;
+    int mKick;
+  };
+
+}
+
+#endif // __SESSION_H_
@@ -0,0 +1,131 @@
+/*  
+
+    Copyright (c) 2015 Oliver Lau <ola@ct.de>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include "stdafx.h"
+
+#include <cmath>
+
+namespace Impact {
+
+  const float32 StepScheduler::MaxTravelPerSubStep = .25f;
+  const int StepScheduler::MaxSubSteps = 8;
+  const int StepScheduler::MinVelocityIterations = 8;
+  const int StepScheduler::MinPositionIterations = 3;
+  const int StepScheduler::CrowdedBodyCount = 64;
+
+
+  StepScheduler::StepScheduler(void)
+    : mEnabled(true)
+    , mMaxVelocityIterations(MinVelocityIterations)
+    , mMaxPositionIterations(MinPositionIterations)
+    , mGravityScale(1.f)
+    , mDensityScale(1.f)
+    , mLog(nullptr)
+    , mTick(0)
+  { /* ... */ }
+
+
+  void StepScheduler::setEnabled(bool enabled)
+  {
+    mEnabled = enabled;
+  }
+
+
+  void StepScheduler::setMaxIterations(int velocityIterations, int positionIterations)
+  {
+    mMaxVelocityIterations = velocityIterations;
+    mMaxPositionIterations = positionIterations;
+  }
+
+
+  void StepScheduler::setGravityScale(float32 scale)
+  {
+    mGravityScale = scale;
+  }
+
+
+  void StepScheduler::setDensityScale(float32 scale)
+  {
+    mDensityScale = scale;
+  }
+
+
+  void StepScheduler::setLog(std::ostream *log)
+  {
+    mLog = log;
+  }
+
+
+  const StepSchedule &StepScheduler::schedule(const b2World *world, float32 dt)
+  {
+    float32 maxSpeedSquared = 0.f;
+    int awakeBodyCount = 0;
+    for (const b2Body *body = world->GetBodyList(); body != nullptr; body = body->GetNext()) {
+      if (body->GetType() == b2_staticBody || !body->IsAwake())
+        continue;
+      ++awakeBodyCount;
+      maxSpeedSquared = std::max(maxSpeedSquared, body->GetLinearVelocity().LengthSquared());
+    }
+    mSchedule.maxSpeed = std::sqrt(maxSpeedSquared);
+    mSchedule.awakeBodyCount = awakeBodyCount;
+
+    if (mEnabled) {
+      int subSteps = int(std::ceil(mSchedule.maxSpeed * dt / MaxTravelPerSubStep));
+      const float32 gravityScale = std::abs(mGravityScale);
+      if (gravityScale > 1.f)
+        subSteps = std::max(subSteps, int(std::ceil(gravityScale)));
+      mSchedule.subSteps = b2Clamp(subSteps, 1, MaxSubSteps);
+
+      const int maxVelocityIterations = std::max(MinVelocityIterations, mMaxVelocityIterations);
+      const int maxPositionIterations = std::max(MinPositionIterations, mMaxPositionIterations);
+      int velocityIterations = maxVelocityIterations;
+      int positionIterations = maxPositionIterations;
+      const bool densityScaled = mDensityScale > 0.f && mDensityScale != 1.f;
+      if (!densityScaled && awakeBodyCount < CrowdedBodyCount) {
+        velocityIterations = MinVelocityIterations + (maxVelocityIterations - MinVelocityIterations) * awakeBodyCount / CrowdedBodyCount;
+        positionIterations = MinPositionIterations + (maxPositionIterations - MinPositionIterations) * awakeBodyCount / CrowdedBodyCount;
+      }
+      mSchedule.velocityIterations = std::max(MinVelocityIterations, velocityIterations / mSchedule.subSteps);
+      mSchedule.positionIterations = std::max(MinPositionIterations, positionIterations / mSchedule.subSteps);
+    }
+    else {
+      mSchedule.subSteps = 1;
+      mSchedule.velocityIterations = mMaxVelocityIterations;
+      mSchedule.positionIterations = mMaxPositionIterations;
+    }
+
+    if (mLog != nullptr) {
+      *mLog << "step " << mTick
+        << " dt=" << dt
+        << " speed=" << mSchedule.maxSpeed
+        << " awake=" << awakeBodyCount
+        << " g*" << mGravityScale
+        << " rho*" << mDensityScale
+        << " -> substeps=" << mSchedule.subSteps
+        << " vel=" << mSchedule.velocityIterations
+        << " pos=" << mSchedule.positionIterations
+        << std::endl;
+    }
+    ++mTick;
+
+    return mSchedule;
+  }
+
+}
@@ -0,0 +1,100 @@
+/*  
+
+    Copyright (c) 2015 Oliver Lau <ola@ct.de>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __STEPSCHEDULER_H_
+#define __STEPSCHEDULER_H_
+
+#include <Box2D/Box2D.h>
+
+#include <iostream>
+
+namespace Impact {
+
+  /// what StepScheduler::schedule() decided for one tick
+  struct StepSchedule {
+    StepSchedule(void)
+      : subSteps(1)
+      , velocityIterations(0)
+      , positionIterations(0)
+      , maxSpeed(0.f)
+      , awakeBodyCount(0)
+    { /* ... */ }
+    int subSteps;
+    /// iterations per sub-step
+    int velocityIterations;
+    int positionIterations;
+    /// fastest awake body in m/s
+    float32 maxSpeed;
+    int awakeBodyCount;
+  };
+
+
+  /// Decides how many sub-steps and solver iterations a tick of the
+  /// physics needs.
+  ///
+  /// The configured velocity and position iterations are upper bounds,
+  /// raised to MinVelocityIterations and MinPositionIterations.
+  /// A tick is split into sub-steps so that no body travels farther than
+  /// MaxTravelPerSubStep per sub-step; scaled gravity adds sub-steps in
+  /// proportion to the scale. The iterations grow with the number of
+  /// awake bodies and reach their maximum at CrowdedBodyCount or while
+  /// the ball density is scaled, because unequal masses converge slowly.
+  /// Sub-steps share the iterations of the tick. A quiet scene thus costs
+  /// a single step with few iterations. If disabled, every tick is a
+  /// single step with the configured iterations as they are.
+  class StepScheduler {
+  public:
+    StepScheduler(void);
+
+    static const float32 MaxTravelPerSubStep;
+    static const int MaxSubSteps;
+    static const int MinVelocityIterations;
+    static const int MinPositionIterations;
+    static const int CrowdedBodyCount;
+
+    void setEnabled(bool enabled);
+    void setMaxIterations(int velocityIterations, int positionIterations);
+    /// factor by which the gravity of the level is scaled, 1 if it is not
+    void setGravityScale(float32 scale);
+    /// factor by which the density of the balls is scaled, 1 if it is not
+    void setDensityScale(float32 scale);
+    /// write every decision to `log`, or nothing if `log` is nullptr
+    void setLog(std::ostream *log);
+
+    const StepSchedule &schedule(const b2World *world, float32 dt);
+
+    inline const StepSchedule &current(void) const
+    {
+      return mSchedule;
+    }
+
+  private:
+    bool mEnabled;
+    int mMaxVelocityIterations;
+    int mMaxPositionIterations;
+    float32 mGravityScale;
+    float32 mDensityScale;
+    std::ostream *mLog;
+    int mTick;
+    StepSchedule mSchedule;
+  };
+
+}
+
+#endif // __STEPSCHEDULER_H_
@@ -38,6 +38,7 @@ namespace Impact {
     bd.bullet = false;
     bd.fixedRotation = true;
     mBody = mGame->world()->CreateBody(&bd);
+    startUpdates();
   }
 
 
@@ -61,6 +61,7 @@ namespace Impact {
       , scaleGravityBy(other.scaleGravityBy)
       , scaleBallDensityDuration(other.scaleBallDensityDuration)
       , scaleBallDensityBy(other.scaleBallDensityBy)
+      , laserDuration(other.laserDuration)
       , earthquakeDuration(other.earthquakeDuration)
       , earthquakeIntensity(other.earthquakeIntensity)
       , bumperImpulse(other.bumperImpulse)
@@ -86,6 +87,7 @@ namespace Impact {
     float32 scaleGravityBy;
     sf::Time scaleBallDensityDuration;
     float32 scaleBallDensityBy;
+    sf::Time laserDuration;
     sf::Time earthquakeDuration;
     float32 earthquakeIntensity;
     float32 bumperImpulse;
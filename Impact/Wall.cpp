@@ -41,14 +41,19 @@ namespace Impact {
 
     mSprite.setTexture(mTexture);
     mSprite.setOrigin(halfW, halfH);
+  }
+
+
+  bool Wall::isTileSized(void) const
+  {
+    return mTexture.getSize().x == Game::Scale && mTexture.getSize().y == Game::Scale;
+  }
 
-    b2BodyDef bd;
-    bd.type = b2_staticBody;
-    bd.userData = this;
-    mBody = game->world()->CreateBody(&bd);
 
+  void Wall::createFixture(b2Body *body, const b2Vec2 &lowerBound, const b2Vec2 &upperBound)
+  {
     b2PolygonShape polygon;
-    polygon.SetAsBox(halfW * Game::InvScale, halfH * Game::InvScale);
+    polygon.SetAsBox(.5f * (upperBound.x - lowerBound.x), .5f * (upperBound.y - lowerBound.y), .5f * (lowerBound + upperBound) - body->GetPosition(), 0.f);
 
     b2FixtureDef fd;
     fd.density = mTileParam.density.isValid() ? mTileParam.density.get() : DefaultDensity;
@@ -56,7 +61,13 @@ namespace Impact {
     fd.friction = mTileParam.friction.isValid() ? mTileParam.friction.get() : DefaultFriction;
     fd.shape = &polygon;
     fd.userData = this;
-    mBody->CreateFixture(&fd);
+    body->CreateFixture(&fd);
+  }
+
+
+  void Wall::createFixture(b2Body *body)
+  {
+    createFixture(body, mPosition - mHalfTextureSize, mPosition + mHalfTextureSize);
   }
 
 
@@ -68,9 +79,8 @@ namespace Impact {
 
   void Wall::setPosition(const b2Vec2 &pos)
   {
-    Body::setPosition(pos);
-    const b2Vec2 &p = mBody->GetPosition();
-    mSprite.setPosition(Game::Scale * p.x, Game::Scale * p.y);
+    mPosition = pos + b2Vec2(mHalfTextureSize.x, 1 - mHalfTextureSize.y);
+    mSprite.setPosition(Game::Scale * mPosition.x, Game::Scale * mPosition.y);
   }
 
 
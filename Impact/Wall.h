@@ -40,11 +40,25 @@ namespace Impact {
 
     virtual void setPosition(int x, int y);
     virtual void setPosition(const b2Vec2 &pos);
+    virtual inline const b2Vec2 &position(void) const
+    {
+      return mPosition;
+    }
+
+    /// true if the wall's texture covers exactly one tile
+    bool isTileSized(void) const;
+    /// adds a box from `lowerBound` to `upperBound` with the wall's material to `body`
+    void createFixture(b2Body *body, const b2Vec2 &lowerBound, const b2Vec2 &upperBound);
+    /// adds the box covered by the wall's texture to `body`
+    void createFixture(b2Body *body);
 
     static const std::string Name;
     static const float32 DefaultDensity;
     static const float32 DefaultFriction;
     static const float32 DefaultRestitution;
+
+  private:
+    b2Vec2 mPosition;
   };
 
 }
@@ -26,21 +26,28 @@
 #include <gtk/gtk.h>
 #endif
 
-Impact::Game breakout;
-
 int main(int argc, char *argv[])
 {
 #if defined(LINUX_AMD64)   
   gtk_init(&argc, &argv);
 #endif
-  if (argc == 2) {
+  if (Impact::PerfHarness::isRequested(argc, argv)) {
+    Impact::Game breakout(Impact::Game::Headless);
+    Impact::PerfHarness harness(&breakout);
+    return harness.exec(argc, argv);
+  }
+  Impact::Game breakout;
+  if (argc == 3 && std::string(argv[1]) == "--record-session") {
+    breakout.recordSession(argv[2]);
+  }
+  else if (argc == 2) {
 #if defined(WIN32) && defined(CT_VERSION_INTERNAL)
     char szPath[MAX_PATH];
     char *res = _fullpath(szPath, argv[1], MAX_PATH);
     if (res != NULL) {
       DWORD dwAttrib = GetFileAttributes(szPath);
       if (dwAttrib != INVALID_FILE_ATTRIBUTES && !(dwAttrib & FILE_ATTRIBUTE_DIRECTORY))
-        breakout->setLevelZip(szPath);
+        breakout.setLevelZip(szPath);
     }
 #else
     UNUSED(argv);
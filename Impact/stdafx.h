@@ -64,12 +64,16 @@
 #include <SFML/OpenGL.hpp>
 
 #include <Box2D/Box2D.h>
+#include <Box2D/Common/b2ArenaAllocator.h>
 
 #include "util.h"
 #include "LocalSettings.h"
 #include "globals.h"
 #include "Easings.h"
 #include "Timer.h"
+#include "Benchmark.h"
+#include "LevelGenerator.h"
+#include "Session.h"
 #include "TileParam.h"
 #include "Level.h"
 #include "Destructible.h"
@@ -81,8 +85,13 @@
 #include "Racket.h"
 #include "Ground.h"
 #include "Wall.h"
+#include "ParticleSystem.h"
+#include "StepScheduler.h"
+#include "ContactEventStore.h"
+#include "LaserBeams.h"
 #include "Explosion.h"
 #include "Impact.h"
+#include "PerfHarness.h"
 
 
 #endif // __STDAFX_H_
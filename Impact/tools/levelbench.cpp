@@ -0,0 +1,297 @@
+/*  
+
+    Copyright (c) 2015 Oliver Lau <ola@ct.de>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+// Microbenchmarks for the stages of Level::loadZip().
+//
+// Usage: levelbench [options] [level.zip ...]
+//
+// Without level files all bundled levels in resources/levels are measured.
+// Every stage is timed in isolation so that a change to one of them shows
+// up in its own series. Synthetic maps exercise the decoding stages with
+// map sizes far beyond the bundled 40x25 tiles.
+
+#include "../stdafx.h"
+
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/xml_parser.hpp>
+#include <boost/filesystem.hpp>
+
+#include <zlib.h>
+
+using namespace Impact;
+
+namespace {
+
+  struct Options {
+    Options(void)
+      : iterations(Benchmark::DefaultIterations)
+      , warmupIterations(Benchmark::DefaultWarmupIterations)
+      , threshold(Benchmark::DefaultThreshold)
+    { /* ... */ }
+    int iterations;
+    int warmupIterations;
+    double threshold;
+    std::string jsonFilename;
+    std::string baselineFilename;
+    std::vector<std::string> zipFilenames;
+    std::vector<std::pair<int, int> > syntheticSizes;
+  };
+
+
+  void usage(void)
+  {
+    std::cout << "Usage: levelbench [options] [level.zip ...]" << std::endl
+      << std::endl
+      << "  --iterations N     timed runs per stage (default: " << Benchmark::DefaultIterations << ")" << std::endl
+      << "  --warmup N         untimed runs per stage (default: " << Benchmark::DefaultWarmupIterations << ")" << std::endl
+      << "  --synthetic WxH    add a synthetic map of W x H tiles (default: 400x250)" << std::endl
+      << "  --json FILE        write results to FILE" << std::endl
+      << "  --baseline FILE    compare results against FILE and exit with 1 on regressions" << std::endl
+      << "  --threshold PCT    tolerated slowdown of the median in percent (default: " << Benchmark::DefaultThreshold << ")" << std::endl;
+  }
+
+
+  bool parseOptions(int argc, char *argv[], Options &options)
+  {
+    for (int i = 1; i < argc; ++i) {
+      const std::string arg = argv[i];
+      const bool hasValue = i + 1 < argc;
+      if (arg == "--iterations" && hasValue) {
+        options.iterations = std::max(1, std::atoi(argv[++i]));
+      }
+      else if (arg == "--warmup" && hasValue) {
+        options.warmupIterations = std::max(0, std::atoi(argv[++i]));
+      }
+      else if (arg == "--synthetic" && hasValue) {
+        int w = 0, h = 0;
+        if (std::sscanf(argv[++i], "%dx%d", &w, &h) != 2 || w <= 0 || h <= 0) {
+          std::cerr << "Bad map size: " << argv[i] << std::endl;
+          return false;
+        }
+        options.syntheticSizes.push_back(std::make_pair(w, h));
+      }
+      else if (arg == "--json" && hasValue) {
+        options.jsonFilename = argv[++i];
+      }
+      else if (arg == "--baseline" && hasValue) {
+        options.baselineFilename = argv[++i];
+      }
+      else if (arg == "--threshold" && hasValue) {
+        options.threshold = std::atof(argv[++i]);
+      }
+      else if (arg == "--help" || arg == "-h") {
+        return false;
+      }
+      else if (boost::algorithm::starts_with(arg, "--")) {
+        std::cerr << "Unknown option: " << arg << std::endl;
+        return false;
+      }
+      else {
+        options.zipFilenames.push_back(arg);
+      }
+    }
+    if (options.zipFilenames.empty()) {
+      for (int num = 1; ; ++num) {
+        std::ostringstream zipFilename;
+        zipFilename << ResourcesDir << "/levels/" << std::setw(4) << std::setfill('0') << num << ".zip";
+        if (!fileExists(zipFilename.str()))
+          break;
+        options.zipFilenames.push_back(zipFilename.str());
+      }
+    }
+    if (options.syntheticSizes.empty())
+      options.syntheticSizes.push_back(std::make_pair(400, 250));
+    return true;
+  }
+
+
+  void benchmarkLevel(Benchmark &bench, const std::string &zipFilename, const std::string &extractPath)
+  {
+    const std::string &name = boost::filesystem::path(zipFilename).stem().generic_string();
+    const std::string &levelPath = extractPath + "/" + name;
+
+    std::string tmxFilename;
+    std::string musicFilename;
+    if (!Level::extractZip(zipFilename, levelPath, tmxFilename, musicFilename)) {
+      std::cerr << "Cannot extract " << zipFilename << std::endl;
+      return;
+    }
+    bench.run(name + "/unzip", [&]() {
+      Level::extractZip(zipFilename, levelPath, tmxFilename, musicFilename);
+    });
+
+    Level level;
+    bench.run(name + "/sha1", [&]() {
+      level.calcSHA1(zipFilename);
+    });
+
+    bench.run(name + "/read_xml", [&]() {
+      boost::property_tree::ptree pt;
+      boost::property_tree::xml_parser::read_xml(tmxFilename, pt);
+    });
+
+    boost::property_tree::ptree pt;
+    boost::property_tree::xml_parser::read_xml(tmxFilename, pt);
+    const std::string &mapDataB64 = pt.get<std::string>("map.layer.data");
+    const std::size_t numTiles = pt.get<std::size_t>("map.<xmlattr>.width") * pt.get<std::size_t>("map.<xmlattr>.height");
+
+    bench.run(name + "/base64_decode", [&]() {
+      uint8_t *compressed = nullptr;
+      unsigned long compressedSize = 0;
+      base64_decode(mapDataB64, compressed, compressedSize);
+      delete[] compressed;
+    });
+
+    uint8_t *compressed = nullptr;
+    unsigned long compressedSize = 0;
+    base64_decode(mapDataB64, compressed, compressedSize);
+    std::vector<uint32_t> mapData(numTiles);
+    bench.run(name + "/uncompress", [&]() {
+      uLongf mapDataSize = uLongf(numTiles * sizeof(uint32_t));
+      uncompress(reinterpret_cast<Bytef*>(mapData.data()), &mapDataSize, reinterpret_cast<Bytef*>(compressed), compressedSize);
+    });
+    delete[] compressed;
+
+    std::vector<std::string> tileFilenames;
+    const boost::property_tree::ptree &tileset = pt.get_child("map.tileset");
+    boost::property_tree::ptree::const_iterator ti;
+    for (ti = tileset.begin(); ti != tileset.end(); ++ti)
+      if (ti->first == "tile")
+        tileFilenames.push_back(levelPath + "/" + ti->second.get<std::string>("image.<xmlattr>.source"));
+    // one sample per tile texture, so that the series reflects the cost of a single loadFromFile()
+    bench.run(name + "/tiles", [&]() {
+      std::vector<std::string>::const_iterator fi;
+      for (fi = tileFilenames.begin(); fi != tileFilenames.end(); ++fi) {
+        sf::Texture texture;
+        Stopwatch stopwatch;
+        texture.loadFromFile(*fi);
+        bench.add(name + "/tile_loadFromFile", stopwatch.elapsed());
+      }
+    });
+
+    bench.run(name + "/loadZip", [&]() {
+      level.loadZip(zipFilename);
+    });
+  }
+
+
+  void benchmarkSyntheticMap(Benchmark &bench, int width, int height)
+  {
+    std::ostringstream nameBuf;
+    nameBuf << "synthetic" << width << "x" << height;
+    const std::string &name = nameBuf.str();
+    const std::size_t numTiles = std::size_t(width) * std::size_t(height);
+
+    // roughly every other tile is occupied by one of eight tile types, like in a crowded level
+    std::mt19937 rng(numTiles);
+    std::uniform_int_distribution<uint32_t> tileDist(0, 16);
+    std::vector<uint32_t> mapData(numTiles);
+    for (std::size_t i = 0; i < numTiles; ++i) {
+      const uint32_t gid = tileDist(rng);
+      mapData[i] = gid > 8 ? 0 : gid;
+    }
+    uLongf compressedSize = compressBound(uLong(numTiles * sizeof(uint32_t)));
+    std::vector<Bytef> compressed(compressedSize);
+    compress(compressed.data(), &compressedSize, reinterpret_cast<const Bytef*>(mapData.data()), uLong(numTiles * sizeof(uint32_t)));
+    const std::string &mapDataB64 = base64_encode(compressed.data(), compressedSize);
+
+    std::ostringstream tmx;
+    tmx << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+      << "<map version=\"1.0\" orientation=\"orthogonal\" width=\"" << width << "\" height=\"" << height << "\" tilewidth=\"16\" tileheight=\"16\">\n"
+      << " <layer name=\"Kachelebene 1\" width=\"" << width << "\" height=\"" << height << "\">\n"
+      << "  <data encoding=\"base64\" compression=\"zlib\">\n   " << mapDataB64 << "\n  </data>\n"
+      << " </layer>\n"
+      << "</map>\n";
+    const std::string &tmxData = tmx.str();
+
+    bench.run(name + "/read_xml", [&]() {
+      std::istringstream is(tmxData);
+      boost::property_tree::ptree pt;
+      boost::property_tree::xml_parser::read_xml(is, pt);
+    });
+
+    bench.run(name + "/base64_decode", [&]() {
+      uint8_t *buf = nullptr;
+      unsigned long sz = 0;
+      base64_decode(mapDataB64, buf, sz);
+      delete[] buf;
+    });
+
+    std::vector<uint32_t> decoded(numTiles);
+    bench.run(name + "/uncompress", [&]() {
+      uLongf decodedSize = uLongf(numTiles * sizeof(uint32_t));
+      uncompress(reinterpret_cast<Bytef*>(decoded.data()), &decodedSize, compressed.data(), compressedSize);
+    });
+
+    bench.run(name + "/decodeMapData", [&]() {
+      Level::decodeMapData(mapDataB64, numTiles, decoded);
+    });
+    if (decoded != mapData)
+      std::cerr << name << ": decoded map data differs from the original." << std::endl;
+  }
+
+}
+
+
+int main(int argc, char *argv[])
+{
+  Options options;
+  if (!parseOptions(argc, argv, options)) {
+    usage();
+    return EXIT_FAILURE;
+  }
+
+  Benchmark bench("levelbench");
+  bench.setIterations(options.iterations);
+  bench.setWarmupIterations(options.warmupIterations);
+
+  // a directory of its own, so that concurrent runs do not remove each other's files;
+  // Level::loadZip() extracts into the levels directory, which must not be the user's
+  const std::string &extractPath = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("impact-levelbench-%%%%-%%%%-%%%%")).generic_string();
+  boost::filesystem::create_directories(extractPath);
+  gLocalSettings().setLevelsDir(extractPath);
+
+  std::vector<std::string>::const_iterator zi;
+  for (zi = options.zipFilenames.begin(); zi != options.zipFilenames.end(); ++zi)
+    benchmarkLevel(bench, *zi, extractPath);
+
+  std::vector<std::pair<int, int> >::const_iterator si;
+  for (si = options.syntheticSizes.begin(); si != options.syntheticSizes.end(); ++si)
+    benchmarkSyntheticMap(bench, si->first, si->second);
+
+  boost::system::error_code ec;
+  boost::filesystem::remove_all(extractPath, ec);
+
+  bench.print(std::cout);
+
+  if (!options.jsonFilename.empty())
+    bench.save(options.jsonFilename);
+
+  if (!options.baselineFilename.empty()) {
+    Benchmark baseline("baseline");
+    if (!baseline.load(options.baselineFilename))
+      return EXIT_FAILURE;
+    std::cout << std::endl;
+    if (bench.compare(baseline, options.threshold, std::cout) > 0)
+      return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,177 @@
+/*  
+
+    Copyright (c) 2015 Oliver Lau <ola@ct.de>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+// Procedural stress level generator.
+//
+// Usage: levelgen [options] -o level.zip
+//        levelgen [options] --out-dir DIR
+//
+// Every count option takes a single value or a comma separated list.
+// With lists, one level per combination is written to DIR as 0001.zip,
+// 0002.zip, ... so the directory can be used as a levels directory, and
+// a CSV index mapping file names to element counts is printed to stdout.
+
+#include "../stdafx.h"
+
+#include <boost/filesystem.hpp>
+
+using namespace Impact;
+
+namespace {
+
+  void usage(void)
+  {
+    const LevelGeneratorDef defaults;
+    std::cout << "Usage: levelgen [options] (-o FILE.zip | --out-dir DIR)" << std::endl
+      << std::endl
+      << "  --width N[,N...]       map width in tiles (default: " << defaults.width << ")" << std::endl
+      << "  --height N[,N...]      map height in tiles (default: " << defaults.height << ")" << std::endl
+      << "  --blocks N[,N...]      number of blocks (default: " << defaults.blocks << ")" << std::endl
+      << "  --walls N[,N...]       number of wall tiles (default: " << defaults.walls << ")" << std::endl
+      << "  --bumpers N[,N...]     number of bumpers (default: " << defaults.bumpers << ")" << std::endl
+      << "  --multiball N[,N...]   number of multiball blocks (default: " << defaults.multiballBlocks << ")" << std::endl
+      << "  --balls N[,N...]       number of balls (default: " << defaults.balls << ")" << std::endl
+      << "  --gravity G            gravity (default: " << defaults.gravity << ")" << std::endl
+      << "  --particles-hit-ball   let explosion particles collide with balls" << std::endl
+      << "  --seed N               random seed (default: " << defaults.seed << ")" << std::endl
+      << "  --first N              number of the first level file in DIR (default: 1)" << std::endl;
+  }
+
+
+  bool parseList(const char *arg, std::vector<int> &values)
+  {
+    values.clear();
+    std::istringstream is(arg);
+    std::string item;
+    while (std::getline(is, item, ',')) {
+      const int value = std::atoi(item.c_str());
+      if (value < 0)
+        return false;
+      values.push_back(value);
+    }
+    return !values.empty();
+  }
+
+}
+
+
+int main(int argc, char *argv[])
+{
+  const LevelGeneratorDef defaults;
+  enum { Width, Height, Blocks, Walls, Bumpers, Multiball, Balls, ParameterCount };
+  static const char *Names[ParameterCount] = { "--width", "--height", "--blocks", "--walls", "--bumpers", "--multiball", "--balls" };
+  std::vector<int> values[ParameterCount];
+  values[Width].push_back(defaults.width);
+  values[Height].push_back(defaults.height);
+  values[Blocks].push_back(defaults.blocks);
+  values[Walls].push_back(defaults.walls);
+  values[Bumpers].push_back(defaults.bumpers);
+  values[Multiball].push_back(defaults.multiballBlocks);
+  values[Balls].push_back(defaults.balls);
+
+  LevelGeneratorDef def;
+  std::string zipFilename;
+  std::string outDir;
+  int first = 1;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    const bool hasValue = i + 1 < argc;
+    bool known = false;
+    for (int p = 0; p < ParameterCount; ++p) {
+      if (arg == Names[p] && hasValue) {
+        if (!parseList(argv[++i], values[p])) {
+          std::cerr << "Bad value for " << arg << ": " << argv[i] << std::endl;
+          return EXIT_FAILURE;
+        }
+        known = true;
+      }
+    }
+    if (known)
+      continue;
+    if (arg == "--gravity" && hasValue) {
+      def.gravity = float(std::atof(argv[++i]));
+    }
+    else if (arg == "--particles-hit-ball") {
+      def.explosionParticlesCollideWithBall = true;
+    }
+    else if (arg == "--seed" && hasValue) {
+      def.seed = uint32_t(std::strtoul(argv[++i], nullptr, 10));
+    }
+    else if (arg == "--first" && hasValue) {
+      first = std::max(1, std::atoi(argv[++i]));
+    }
+    else if (arg == "-o" && hasValue) {
+      zipFilename = argv[++i];
+    }
+    else if (arg == "--out-dir" && hasValue) {
+      outDir = argv[++i];
+    }
+    else {
+      usage();
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::size_t combinations = 1;
+  for (int p = 0; p < ParameterCount; ++p)
+    combinations *= values[p].size();
+  if (zipFilename.empty() == outDir.empty() || (!zipFilename.empty() && combinations > 1)) {
+    usage();
+    return EXIT_FAILURE;
+  }
+  if (!outDir.empty()) {
+    boost::filesystem::create_directories(outDir);
+    std::cout << "file,width,height,blocks,walls,bumpers,multiball,balls" << std::endl;
+  }
+
+  for (std::size_t c = 0; c < combinations; ++c) {
+    std::size_t k = c;
+    int v[ParameterCount];
+    for (int p = ParameterCount - 1; p >= 0; --p) {
+      v[p] = values[p][k % values[p].size()];
+      k /= values[p].size();
+    }
+    def.width = v[Width];
+    def.height = v[Height];
+    def.blocks = v[Blocks];
+    def.walls = v[Walls];
+    def.bumpers = v[Bumpers];
+    def.multiballBlocks = v[Multiball];
+    def.balls = v[Balls];
+    LevelGenerator generator(def);
+    std::string filename = zipFilename;
+    if (!outDir.empty()) {
+      std::ostringstream name;
+      name << outDir << "/" << std::setw(4) << std::setfill('0') << (first + int(c)) << ".zip";
+      filename = name.str();
+      std::cout << filename << ","
+        << def.width << "," << def.height << ","
+        << generator.placedBlocks() << ","
+        << generator.placedWalls() << ","
+        << generator.placedBumpers() << ","
+        << generator.placedMultiballBlocks() << ","
+        << generator.placedBalls() << std::endl;
+    }
+    if (!generator.writeZip(filename))
+      return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
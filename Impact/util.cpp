@@ -94,4 +94,30 @@ namespace Impact {
   }
 
 
+  std::string base64_encode(const uint8_t *buf, unsigned long sz) {
+    std::string ret;
+    ret.reserve(4 * ((sz + 2) / 3));
+    unsigned long i = 0;
+    for ( ; i + 2 < sz; i += 3) {
+      ret.push_back(base64_chars[buf[i] >> 2]);
+      ret.push_back(base64_chars[((buf[i] & 0x03) << 4) | (buf[i + 1] >> 4)]);
+      ret.push_back(base64_chars[((buf[i + 1] & 0x0f) << 2) | (buf[i + 2] >> 6)]);
+      ret.push_back(base64_chars[buf[i + 2] & 0x3f]);
+    }
+    if (i < sz) {
+      ret.push_back(base64_chars[buf[i] >> 2]);
+      if (i + 1 < sz) {
+        ret.push_back(base64_chars[((buf[i] & 0x03) << 4) | (buf[i + 1] >> 4)]);
+        ret.push_back(base64_chars[(buf[i + 1] & 0x0f) << 2]);
+      }
+      else {
+        ret.push_back(base64_chars[(buf[i] & 0x03) << 4]);
+        ret.push_back('=');
+      }
+      ret.push_back('=');
+    }
+    return ret;
+  }
+
+
 }
@@ -244,6 +244,7 @@ namespace Impact {
   };
 
   extern bool base64_decode(std::string, uint8_t *&, unsigned long &);
+  extern std::string base64_encode(const uint8_t *, unsigned long);
   extern bool fileExists(const std::string &);
 
 }